@@ -0,0 +1,249 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "Board.h"
+#include "Piece.h"
+#include "Position.h"
+
+/**
+ * @brief Precomputed diagonal tables and mask operations over the 32 playable squares.
+ *
+ * Every mask uses the same layout as Board: bit i corresponds to Position::from_index(i).
+ * Directions follow AnalyzerDirection order (NW, NE, SW, SE); north decreases the row,
+ * so black pions move SW/SE and white pions move NW/NE.
+ */
+namespace bitboard {
+
+using Mask = std::uint32_t;
+
+inline constexpr std::size_t square_count = Position::max_positions();
+inline constexpr std::size_t direction_count = 4;
+inline constexpr std::uint8_t no_square = 0xFF;
+
+inline constexpr std::array<AnalyzerDirection, direction_count> all_directions = {
+    AnalyzerDirection::NW, AnalyzerDirection::NE, AnalyzerDirection::SW, AnalyzerDirection::SE};
+
+inline constexpr std::array<AnalyzerDirectionDelta, direction_count> direction_deltas = {{
+    {.row = -1, .col = -1}, // NW
+    {.row = -1, .col = 1},  // NE
+    {.row = 1, .col = -1},  // SW
+    {.row = 1, .col = 1}    // SE
+}};
+
+[[nodiscard]] constexpr Mask bit(std::size_t square) noexcept { return Mask{1} << static_cast<unsigned>(square); }
+
+[[nodiscard]] constexpr std::size_t index(AnalyzerDirection dir) noexcept { return static_cast<std::size_t>(dir); }
+
+// NW <-> SE and NE <-> SW
+[[nodiscard]] constexpr AnalyzerDirection opposite(AnalyzerDirection dir) noexcept {
+    return static_cast<AnalyzerDirection>(3 - static_cast<int>(dir));
+}
+
+// Row-increasing directions walk towards higher square indices
+[[nodiscard]] constexpr bool is_ascending(AnalyzerDirection dir) noexcept {
+    return direction_deltas[index(dir)].row > 0;
+}
+
+struct Tables {
+    // Adjacent square in each direction, or no_square at the edge
+    std::array<std::array<std::uint8_t, square_count>, direction_count> neighbor{};
+    // All squares reachable along the diagonal (excluding the origin)
+    std::array<std::array<Mask, square_count>, direction_count> ray{};
+    // Each direction is a shift by one of two amounts depending on row parity;
+    // shift_from holds the source squares that use the matching shift_amount.
+    std::array<std::array<Mask, 2>, direction_count> shift_from{};
+    std::array<std::array<int, 2>, direction_count> shift_amount{};
+};
+
+[[nodiscard]] consteval Tables build_tables() {
+    Tables t{};
+    constexpr auto positions = Position::all_valid_positions();
+    for (std::size_t d = 0; d < direction_count; ++d) {
+        const auto delta = direction_deltas[d];
+        int amounts_found = 0;
+        for (const auto& pos : positions) {
+            const auto from = pos.hash();
+            t.neighbor[d][from] = no_square;
+            int x = pos.x() + delta.col;
+            int y = pos.y() + delta.row;
+            bool first = true;
+            while (Position::is_valid(x, y)) {
+                const auto to = Position{x, y}.hash();
+                t.ray[d][from] |= bit(to);
+                if (first) {
+                    t.neighbor[d][from] = static_cast<std::uint8_t>(to);
+                    const int amount = static_cast<int>(to) - static_cast<int>(from);
+                    int slot = 0;
+                    while (slot < amounts_found && t.shift_amount[d][slot] != amount) ++slot;
+                    if (slot == amounts_found) t.shift_amount[d][amounts_found++] = amount;
+                    t.shift_from[d][slot] |= bit(from);
+                    first = false;
+                }
+                x += delta.col;
+                y += delta.row;
+            }
+        }
+    }
+    return t;
+}
+
+inline constexpr Tables tables = build_tables();
+
+[[nodiscard]] constexpr std::uint8_t neighbor(AnalyzerDirection dir, std::size_t square) noexcept {
+    return tables.neighbor[index(dir)][square];
+}
+
+[[nodiscard]] constexpr Mask ray(AnalyzerDirection dir, std::size_t square) noexcept {
+    return tables.ray[index(dir)][square];
+}
+
+// byte_reversed[b]: the bits of b in reverse order
+inline constexpr auto byte_reversed = [] {
+    std::array<std::uint8_t, 256> t{};
+    for (std::size_t b = 0; b < t.size(); ++b) {
+        for (std::size_t i = 0; i < 8; ++i) t[b] |= static_cast<std::uint8_t>(((b >> i) & 1u) << (7 - i));
+    }
+    return t;
+}();
+
+// Square i goes to square 31 - i: the board turned by 180 degrees
+[[nodiscard]] constexpr Mask rotated(Mask m) noexcept {
+    return Mask{byte_reversed[m & 0xFFu]} << 24 | Mask{byte_reversed[(m >> 8) & 0xFFu]} << 16 |
+           Mask{byte_reversed[(m >> 16) & 0xFFu]} << 8 | Mask{byte_reversed[m >> 24]};
+}
+
+// Bits of `value` on the squares of `mask`, gathered into the low bits in square order (PEXT); one
+// step per square of the mask
+[[nodiscard]] constexpr Mask extract(Mask value, Mask mask) noexcept {
+    Mask out = 0;
+    for (Mask bit_out = 1; mask != 0u; mask &= mask - 1, bit_out <<= 1) {
+        if (((value >> std::countr_zero(mask)) & 1u) != 0u) out |= bit_out;
+    }
+    return out;
+}
+
+// Inverse of extract(): the low bits of `value` spread onto the squares of `mask` (PDEP)
+[[nodiscard]] constexpr Mask deposit(Mask value, Mask mask) noexcept {
+    Mask out = 0;
+    for (; mask != 0u; mask &= mask - 1, value >>= 1) {
+        if ((value & 1u) != 0u) out |= bit(static_cast<std::size_t>(std::countr_zero(mask)));
+    }
+    return out;
+}
+
+// The lowest n squares of the mask
+[[nodiscard]] constexpr Mask lowest_squares(Mask mask, std::size_t n) noexcept {
+    for (Mask rest = mask; rest != 0u; rest &= rest - 1, --n) {
+        if (n == 0) return mask & ~rest;
+    }
+    return mask;
+}
+
+// Moves every square of the mask one step in the given direction, dropping squares that leave the board.
+[[nodiscard]] constexpr Mask shift(Mask m, AnalyzerDirection dir) noexcept {
+    const auto d = index(dir);
+    Mask out = 0;
+    for (std::size_t k = 0; k < 2; ++k) {
+        const Mask src = m & tables.shift_from[d][k];
+        const int amount = tables.shift_amount[d][k];
+        out |= amount >= 0 ? (src << amount) : (src >> -amount);
+    }
+    return out;
+}
+
+// Nearest square of a non-empty blocker mask taken from ray(dir, square)
+[[nodiscard]] constexpr std::uint8_t first_blocker(AnalyzerDirection dir, Mask blockers) noexcept {
+    return is_ascending(dir) ? static_cast<std::uint8_t>(std::countr_zero(blockers))
+                             : static_cast<std::uint8_t>(31 - std::countl_zero(blockers));
+}
+
+// Empty squares a dame on `square` can slide to in one direction
+[[nodiscard]] constexpr Mask slide_targets(AnalyzerDirection dir, std::size_t square, Mask occ) noexcept {
+    const Mask full = ray(dir, square);
+    const Mask blockers = full & occ;
+    if (blockers == 0u) return full;
+    const auto b = first_blocker(dir, blockers);
+    return full & ~(ray(dir, b) | bit(b));
+}
+
+[[nodiscard]] constexpr std::array<AnalyzerDirection, 2> forward_directions(PieceColor color) noexcept {
+    if (color == PieceColor::BLACK) return {AnalyzerDirection::SW, AnalyzerDirection::SE};
+    return {AnalyzerDirection::NW, AnalyzerDirection::NE};
+}
+
+// Directions a piece may step or capture in: forward only for pions, every diagonal for dames
+template <PieceColor Color, PieceType Type>
+inline constexpr auto piece_directions = [] {
+    if constexpr (Type == PieceType::DAME) {
+        return all_directions;
+    } else {
+        return forward_directions(Color);
+    }
+}();
+
+/**
+ * @brief Mask view of one side of a board: own pieces, opponent pieces and empty squares.
+ */
+struct SideMasks {
+    Mask own{};
+    Mask own_dames{};
+    Mask opponent{};
+    Mask empty{};
+
+    [[nodiscard]] static constexpr SideMasks of(const Board& board, PieceColor color) noexcept {
+        const Mask occ = board.occ_bits();
+        const Mask black = occ & board.black_bits();
+        const Mask own = color == PieceColor::BLACK ? black : occ & ~black;
+        return SideMasks{.own = own, .own_dames = own & board.dame_bits(), .opponent = occ & ~own, .empty = ~occ};
+    }
+
+    [[nodiscard]] constexpr Mask own_pions() const noexcept { return own & ~own_dames; }
+};
+
+// Own pieces adjacent to an empty square in one of their legal step directions
+[[nodiscard]] constexpr Mask step_sources(const SideMasks& s, PieceColor color) noexcept {
+    Mask out = 0;
+    for (const auto dir : forward_directions(color)) { out |= shift(s.empty, opposite(dir)) & s.own_pions(); }
+    for (const auto dir : all_directions) { out |= shift(s.empty, opposite(dir)) & s.own_dames; }
+    return out;
+}
+
+// Own pions with an opponent piece ahead and an empty landing square behind it
+[[nodiscard]] constexpr Mask pion_jump_sources(const SideMasks& s, PieceColor color) noexcept {
+    Mask out = 0;
+    for (const auto dir : forward_directions(color)) {
+        const auto back = opposite(dir);
+        out |= shift(shift(s.empty, back) & s.opponent, back) & s.own_pions();
+    }
+    return out;
+}
+
+// Whether a dame on `square` can capture anything in the current position
+[[nodiscard]] constexpr bool dame_can_capture(const SideMasks& s, std::size_t square) noexcept {
+    const Mask occ = ~s.empty;
+    for (const auto dir : all_directions) {
+        const Mask blockers = ray(dir, square) & occ;
+        if (blockers == 0u) continue;
+        const auto b = first_blocker(dir, blockers);
+        if ((s.opponent & bit(b)) == 0u) continue;
+        const auto landing = neighbor(dir, b);
+        if (landing != no_square && (s.empty & bit(landing)) != 0u) return true;
+    }
+    return false;
+}
+
+// All own pieces that have at least one capture available
+[[nodiscard]] constexpr Mask capture_sources(const SideMasks& s, PieceColor color) noexcept {
+    Mask out = pion_jump_sources(s, color);
+    for (Mask dames = s.own_dames; dames != 0u; dames &= dames - 1) {
+        const auto sq = static_cast<std::size_t>(std::countr_zero(dames));
+        if (dame_can_capture(s, sq)) out |= bit(sq);
+    }
+    return out;
+}
+
+} // namespace bitboard
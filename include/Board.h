@@ -12,6 +12,8 @@
 
 #include "Position.h"
 #include "Piece.h"
+#include "Move.h"
+#include "Zobrist.h"
 
 using Pieces = std::unordered_map<Position, PieceInfo>;
 
@@ -39,6 +41,15 @@ struct AnalyzerCaptureMove {
     [[nodiscard]] constexpr bool is_valid() const noexcept { return captured_piece != landing_position; }
 };
 
+// Bits that change when a move is made; XOR-ing it again restores the previous board
+struct BoardDelta {
+    std::uint32_t occ{};
+    std::uint32_t black{};
+    std::uint32_t dame{};
+    zobrist::Key key{};
+    [[nodiscard]] constexpr bool operator==(const BoardDelta&) const noexcept = default;
+};
+
 class Board {
   private:
     static constexpr std::size_t PIECES_RESERVE_SIZE = 32;
@@ -47,6 +58,7 @@ class Board {
     std::uint32_t occ_bits_{};   // occupied squares mask
     std::uint32_t black_bits_{}; // 1 => black piece at that index
     std::uint32_t dame_bits_{};  // 1 => dame at that index
+    zobrist::Key zobrist_{};     // XOR of the Zobrist keys of all pieces, kept in sync by every mutator
 
   public:
     Board() = default;
@@ -65,6 +77,8 @@ class Board {
     [[nodiscard]] static Board from_hash(std::size_t hash);
 
     [[nodiscard]] std::size_t hash() const noexcept;
+    // Zobrist key of the pieces (without side to move), updated incrementally
+    [[nodiscard]] constexpr zobrist::Key zobrist() const noexcept { return zobrist_; }
     [[nodiscard]] operator std::size_t() const noexcept { return hash(); }
     Board& operator=(const Board&) = default;
     Board& operator=(Board&&) noexcept = default;
@@ -83,18 +97,45 @@ class Board {
 
     [[nodiscard]] Pieces get_pieces(PieceColor color) const noexcept;
 
+    // --- Incremental make/unmake ---
+    // Delta of playing the move here, including promotion on the back rows and removal of captured pieces
+    [[nodiscard]] BoardDelta move_delta(const Move& move) const noexcept;
+    void apply_delta(const BoardDelta& delta) noexcept {
+        occ_bits_ ^= delta.occ;
+        black_bits_ ^= delta.black;
+        dame_bits_ ^= delta.dame;
+        zobrist_ ^= delta.key;
+    }
+
     // --- Checkpoint / serialization support helpers ---
-    [[nodiscard]] std::uint32_t occ_bits() const noexcept { return occ_bits_; }
-    [[nodiscard]] std::uint32_t black_bits() const noexcept { return black_bits_; }
-    [[nodiscard]] std::uint32_t dame_bits() const noexcept { return dame_bits_; }
+    [[nodiscard]] constexpr std::uint32_t occ_bits() const noexcept { return occ_bits_; }
+    [[nodiscard]] constexpr std::uint32_t black_bits() const noexcept { return black_bits_; }
+    [[nodiscard]] constexpr std::uint32_t dame_bits() const noexcept { return dame_bits_; }
     void set_from_masks(std::uint32_t occ, std::uint32_t black, std::uint32_t dame) noexcept {
         occ_bits_ = occ;
         black_bits_ = black;
         dame_bits_ = dame;
+        zobrist_ = compute_zobrist(occ, black, dame);
+    }
+
+    // --- Color-swap symmetry ---
+    // The board turned by 180 degrees with the colors swapped. Black to move here plays exactly like
+    // white to move there (and the other way round), with the winner swapped.
+    [[nodiscard]] Board mirrored() const noexcept;
+    // White-to-move representative of the position: this board for white, the mirrored board for black.
+    // `second` is true when the board was mirrored.
+    [[nodiscard]] std::pair<Board, bool> canonical(PieceColor side) const noexcept {
+        if (side == PieceColor::WHITE) return {*this, false};
+        return {mirrored(), true};
     }
 
   private:
     // Internal helpers
+    [[nodiscard]] static zobrist::Key compute_zobrist(std::uint32_t occ, std::uint32_t black,
+                                                      std::uint32_t dame) noexcept;
+    [[nodiscard]] zobrist::Key piece_key(std::uint32_t m, std::size_t idx) const noexcept {
+        return zobrist::piece((black_bits_ & m) != 0u, (dame_bits_ & m) != 0u, idx);
+    }
     [[nodiscard]] static constexpr std::uint32_t bit(std::size_t idx) noexcept {
         return static_cast<std::uint32_t>(1u) << static_cast<unsigned>(idx);
     }
@@ -109,6 +150,7 @@ class Board {
             if (info.type == PieceType::DAME) b.dame_bits_ |= m;
             else b.dame_bits_ &= ~m;
         }
+        b.zobrist_ = compute_zobrist(b.occ_bits_, b.black_bits_, b.dame_bits_);
         return b;
     }
 };
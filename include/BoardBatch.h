@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Board.h"
+#include "Move.h"
+#include "Piece.h"
+
+/**
+ * @brief Structure-of-arrays batch of positions: one array per Board mask plus the side to move.
+ *
+ * Masks are stored restricted to the occupied squares, so every kernel can combine them lane by lane
+ * without re-masking.
+ */
+class BoardBatch {
+  public:
+    void reserve(std::size_t n);
+    void clear() noexcept;
+    void push_back(const Board& board, PieceColor side);
+
+    [[nodiscard]] std::size_t size() const noexcept { return occ_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return occ_.empty(); }
+
+    [[nodiscard]] Board board(std::size_t i) const noexcept;
+    [[nodiscard]] PieceColor side(std::size_t i) const noexcept {
+        return black_to_move_[i] != 0u ? PieceColor::BLACK : PieceColor::WHITE;
+    }
+
+    [[nodiscard]] std::span<const std::uint32_t> occ() const noexcept { return occ_; }
+    [[nodiscard]] std::span<const std::uint32_t> black() const noexcept { return black_; }
+    [[nodiscard]] std::span<const std::uint32_t> dame() const noexcept { return dame_; }
+    // 1 where black is to move, 0 where white is
+    [[nodiscard]] std::span<const std::uint32_t> black_to_move() const noexcept { return black_to_move_; }
+
+  private:
+    std::vector<std::uint32_t> occ_;
+    std::vector<std::uint32_t> black_;
+    std::vector<std::uint32_t> dame_;
+    std::vector<std::uint32_t> black_to_move_;
+};
+
+/**
+ * @brief Kernels over a BoardBatch, 8 positions per instruction with AVX2 and 16 with AVX-512.
+ *
+ * Every kernel has a scalar version that defines its result; the vector versions compute exactly the
+ * same values. The widest kernel the CPU supports is picked at run time (AVX-512 needs the VPOPCNTDQ
+ * extension, as on Zen 4) and a kernel the CPU lacks falls back to a narrower one, so one binary runs
+ * everywhere; AMD_ZEN_ARCH or ENABLE_NATIVE_OPTIMIZATIONS
+ * additionally let the compiler tune the scalar version and the code around the kernels.
+ *
+ * Outputs must hold at least batch.size() values.
+ * @throws std::invalid_argument if an output is too small.
+ */
+namespace batch {
+
+enum class Kernel : std::uint8_t { SCALAR, AVX2, AVX512 };
+
+// Widest kernel this CPU runs
+[[nodiscard]] Kernel best_kernel() noexcept;
+[[nodiscard]] bool supported(Kernel kernel) noexcept;
+
+// Search::evaluate_material of every position, for its side to move
+void evaluate(const BoardBatch& boards, std::span<std::int32_t> out, Kernel kernel = best_kernel());
+
+// Non-capture steps of the side to move: pions forward, dames one square in every direction
+// (a dame's slide counts only its first square)
+void mobility(const BoardBatch& boards, std::span<std::int32_t> out, Kernel kernel = best_kernel());
+
+// Bits set in each mask, e.g. BoardBatch::occ() for piece counts or BoardBatch::dame() for dame counts
+void popcount(std::span<const std::uint32_t> masks, std::span<std::int32_t> out, Kernel kernel = best_kernel());
+
+/**
+ * @brief Legal moves (generate_moves) of positions first, first + 1, ... back to back in one buffer.
+ *
+ * The moves of position first + i are moves[offsets[i], offsets[i + 1]). Positions are written in
+ * order until the moves of the next one would not fit; the return value is how many were written, so
+ * a caller whose buffer filled up continues from first + returned. No state is shared between calls:
+ * threads may read one batch at once, each into its own buffers.
+ * @throws std::invalid_argument if first > batch.size() or offsets holds fewer than
+ *         batch.size() - first + 1 values.
+ */
+std::size_t generate_moves(const BoardBatch& boards, std::span<Move> moves, std::span<std::size_t> offsets,
+                           std::size_t first = 0);
+
+} // namespace batch
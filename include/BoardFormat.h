@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Board.h"
+#include "Piece.h"
+
+/**
+ * @brief Text and packed binary forms of positions (board and side to move), one at a time or in bulk.
+ *
+ * The text form is FEN-like: the rows from row 1 (black's back row) to row 8 separated by '/', each
+ * listing its four playable squares from left to right as `b`/`w` (black/white pion), `B`/`W`
+ * (dames) or a digit counting empty squares, then a space and the side to move (`b` or `w`):
+ *
+ *     bbbb/bbbb/4/4/4/4/wwww/wwww w
+ *
+ * The packed form takes PACKED_SIZE bytes: the occupancy mask, then a 64-bit word holding the side to
+ * move in bit 0, the color of every occupied square in ascending order above it (1 = black) and the
+ * type of every occupied square above those (1 = dame). The per-square bits are the Board masks
+ * compressed onto the occupied squares (PEXT), which caps a packed board at 31 pieces. Both fields are
+ * in native byte order, like the other files of the project.
+ *
+ * Bulk routines work on whole spans with no allocation per position; the packed ones use the BMI2
+ * PEXT/PDEP instructions when the CPU has fast ones (picked at run time, like the batch kernels).
+ */
+namespace board_format {
+
+// A position as stored in files
+struct Entry {
+    Board board;
+    PieceColor side{PieceColor::WHITE};
+
+    [[nodiscard]] bool operator==(const Entry&) const noexcept = default;
+};
+
+inline constexpr std::size_t PACKED_SIZE = 12;
+// Longest text form: 32 squares, 7 row separators, the space and the side to move
+inline constexpr std::size_t MAX_TEXT_SIZE = 41;
+
+enum class Kernel : std::uint8_t { SCALAR, BMI2 };
+
+// BMI2 unless the CPU lacks it or runs PEXT/PDEP in microcode (AMD before Zen 3)
+[[nodiscard]] Kernel best_kernel() noexcept;
+[[nodiscard]] bool supported(Kernel kernel) noexcept;
+
+// ---- Text ----
+
+[[nodiscard]] std::string to_text(const Board& board, PieceColor side);
+
+/**
+ * @brief Parses one text position (surrounding whitespace is ignored).
+ * @throws std::invalid_argument if the text is not a position.
+ */
+[[nodiscard]] Entry from_text(std::string_view text);
+
+// Appends one line per position
+void append_text(std::span<const Entry> entries, std::string& out);
+
+/**
+ * @brief Parses one position per line, appending them to `out`; empty lines are skipped.
+ * @throws std::invalid_argument naming the first line that is not a position.
+ */
+void parse_text(std::string_view text, std::vector<Entry>& out);
+
+// ---- Packed ----
+
+/**
+ * @brief Packs every position into `out` (PACKED_SIZE bytes each).
+ * @throws std::invalid_argument if `out` is too small or a board has 32 pieces.
+ */
+void pack(std::span<const Entry> entries, std::span<std::uint8_t> out, Kernel kernel = best_kernel());
+
+/**
+ * @brief Unpacks the positions of `in` (a multiple of PACKED_SIZE bytes) into `out`.
+ * @throws std::invalid_argument if `out` is too small or a record has bits outside its fields.
+ */
+void unpack(std::span<const std::uint8_t> in, std::span<Entry> out, Kernel kernel = best_kernel());
+
+inline constexpr std::array<char, 8> MAGIC = {'T', 'C', 'P', 'O', 'S', '\0', '\0', '\0'};
+inline constexpr std::uint32_t VERSION = 1;
+
+/**
+ * @brief Writes a packed position file: a 24-byte header, then the packed positions back to back.
+ * @throws std::runtime_error on I/O errors, std::invalid_argument as pack().
+ */
+void write_packed(const std::string& path, std::span<const Entry> entries);
+
+/**
+ * @brief Reads a whole packed position file with one read and unpacks it in bulk.
+ * @throws std::runtime_error if the file cannot be read or is not a packed position file.
+ */
+[[nodiscard]] std::vector<Entry> read_packed(const std::string& path);
+
+} // namespace board_format
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "Piece.h"
+#include "TraversalStatistics.h"
+
+/**
+ * @brief Saved DFS frontier of a serial Traversal, enough to continue it without repeating work.
+ *
+ * The root is identified by its Board masks, side to move and the length of the move sequence that
+ * led to it. The traversal's depth limit is kept with it, since a frontier explored under one limit
+ * cannot be continued under another. Below the root, `path` holds the move indices down to the deepest open node and `next`
+ * the index of the next child to explore at every open node (so `next` has one entry more than
+ * `path`); an empty frontier means the traversal finished. `subtrees` holds the partial statistics
+ * of every open node when the traversal caches subtrees, and is empty otherwise.
+ *
+ * The file is a 64-byte header followed by the statistics and frontier arrays, in native byte order.
+ * save() writes and syncs a temporary file, then renames it over the target, so a crash never leaves
+ * a torn checkpoint behind.
+ */
+struct Checkpoint {
+    std::uint32_t occ{};
+    std::uint32_t black{};
+    std::uint32_t dame{};
+    PieceColor side{PieceColor::WHITE};
+    std::uint64_t root_length{0};
+    std::optional<std::uint64_t> max_depth; // depth limit of the traversal, if any
+
+    TraversalStatistics stats;
+    std::uint64_t transposition_hits{0};
+    std::uint64_t database_hits{0};
+    std::uint64_t tablebase_hits{0};
+    std::uint64_t horizon_leaves{0}; // positions cut off by a depth limit
+
+    std::vector<std::uint8_t> path;
+    std::vector<std::uint8_t> next;
+    std::vector<TraversalStatistics> subtrees;
+
+    static constexpr std::array<char, 8> MAGIC = {'T', 'C', 'C', 'K', 'P', 'T', '\0', '\0'};
+    static constexpr std::uint32_t VERSION = 2;
+
+    [[nodiscard]] bool finished() const noexcept { return next.empty(); }
+
+    // Whether the checkpoint was taken at this root
+    [[nodiscard]] bool matches(const Board& board, PieceColor player, std::size_t length) const noexcept;
+
+    /**
+     * @brief Reads a checkpoint written by save().
+     * @throws std::runtime_error if the file cannot be read or is not a consistent checkpoint.
+     */
+    [[nodiscard]] static Checkpoint load(const std::string& filename);
+
+    // @throws std::runtime_error on I/O errors
+    void save(const std::string& filename) const;
+};
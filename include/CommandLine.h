@@ -0,0 +1,12 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+// Parses a non-negative integer argument; nullopt unless the whole argument is a number
+std::optional<std::size_t> parse_count(std::string_view arg);
+
+// Parses a duration such as 10s, 12.5s or 5000ms (plain numbers are seconds)
+std::optional<std::chrono::milliseconds> parse_timeout(std::string_view arg);
@@ -2,7 +2,6 @@
 
 #include <vector>
 #include <set>
-#include <unordered_map>
 #include <optional>
 #include <array>
 #include <ranges>
@@ -10,7 +9,10 @@
 #include <concepts>
 #include <span>
 #include <stdexcept>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <utility>
 #include <memory>
 
@@ -18,6 +20,8 @@
 #include "Board.h"
 #include "Piece.h"
 #include "Legals.h"
+#include "Bitboard.h"
+#include "Move.h"
 
 /**
  * @brief Analyzes movement and capture possibilities for both Pion and Dame pieces in Thai Checkers.
@@ -32,62 +36,68 @@ class Explorer {
   private:
     const Board& board;
 
-    // C++20: Use designated initializers for better readability
-    static constexpr std::array<AnalyzerDirectionDelta, 4> dir_deltas = {{
-        {.row = -1, .col = -1}, // NW
-        {.row = -1, .col = 1},  // NE
-        {.row = 1, .col = -1},  // SW
-        {.row = 1, .col = 1}    // SE
-    }};
-
     /**
-     * @brief Gets the valid directions for a piece based on its type and color.
-     * @param board The current board state.
-     * @param pos The position of the piece.
-     * @return Array of direction deltas for valid movement.
+     * @brief Finds a capture move in a specific direction from the given square.
+     * @tparam Type Type of the capturing piece (a dame looks along the whole diagonal).
+     * @param occ Occupied squares, without the capturing piece and the pieces already captured.
+     * @param opponent Opponent pieces not yet captured.
+     * @param square The starting square index.
+     * @param dir The direction to search.
+     * @return Optional AnalyzerCaptureMove containing capture information, or nullopt if no capture is possible.
      */
-    [[nodiscard]] static const std::vector<AnalyzerDirectionDelta>& get_valid_directions(const Board& board,
-                                                                                         const Position& pos) noexcept;
+    template <PieceType Type>
+    [[nodiscard]] static constexpr std::optional<AnalyzerCaptureMove>
+    find_capture_in_direction(std::uint32_t occ, std::uint32_t opponent, std::size_t square,
+                              AnalyzerDirection dir) noexcept;
 
     /**
-     * @brief Finds a capture move in a specific direction from the given position.
-     * @param board The current board state.
-     * @param pos The starting position.
-     * @param delta The direction delta to search.
-     * @param is_dame Whether the piece is a dame (affects search range).
-     * @return Optional AnalyzerCaptureMove containing capture information, or nullopt if no capture is possible.
+     * @brief Calls f.template operator()<Color, Type>() for the piece on a square.
      */
-    [[nodiscard]] static std::optional<AnalyzerCaptureMove>
-    find_capture_in_direction(const Board& board, const Position& pos, const AnalyzerDirectionDelta& delta,
-                              bool is_dame) noexcept;
+    template <typename F> static decltype(auto) dispatch_piece(const Board& board, std::size_t square, F&& f);
+
+    // Jumps of the capture sequence currently being explored, in the order they are made
+    struct CapturePath {
+        std::array<std::uint8_t, bitboard::square_count> captured{};
+        std::array<std::uint8_t, bitboard::square_count> landing{};
+        std::size_t length{0};
+
+        // Packs the captured squares so that integer order equals lexicographic order of the sequence
+        [[nodiscard]] std::uint64_t order_key() const noexcept;
+    };
 
     /**
-     * @brief Recursively finds all possible capture sequences starting from a position.
-     * @param board Board state (copied for simulation)
-     * @param current_pos Current position being analyzed
-     * @param captured_pieces Set of already captured pieces
-     * @param current_sequence Current capture sequence being built
-     * @param all_sequences Output container for all found sequences
+     * @brief Finds every complete capture sequence of the piece on a square, depth first.
+     *
+     * Iterative over an explicit stack of frames, one per jump, each holding the jumps still to try
+     * from there; the board is only read as masks, so nothing is copied per jump. Captured pieces leave the board immediately and the piece keeps its
+     * type for the whole sequence (promotion only happens once it ends). Directions are tried in
+     * NW, NE, SW, SE order at every jump.
+     * @tparam Color Color of the capturing piece.
+     * @tparam Type Type of the capturing piece.
+     * @param board Board state before the move.
+     * @param from Square of the capturing piece.
+     * @param sink Called with (final square, captured mask, path) for every complete sequence
      */
-    // Bitmask-based key (up to 32 playable squares on 8x8 checkers board)
-    struct SequenceKey {
-        std::uint64_t captured_mask{}; // bit i set => position with index/hash i captured
-        Position final_pos{};          // landing square at end of sequence
-        [[nodiscard]] constexpr auto operator<=>(const SequenceKey&) const noexcept = default;
-        [[nodiscard]] constexpr bool operator==(const SequenceKey&) const noexcept = default;
-    };
+    template <PieceColor Color, PieceType Type, typename Sink>
+    static void find_capture_sequences(const Board& board, std::size_t from, Sink&& sink);
 
-    // Custom hash for SequenceKey
-    struct SequenceKeyHash {
-        [[nodiscard]] constexpr std::size_t operator()(const SequenceKey& k) const noexcept {
-            return (k.captured_mask << 37) | k.final_pos.hash();
-        }
-    };
+    /**
+     * @brief Appends the capture moves of one piece to the list, deduplicated and in deterministic order.
+     * @tparam Color Color of the piece on `from`.
+     * @tparam Type Type of the piece on `from`.
+     * @param from Square index of the capturing piece.
+     * @param out Move list to append to.
+     */
+    template <PieceColor Color, PieceType Type> void append_captures(std::size_t from, MoveList& out) const;
 
-    void find_capture_sequences_recursive(
-        Board board, // Copy by value for simulation
-        const Position& current_pos, std::uint64_t captured_mask, CaptureSequence current_sequence,
-        std::unordered_map<SequenceKey, CaptureSequence, SequenceKeyHash>& unique_sequences) const;
+    /**
+     * @brief Appends the non-capture moves of one piece to the list in ascending target order.
+     * @tparam Color Color of the piece on `from`.
+     * @tparam Type Type of the piece on `from`.
+     * @param from Square index of the moving piece.
+     * @param out Move list to append to.
+     */
+    template <PieceColor Color, PieceType Type> void append_regular_moves(std::size_t from, MoveList& out) const;
 
   public:
     /**
@@ -108,6 +118,57 @@ class Explorer {
      */
     [[nodiscard]] Legals find_valid_moves(const Position& from) const;
 
+    /**
+     * @brief Finds the legal moves of every piece of one side without allocating.
+     *
+     * Mandatory capture is resolved for the whole side with a single mask test: when any piece
+     * can capture, only capture moves are listed. Moves are ordered by origin square, then
+     * landing square, then by the sequence of captured squares.
+     * @param color The side to move.
+     * @param out Move list to fill (cleared first).
+     */
+    void find_side_moves(PieceColor color, MoveList& out) const;
+
+    /**
+     * @brief Same as find_side_moves(color, out), specialized for one side at compile time.
+     *
+     * Instantiated for both colors in Explorer.cpp.
+     * @tparam Color The side to move.
+     * @param out Move list to fill (cleared first).
+     */
+    template <PieceColor Color> void find_side_moves(MoveList& out) const;
+
+    /**
+     * @brief Counts the legal moves of one side, listing them only when captures are forced.
+     *
+     * Without a capture the count comes from masks alone: one shift and popcount per forward
+     * direction for all pions at once, and the slide targets of each dame. Capture sequences still
+     * have to be generated, since distinct sequences can capture the same pieces.
+     * @param color The side to move.
+     * @return find_side_moves(color, out).size()
+     */
+    [[nodiscard]] std::size_t count_side_moves(PieceColor color) const;
+
+    /**
+     * @brief Same as count_side_moves(color), specialized for one side at compile time.
+     * @tparam Color The side to move.
+     */
+    template <PieceColor Color> [[nodiscard]] std::size_t count_side_moves() const;
+
+    /**
+     * @brief Gets the mask of pieces of one side that have a capture available.
+     * @param color The side to inspect.
+     * @return Mask with bit i set when the piece at Position::from_index(i) can capture.
+     */
+    [[nodiscard]] std::uint32_t capture_sources(PieceColor color) const noexcept;
+
+    /**
+     * @brief Gets the mask of pieces of one side that have a non-capture move available.
+     * @param color The side to inspect.
+     * @return Mask with bit i set when the piece at Position::from_index(i) can step or slide.
+     */
+    [[nodiscard]] std::uint32_t move_sources(PieceColor color) const noexcept;
+
   private:
     /**
      * @brief Gets all possible non-capture moves for a piece at the given position.
@@ -116,3 +177,83 @@ class Explorer {
      */
     [[nodiscard]] Positions find_regular_moves(const Position& from) const;
 };
+
+/**
+ * @brief Legal moves of the side to move, in the order Game numbers its choices.
+ *
+ * Stateless: no Game, history or cache is built, so any number of threads may call it at once.
+ * @param board The position.
+ * @param side The side to move.
+ * @param out Move list to fill (cleared first).
+ */
+void generate_moves(const Board& board, PieceColor side, MoveList& out);
+
+/**
+ * @brief Number of legal moves of the side to move, as generate_moves would list them.
+ *
+ * Uses Explorer::count_side_moves, so quiet positions are counted without building any move.
+ */
+[[nodiscard]] std::size_t count_moves(const Board& board, PieceColor side);
+
+/**
+ * @brief Lazy range over the non-capture moves of one side, in find_side_moves order.
+ *
+ * A piece's targets are only computed when the iteration reaches it, so a caller that stops after
+ * the first moves (a cutoff, a first legal move) does not pay for the others. Mandatory capture is
+ * not checked: the range is the side's move list only when Explorer::capture_sources is empty.
+ */
+class QuietMoves {
+  public:
+    class iterator {
+      public:
+        using value_type = Move;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        [[nodiscard]] Move operator*() const noexcept {
+            return Move{.from = Position{static_cast<std::uint8_t>(std::countr_zero(sources_))},
+                        .to = Position{static_cast<std::uint8_t>(std::countr_zero(targets_))},
+                        .captured = 0u};
+        }
+        iterator& operator++() noexcept {
+            targets_ &= targets_ - 1;
+            if (targets_ == 0u) {
+                sources_ &= sources_ - 1;
+                load_targets();
+            }
+            return *this;
+        }
+        iterator operator++(int) noexcept {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+        [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept { return sources_ == 0u; }
+
+      private:
+        friend class QuietMoves;
+        iterator(const bitboard::SideMasks& side, PieceColor color) noexcept
+            : side_(side), color_(color), sources_(bitboard::step_sources(side, color)) {
+            load_targets();
+        }
+
+        // Empty squares the piece on the lowest source can reach
+        void load_targets() noexcept;
+
+        bitboard::SideMasks side_{};
+        PieceColor color_{PieceColor::WHITE};
+        bitboard::Mask sources_{0};
+        bitboard::Mask targets_{0};
+    };
+
+    QuietMoves(const Board& board, PieceColor color) noexcept
+        : side_(bitboard::SideMasks::of(board, color)), color_(color) {}
+
+    [[nodiscard]] iterator begin() const noexcept { return iterator(side_, color_); }
+    [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+  private:
+    bitboard::SideMasks side_;
+    PieceColor color_;
+};
@@ -4,63 +4,103 @@
 #include "Piece.h"
 #include "Position.h"
 #include "Legals.h"
+#include "Move.h"
+#include "RepetitionTable.h"
+#include <span>
 #include <string>
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
 
 // Function declarations
 std::string piece_symbol(bool is_black, bool is_dame);
 std::string board_to_string(const Board& board);
-
-// Strongly-typed move representation replacing nested pair structure.
-struct Move {
-    Position from;
-    Position to;
-    std::vector<Position> captured; // empty if non-capture
-
-    [[nodiscard]] bool is_capture() const noexcept { return !captured.empty(); }
-    [[nodiscard]] bool operator==(const Move& other) const noexcept {
-        return from == other.from && to == other.to && captured == other.captured;
-    }
-};
+std::string move_to_string(const Move& move); // e.g. "C6-D5", or "D3xB1" for a capture
 
 class Game {
     Board current_board;
-    // Use combined hash of board+player as key to track board+player combinations
-    std::unordered_map<std::size_t, int> position_count;
     std::vector<uint8_t> index_history;
-    std::vector<Board> board_history; // Store complete board states for proper undo
 
-    mutable bool is_looping_ = false;
-    mutable bool choices_dirty_ = true;
-    mutable std::vector<Move> choices_cache_{};
+    // Occurrences of each board+player key (see get_position_key) on the current path. Positions from
+    // before a capture or pion move can never recur, so the counts only ever grow inside the current
+    // reversible stretch of the game.
+    RepetitionTable position_count;
+    bool is_looping_ = false;
+
+    // Per-ply undo record: XOR delta of the move made, the loop state of the node it left and
+    // whether the move was a capture or pion move
+    struct PlyRecord {
+        BoardDelta delta;
+        bool parent_looping;
+        bool irreversible;
+    };
+    std::vector<PlyRecord> ply_stack_;
+
+    // Per-ply choice cache: slot i holds the moves of the node after i moves, so undo restores the
+    // parent's list without regenerating it
+    struct ChoiceCache {
+        MoveList moves;
+        bool dirty = true;
+    };
+    static constexpr std::size_t INITIAL_PLY_CAPACITY = 256;
+
+    mutable std::vector<ChoiceCache> choices_stack_;
 
   public:
     static Game copy(const Game& other) { return other; }
 
+    /**
+     * @brief Turns this game into a copy of `other`, reusing this game's storage.
+     *
+     * Only the current path is copied: move indices and undo records as one contiguous block each,
+     * and the repetition counts by popping this game's path keys and pushing the other's, so the
+     * cost follows the path lengths and not the table's capacity. Of the choice caches only the
+     * current node's list comes along, the ancestors' lists are regenerated if the copy undoes back
+     * to them. Storage only ever grows, so once a game has held a path this long, cloning into it
+     * allocates nothing.
+     */
+    void copy_from(const Game& other);
+
   private:
-    std::unordered_map<Position, Legals> get_moveable_pieces() const;
-    const std::vector<Move>& get_choices() const;
-    void push_history_state();
+    const MoveList& get_choices() const;
+    std::uint32_t push_history_state();
     void execute_move(const Move& move);
-    bool seen(const Board& board) const noexcept;
+    void init_stacks();
 
     // Helper to create combined hash of board position + current player
     std::size_t get_position_key(const Board& board, PieceColor player) const noexcept;
 
+    // Calls visit(key) with the repetition key of every position on the path, current node first
+    template <typename Visit> void visit_path_keys(Visit&& visit) const;
+
   public:
-    Game() noexcept : current_board(Board::setup()), choices_dirty_(true), choices_cache_{} {
-        board_history.push_back(current_board);   // Initialize with starting position
-        position_count[current_board.hash()] = 1; // Count the starting position
+    Game() noexcept : current_board(Board::setup()) {
+        init_stacks(); // Counts the starting position
+    }
+    Game(Board b) noexcept : current_board(b) {
+        init_stacks(); // Counts the given position
     }
-    Game(Board b) noexcept : current_board(b), choices_dirty_(true), choices_cache_{} {
-        board_history.push_back(current_board);   // Initialize with given position
-        position_count[current_board.hash()] = 1; // Count the given position
+    Game(const Game& other) : current_board(other.current_board) {
+        init_stacks();
+        copy_from(other);
     }
+    Game& operator=(const Game& other) {
+        copy_from(other);
+        return *this;
+    }
+    Game(Game&&) noexcept = default;
+    Game& operator=(Game&&) noexcept = default;
+    ~Game() = default;
 
     [[nodiscard]] std::size_t move_count() const { return is_looping_ ? 0 : get_choices().size(); }
+    // Same as move_count(), but without building the list when it is not cached (count_moves): for
+    // leaves whose moves are never played, such as perft's last ply or a depth-limited horizon
+    [[nodiscard]] std::size_t count_moves() const;
+    // Legal moves of the current node in selection order (empty once the game is over)
+    [[nodiscard]] std::span<const Move> choices() const {
+        return is_looping_ ? std::span<const Move>{} : get_choices().view();
+    }
     void undo_move();
+    // Undoes moves until `length` remain, e.g. back to the root of a task (no-op if shorter)
+    void rewind(std::size_t length);
     void select_move(std::size_t index);
     void print_board() const noexcept;
     void print_choices() const;
@@ -70,4 +110,13 @@ class Game {
     [[nodiscard]] bool is_looping() const noexcept { return is_looping_; }
     [[nodiscard]] const Board& board() const noexcept { return current_board; }
     [[nodiscard]] PieceColor player() const noexcept;
+
+    // Zobrist key of the board with the side to move folded in (the repetition key)
+    [[nodiscard]] zobrist::Key position_key() const noexcept { return get_position_key(current_board, player()); }
+
+    // True when the last move was a capture or a pion move: no earlier position can recur below this
+    // node, so everything under it depends on the board and side to move alone
+    [[nodiscard]] bool after_irreversible_move() const noexcept {
+        return !ply_stack_.empty() && ply_stack_.back().irreversible;
+    }
 };
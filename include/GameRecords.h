@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Piece.h"
+#include "Traversal.h"
+
+/**
+ * @brief One game of a record stream.
+ *
+ * `moves` points into the reader and is only valid until the next record is read. It is empty when
+ * the traversal did not record histories.
+ */
+struct GameRecord {
+    std::uint32_t length{0};          // plies played (size of the game's move sequence)
+    std::optional<PieceColor> winner; // winner if not drawn
+    bool looping{false};              // ended by repetition
+    std::span<const std::uint8_t> moves;
+};
+
+/**
+ * @brief Binary stream of traversal games, written block by block from Traversal result batches.
+ *
+ * The file is a 32-byte header followed by blocks. A block holds the records of one worker in the
+ * order they finished (DFS order), behind a 16-byte block header. Consecutive games of a DFS share
+ * long prefixes, so each record stores only the length of the prefix shared with the previous
+ * record of its block and the move indices after it:
+ *
+ *     outcome byte (winner, looping, has moves), varint length[, varint shared prefix, suffix bytes]
+ *
+ * Every block starts a new prefix chain, so blocks decode independently and the reader never holds
+ * more than one. With zstd available a block can be compressed as one zstd frame.
+ */
+namespace game_records {
+inline constexpr std::array<char, 8> MAGIC = {'T', 'C', 'G', 'A', 'M', 'E', 'S', '\0'};
+inline constexpr std::uint32_t VERSION = 1;
+inline constexpr std::uint32_t FLAG_ZSTD = 1;
+
+// Whether this build can write and read zstd-compressed blocks
+[[nodiscard]] bool compression_available() noexcept;
+} // namespace game_records
+
+class GameRecordWriter {
+  public:
+    static constexpr std::size_t DEFAULT_BLOCK_BYTES = std::size_t{1} << 20;
+
+    struct Options {
+        // Encoded bytes a worker collects before its block is written
+        std::size_t block_bytes{DEFAULT_BLOCK_BYTES};
+        // Keeps every n-th game of each worker (1 keeps them all)
+        std::size_t sample_every{1};
+        bool compress{false};
+        int compression_level{3};
+    };
+
+    /**
+     * @brief Creates (or truncates) the stream file.
+     * @throws std::runtime_error if the file cannot be created.
+     * @throws std::invalid_argument if compression is asked for in a build without zstd.
+     */
+    explicit GameRecordWriter(const std::string& filename, Options options);
+    explicit GameRecordWriter(const std::string& filename) : GameRecordWriter(filename, Options{}) {}
+    // Writes what is left unless close() was called; errors are lost then, so call close()
+    ~GameRecordWriter();
+
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+    /**
+     * @brief Encodes a result batch. Batches of different workers may be written concurrently.
+     * @throws std::runtime_error on I/O errors.
+     */
+    void write(const Traversal::ResultBatch& batch);
+
+    // Result sink for Traversal; the writer must outlive the traversals that use it
+    [[nodiscard]] std::function<void(const Traversal::ResultBatch&)> sink() {
+        return [this](const Traversal::ResultBatch& batch) { write(batch); };
+    }
+
+    /**
+     * @brief Writes the workers' partial blocks and the record count and closes the file.
+     * @throws std::runtime_error on I/O errors.
+     */
+    void close();
+
+    // Records in the blocks written so far (all of them after close())
+    [[nodiscard]] std::uint64_t records() const noexcept { return records_.load(std::memory_order_relaxed); }
+    // File size so far (header and written blocks)
+    [[nodiscard]] std::uint64_t bytes() const noexcept { return bytes_.load(std::memory_order_relaxed); }
+
+  private:
+    // Block being filled by one worker, and the moves of its last record
+    struct Encoder {
+        std::vector<std::uint8_t> block;
+        std::vector<std::uint8_t> previous;
+        std::uint32_t count{0};
+        std::uint64_t seen{0};
+        std::size_t worker{0};
+        std::vector<std::uint8_t> compressed;
+    };
+
+    Options options_;
+    std::string filename_;
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file_;
+    std::mutex encoders_mutex_;
+    std::vector<std::unique_ptr<Encoder>> encoders_; // by worker index
+    std::mutex file_mutex_;
+    std::atomic<std::uint64_t> records_{0};
+    std::atomic<std::uint64_t> bytes_{0};
+
+    [[nodiscard]] Encoder& encoder(std::size_t worker);
+    void flush(Encoder& encoder);
+};
+
+class GameRecordReader {
+  public:
+    /**
+     * @brief Opens a stream written by GameRecordWriter.
+     * @throws std::runtime_error if the file cannot be read, is not a record stream or needs zstd
+     * in a build without it.
+     */
+    explicit GameRecordReader(const std::string& filename);
+
+    /**
+     * @brief Decodes the next record; nullopt at the end of the stream.
+     * @throws std::runtime_error if a block is truncated or corrupt.
+     */
+    [[nodiscard]] std::optional<GameRecord> next();
+
+    [[nodiscard]] bool compressed() const noexcept { return compressed_; }
+    // Record count stored by GameRecordWriter::close() (0 if the writer never closed the file)
+    [[nodiscard]] std::uint64_t stored_records() const noexcept { return stored_records_; }
+    // Worker that wrote the block of the last record
+    [[nodiscard]] std::size_t worker() const noexcept { return worker_; }
+
+  private:
+    std::string filename_;
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file_;
+    bool compressed_{false};
+    std::uint64_t stored_records_{0};
+    std::vector<std::uint8_t> stored_;
+    std::vector<std::uint8_t> block_;
+    std::size_t offset_{0};
+    std::uint32_t remaining_{0};
+    std::size_t worker_{0};
+    std::vector<std::uint8_t> moves_;
+
+    // Loads the next block; false at the end of the file
+    bool read_block();
+};
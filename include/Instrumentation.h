@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Set by the ENABLE_INSTRUMENTATION CMake option
+#ifndef THAI_CHECKERS_INSTRUMENTATION
+#define THAI_CHECKERS_INSTRUMENTATION 0
+#endif
+
+/**
+ * @brief Compile-time optional counters of the hot paths (move generation, capture search, repetitions).
+ *
+ * Every thread counts into its own thread-local Counters, so the hooks are a plain increment with
+ * no sharing. In a build without instrumentation `enabled` is false, every hook is an empty inline
+ * function and the counters stay zero. Readers take the difference of two snapshots of local() on
+ * the thread that did the work (Traversal does this per worker).
+ */
+namespace instrumentation {
+
+inline constexpr bool enabled = THAI_CHECKERS_INSTRUMENTATION != 0;
+
+enum class Counter : std::uint8_t {
+    MOVE_GENERATIONS,     // choice lists generated by Game
+    CHOICE_CACHE_HITS,    // choice lists served from Game's per-ply cache
+    CAPTURE_SEARCH_NODES, // jumps tried by Explorer's capture search
+    DEDUP_COLLISIONS,     // capture sequences dropped as equivalent to one already found
+    REPETITION_LOOKUPS,   // positions counted in the repetition table
+};
+inline constexpr std::size_t COUNTER_COUNT = 5;
+
+enum class Phase : std::uint8_t {
+    MOVE_GENERATION, // Game generating a choice list
+    MAKE_UNMAKE,     // Traversal's select_move and undo_move
+    PROBE,           // Traversal's tablebase, database and transposition probes
+    RESULTS,         // Traversal handing result batches to the sink
+};
+inline constexpr std::size_t PHASE_COUNT = 4;
+
+// Jumps in a capture sequence are bounded by the opponent's 12 pieces
+inline constexpr std::size_t MAX_CAPTURE_DEPTH = 12;
+
+struct Counters {
+    std::array<std::uint64_t, COUNTER_COUNT> counts{};
+    // capture_depths[n]: complete capture sequences of n jumps found by the capture search
+    std::array<std::uint64_t, MAX_CAPTURE_DEPTH + 1> capture_depths{};
+    std::array<std::uint64_t, PHASE_COUNT> phase_ns{};
+
+    [[nodiscard]] std::uint64_t operator[](Counter counter) const noexcept {
+        return counts[static_cast<std::size_t>(counter)];
+    }
+    [[nodiscard]] std::chrono::nanoseconds time(Phase phase) const noexcept {
+        return std::chrono::nanoseconds(phase_ns[static_cast<std::size_t>(phase)]);
+    }
+
+    void merge(const Counters& other) noexcept {
+        for (std::size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+        for (std::size_t i = 0; i < capture_depths.size(); ++i) capture_depths[i] += other.capture_depths[i];
+        for (std::size_t i = 0; i < phase_ns.size(); ++i) phase_ns[i] += other.phase_ns[i];
+    }
+
+    // Counts since an earlier snapshot of the same thread
+    [[nodiscard]] Counters operator-(const Counters& earlier) const noexcept {
+        Counters delta;
+        for (std::size_t i = 0; i < counts.size(); ++i) delta.counts[i] = counts[i] - earlier.counts[i];
+        for (std::size_t i = 0; i < capture_depths.size(); ++i) {
+            delta.capture_depths[i] = capture_depths[i] - earlier.capture_depths[i];
+        }
+        for (std::size_t i = 0; i < phase_ns.size(); ++i) delta.phase_ns[i] = phase_ns[i] - earlier.phase_ns[i];
+        return delta;
+    }
+
+    [[nodiscard]] bool operator==(const Counters&) const = default;
+};
+
+// Counters of the calling thread
+[[nodiscard]] inline Counters& local() noexcept {
+    thread_local Counters counters;
+    return counters;
+}
+
+inline void count(Counter counter, std::uint64_t n = 1) noexcept {
+    if constexpr (enabled) local().counts[static_cast<std::size_t>(counter)] += n;
+}
+
+inline void capture_depth(std::size_t jumps) noexcept {
+    if constexpr (enabled) ++local().capture_depths[jumps < MAX_CAPTURE_DEPTH ? jumps : MAX_CAPTURE_DEPTH];
+}
+
+// Adds the time from construction to destruction to a phase (reads no clock without instrumentation)
+class ScopedPhase {
+  public:
+    explicit ScopedPhase(Phase phase) noexcept : phase_(phase) {
+        if constexpr (enabled) start_ = std::chrono::steady_clock::now();
+    }
+    ~ScopedPhase() {
+        if constexpr (enabled) {
+            const auto elapsed = std::chrono::steady_clock::now() - start_;
+            local().phase_ns[static_cast<std::size_t>(phase_)] +=
+                static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+  private:
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_{};
+};
+
+} // namespace instrumentation
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "Game.h"
+#include "Move.h"
+#include "Playout.h"
+#include "Zobrist.h"
+
+/**
+ * @brief Monte Carlo Tree Search (UCT) player on top of the random playouts.
+ *
+ * Nodes live in one arena allocated up front from the memory limit. A node's children are a
+ * contiguous range of the arena, allocated together when the node is expanded, and each child
+ * stores the index of its move in Game's choice order, so the tree holds no pointers. When the
+ * arena is full the search keeps going without expanding: leaves are just played out more often.
+ *
+ * With several threads all of them descend the same tree (tree parallelism). A node being
+ * descended carries a virtual loss per thread until that thread backs up its result, which steers
+ * the other threads to different lines. Node counters are relaxed atomics.
+ *
+ * The tree is kept between runs: when the game has moved on along expanded nodes (e.g. our move
+ * and the reply), the subtree under the new position is compacted to the front of the arena and
+ * its statistics are reused.
+ */
+class Mcts {
+  public:
+    static constexpr std::size_t DEFAULT_TREE_MB = 64;
+    static constexpr double DEFAULT_EXPLORATION = 1.4;
+
+    // Stops at whichever limit is reached first; at least one must be set
+    struct Limits {
+        std::optional<std::chrono::milliseconds> time;
+        std::optional<std::uint64_t> iterations;
+    };
+
+    struct Result {
+        std::optional<Move> best_move;       // most visited root move; nullopt when the root has no moves
+        std::uint8_t best_index{0};          // index of best_move for Game::select_move
+        double value{0.0};                   // best_move's mean score for the side to move (win 1, draw 0.5)
+        std::uint64_t visits{0};             // visits of best_move
+        std::uint64_t iterations{0};         // iterations of this run
+        std::uint64_t reused{0};             // root visits carried over from the previous run
+        std::size_t nodes{0};                // arena nodes in use
+        bool tree_full{false};               // expansion stopped at the memory limit
+        std::chrono::nanoseconds elapsed{0};
+        std::vector<Move> pv;                // most visited line from the root
+
+        [[nodiscard]] double iterations_per_second() const noexcept {
+            const auto seconds = std::chrono::duration<double>(elapsed).count();
+            return seconds > 0 ? static_cast<double>(iterations) / seconds : 0.0;
+        }
+    };
+
+    // Arena of tree_mb MiB (at least a root and its children)
+    explicit Mcts(std::size_t tree_mb = DEFAULT_TREE_MB);
+
+    void set_threads(std::size_t threads) { threads_ = std::max<std::size_t>(1, threads); }
+    // UCT exploration constant c in mean + c * sqrt(ln(parent visits) / visits)
+    void set_exploration(double exploration) { exploration_ = exploration; }
+    void set_seed(std::uint64_t seed) { seed_ = seed; }
+    // Playouts longer than this count as draws
+    void set_max_playout_plies(std::size_t plies) { max_playout_plies_ = plies; }
+
+    /**
+     * @brief Searches the game's current position; the game is back at that position on return.
+     *
+     * An exception on any thread (a bad_alloc, say) stops the others and is rethrown once they have
+     * joined, with the game back at its position and the tree cleared.
+     * @throws std::invalid_argument if neither limit is set.
+     */
+    Result run(Game& game, const Limits& limits);
+
+    // Forgets the tree
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] std::size_t size() const noexcept {
+        return std::min<std::size_t>(next_free_.load(std::memory_order_relaxed), capacity_);
+    }
+
+  private:
+    static constexpr std::uint8_t UNEXPANDED = 0;
+    static constexpr std::uint8_t EXPANDING = 1;
+    static constexpr std::uint8_t EXPANDED = 2;
+
+    struct Node {
+        // Scores are in half points for the player who made the node's move: win 2, draw 1, loss 0
+        std::atomic<std::uint64_t> score{0};
+        std::atomic<std::uint32_t> visits{0};
+        std::atomic<std::uint32_t> virtual_loss{0};
+        std::atomic<std::uint32_t> first_child{0}; // arena index of the children (never 0, the root)
+        std::atomic<std::uint8_t> child_count{0};
+        std::atomic<std::uint8_t> state{UNEXPANDED};
+        std::uint8_t move{0}; // index in the parent's Game::choices()
+    };
+
+    std::size_t capacity_;
+    std::unique_ptr<Node[]> nodes_;
+    std::atomic<std::size_t> next_free_{0};
+    std::atomic<bool> tree_full_{false};
+
+    // Where the root is: the game's key and move sequence at the last run
+    std::optional<zobrist::Key> root_key_;
+    std::vector<std::uint8_t> root_path_;
+
+    std::size_t threads_{1};
+    // Helper threads' copies of the game, refilled by Game::copy_from every run
+    std::vector<Game> games_;
+    double exploration_{DEFAULT_EXPLORATION};
+    std::uint64_t seed_{0x9E3779B97F4A7C15};
+    std::size_t max_playout_plies_{1000};
+    std::uint64_t run_count_{0};
+
+    // Moves the root to the game's position, reusing the subtree if the game followed expanded nodes
+    void reroot(Game& game);
+    // Copies the subtree under `root` to the front of the arena, children ranges still contiguous
+    void compact(std::uint32_t root);
+    // One selection, expansion, playout and backup; path is scratch space for the nodes visited
+    void iterate(Game& game, playout::Random& random, std::vector<std::uint32_t>& path);
+    [[nodiscard]] std::uint32_t select_child(const Node& node) const noexcept;
+    // Allocates and links the children; false if another thread is expanding or the arena is full
+    bool expand(Node& node, std::size_t move_count) noexcept;
+    [[nodiscard]] std::uint32_t most_visited_child(const Node& node) const noexcept;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Position.h"
+
+/**
+ * @brief Compact move: origin, landing square and the mask of captured squares.
+ *
+ * Bit i of `captured` corresponds to Position::from_index(i), matching the Board masks.
+ */
+struct Move {
+    Position from{};
+    Position to{};
+    std::uint32_t captured{}; // 0 if non-capture
+
+    [[nodiscard]] constexpr bool is_capture() const noexcept { return captured != 0u; }
+    [[nodiscard]] constexpr std::size_t capture_count() const noexcept {
+        return static_cast<std::size_t>(std::popcount(captured));
+    }
+    [[nodiscard]] constexpr bool operator==(const Move&) const noexcept = default;
+};
+
+static_assert(sizeof(Move) == 8, "Move must stay compact");
+
+/**
+ * @brief Inline fixed-capacity list of moves; never allocates.
+ *
+ * The capacity covers every position reachable in a game (at most 8 pieces per side,
+ * each dame sliding to at most 13 squares); pushing beyond it is a logic error.
+ */
+class MoveList {
+  public:
+    static constexpr std::size_t capacity = 128;
+
+    constexpr void clear() noexcept { size_ = 0; }
+    constexpr void push_back(const Move& move) noexcept {
+        assert(size_ < capacity && "MoveList capacity exceeded");
+        if (size_ < capacity) moves_[size_++] = move;
+    }
+    constexpr void resize(std::size_t n) noexcept { size_ = n < capacity ? n : capacity; }
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+
+    [[nodiscard]] constexpr Move& operator[](std::size_t i) noexcept { return moves_[i]; }
+    [[nodiscard]] constexpr const Move& operator[](std::size_t i) const noexcept { return moves_[i]; }
+
+    [[nodiscard]] constexpr Move* begin() noexcept { return moves_.data(); }
+    [[nodiscard]] constexpr Move* end() noexcept { return moves_.data() + size_; }
+    [[nodiscard]] constexpr const Move* begin() const noexcept { return moves_.data(); }
+    [[nodiscard]] constexpr const Move* end() const noexcept { return moves_.data() + size_; }
+
+    [[nodiscard]] constexpr std::span<const Move> view() const noexcept { return {moves_.data(), size_}; }
+
+  private:
+    std::array<Move, capacity> moves_{};
+    std::size_t size_{0};
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Game.h"
+
+/**
+ * @brief Perft-style node counting: the number of move paths exactly `depth` plies long.
+ *
+ * Games that end above the horizon (no moves left or a third repetition) contribute no
+ * leaves. The last ply is counted in bulk from the generated move list, without making
+ * the moves, so the figure measures move generation plus make/unmake of inner nodes only.
+ */
+namespace perft {
+
+[[nodiscard]] std::uint64_t perft(Game& game, std::size_t depth);
+
+// Leaf count below one root move
+struct DivideEntry {
+    Move move;
+    std::uint64_t nodes;
+};
+
+/**
+ * @brief Splits perft(depth) by root move, in selection order.
+ *
+ * The entries sum to perft(game, depth); depth 0 yields no entries.
+ */
+[[nodiscard]] std::vector<DivideEntry> divide(Game& game, std::size_t depth);
+
+} // namespace perft
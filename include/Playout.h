@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Game.h"
+#include "Piece.h"
+#include "TraversalStatistics.h"
+
+/**
+ * @brief Monte Carlo sampling of the game: many games of uniformly random moves from one root.
+ *
+ * Every playout has an index and draws its moves from a generator seeded by (seed, index), so the
+ * statistics of a fixed number of playouts are the same for any thread count. Each thread keeps
+ * one Game and rewinds it to the root with undo_move after every playout, so after the first few
+ * games no playout allocates. A move is picked by index straight from the cached choice list.
+ */
+namespace playout {
+
+// xoshiro256**: a few cycles per number and plenty of quality for move sampling
+class Random {
+  public:
+    explicit Random(std::uint64_t seed) noexcept;
+
+    [[nodiscard]] std::uint64_t next() noexcept;
+
+    // Uniform in [0, n) for n > 0, by multiply-shift instead of division (bias below 2^-32 for n < 2^32)
+    [[nodiscard]] std::size_t below(std::size_t n) noexcept {
+        return static_cast<std::size_t>((next() >> 32) * static_cast<std::uint64_t>(n) >> 32);
+    }
+
+  private:
+    std::uint64_t state_[4];
+};
+
+// How a playout ended
+struct Outcome {
+    bool finished{false};              // false if stopped at the ply limit
+    std::optional<PieceColor> winner;  // nullopt for a repetition draw (or an unfinished game)
+    std::size_t length{0};             // plies played
+};
+
+struct Statistics {
+    TraversalStatistics outcomes;       // finished games, with their winner and length in plies
+    std::uint64_t unfinished{0};        // games stopped at the ply limit
+    std::uint64_t plies{0};             // plies played over every game, finished or not
+    std::vector<std::uint64_t> lengths; // lengths[n]: finished games of n plies
+
+    void record(const Outcome& outcome);
+    void merge(const Statistics& other);
+
+    [[nodiscard]] std::uint64_t playouts() const noexcept { return outcomes.games + unfinished; }
+    // Mean length of the finished games
+    [[nodiscard]] double mean_length() const noexcept;
+
+    [[nodiscard]] bool operator==(const Statistics&) const = default;
+};
+
+struct Options {
+    std::size_t threads{1};
+    std::uint64_t seed{0x9E3779B97F4A7C15};
+    // A playout longer than this is given up (dames can shuffle for a very long time before a repetition)
+    std::size_t max_plies{1000};
+};
+
+// Stops at whichever limit is reached first; at least one must be set
+struct Limits {
+    std::optional<std::chrono::milliseconds> time;
+    std::optional<std::uint64_t> playouts;
+};
+
+struct Result {
+    Statistics stats;
+    std::chrono::nanoseconds elapsed{0};
+
+    [[nodiscard]] double playouts_per_second() const noexcept {
+        const auto seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds > 0 ? static_cast<double>(stats.playouts()) / seconds : 0.0;
+    }
+};
+
+// Plays random moves until the game ends or max_plies moves were made, then rewinds the game
+[[nodiscard]] Outcome play(Game& game, Random& random, std::size_t max_plies);
+
+/**
+ * @brief Runs playouts from the game's current position on options.threads threads.
+ *
+ * The game itself is not modified; every thread plays on its own copy. An exception on any thread
+ * (a bad_alloc, say) stops the others and is rethrown once they have joined.
+ * @throws std::invalid_argument if neither limit is set.
+ */
+[[nodiscard]] Result run(const Game& root, const Limits& limits, const Options& options = {});
+
+} // namespace playout
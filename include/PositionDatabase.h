@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "Piece.h"
+#include "TraversalStatistics.h"
+
+/**
+ * @brief Read-only, memory-mapped file of finished subtree statistics keyed by position.
+ *
+ * The file is a 32-byte header followed by fixed 56-byte records sorted by (occ, black, dame,
+ * side to move), all in native byte order. Opening maps the file read-only and checks the header;
+ * nothing is parsed or copied, lookups binary-search the mapped records in place, and every process
+ * that opens the same file shares its pages through the page cache.
+ *
+ * Entries are only meaningful for positions whose subtree does not depend on the path that reached
+ * them (see Traversal::TranspositionMode::EXACT): Traversal only consults the database at nodes
+ * entered by a capture or pion move.
+ */
+class PositionDatabase {
+  public:
+    struct Record {
+        std::uint32_t occ;
+        std::uint32_t black; // subset of occ
+        std::uint32_t dame;  // subset of occ
+        std::uint8_t side;   // PieceColor to move
+        std::array<std::uint8_t, 3> padding;
+        std::uint64_t games;
+        std::uint64_t black_wins;
+        std::uint64_t white_wins;
+        std::uint64_t draws;
+        std::uint32_t min_length; // plies, relative to the position
+        std::uint32_t max_length;
+
+        [[nodiscard]] static Record of(const Board& board, PieceColor side, const TraversalStatistics& stats) noexcept;
+        [[nodiscard]] TraversalStatistics statistics() const noexcept;
+        // White-to-move form of the record (see Board::canonical): black-to-move records are mirrored
+        [[nodiscard]] Record canonical() const noexcept;
+    };
+    static_assert(sizeof(Record) == 56, "Record layout is part of the file format");
+
+    static constexpr std::array<char, 8> MAGIC = {'T', 'C', 'P', 'D', 'B', '\0', '\0', '\0'};
+    static constexpr std::uint32_t VERSION = 1;
+    // Every record is stored in white-to-move form; lookups mirror black-to-move positions
+    static constexpr std::uint64_t FLAG_CANONICAL = 1;
+
+    /**
+     * @brief Maps an existing database file.
+     * @throws std::runtime_error if the file cannot be mapped or is not a database of this version.
+     */
+    [[nodiscard]] static PositionDatabase open(const std::string& path);
+
+    /**
+     * @brief Sorts the records and writes them as a database file (later duplicates are dropped).
+     *
+     * A canonical database stores each pair of mirrored positions once (see Board::canonical), so
+     * the same file covers up to twice the positions; find() mirrors its lookups to match.
+     * @throws std::runtime_error on I/O errors.
+     */
+    static void write(const std::string& path, std::vector<Record> records, bool canonical = false);
+
+    PositionDatabase(PositionDatabase&& other) noexcept;
+    PositionDatabase& operator=(PositionDatabase&& other) noexcept;
+    PositionDatabase(const PositionDatabase&) = delete;
+    PositionDatabase& operator=(const PositionDatabase&) = delete;
+    ~PositionDatabase();
+
+    // Statistics of the subtree below the position, if stored
+    [[nodiscard]] std::optional<TraversalStatistics> find(const Board& board, PieceColor side) const noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return records_.size(); }
+    [[nodiscard]] bool canonical() const noexcept { return canonical_; }
+    [[nodiscard]] std::span<const Record> records() const noexcept { return records_; }
+
+  private:
+    struct Header {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t record_size;
+        std::uint64_t record_count;
+        std::uint64_t flags;
+    };
+    static_assert(sizeof(Header) == 32, "Header layout is part of the file format");
+
+    PositionDatabase(void* mapping, std::size_t mapping_size, std::span<const Record> records, bool canonical) noexcept
+        : mapping_(mapping), mapping_size_(mapping_size), records_(records), canonical_(canonical) {}
+
+    // Exact lookup of a stored record's key
+    [[nodiscard]] std::optional<TraversalStatistics> find_record(const Board& board, PieceColor side) const noexcept;
+
+    void* mapping_{nullptr};
+    std::size_t mapping_size_{0};
+    std::span<const Record> records_;
+    bool canonical_{false};
+};
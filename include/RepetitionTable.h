@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Instrumentation.h"
+#include "Zobrist.h"
+
+/**
+ * @brief Flat open-addressing multiset of the position keys on the current game path.
+ *
+ * Linear probing over a power-of-two slot array with backward-shift deletion, so there are
+ * no tombstones and no per-entry allocation. Game pushes a key on every move and pops it on
+ * undo; a slot only holds distinct keys with their occurrence count.
+ */
+class RepetitionTable {
+  public:
+    static constexpr std::size_t INITIAL_CAPACITY = 1024;
+
+    RepetitionTable() : slots_(INITIAL_CAPACITY), mask_(INITIAL_CAPACITY - 1) {}
+
+    /**
+     * @brief Adds one occurrence of a key.
+     * @return Number of occurrences of the key now on the path.
+     */
+    std::uint32_t push(zobrist::Key key) {
+        instrumentation::count(instrumentation::Counter::REPETITION_LOOKUPS);
+        if ((used_ + 1) * 2 > slots_.size()) grow();
+        auto i = home(key);
+        while (slots_[i].count != 0 && slots_[i].key != key) i = (i + 1) & mask_;
+        if (slots_[i].count == 0) {
+            slots_[i].key = key;
+            ++used_;
+        }
+        return ++slots_[i].count;
+    }
+
+    /**
+     * @brief Removes one occurrence of a key previously pushed.
+     */
+    void pop(zobrist::Key key) noexcept {
+        auto i = home(key);
+        while (slots_[i].count != 0 && slots_[i].key != key) i = (i + 1) & mask_;
+        if (slots_[i].count == 0) return;
+        if (--slots_[i].count == 0) erase_slot(i);
+    }
+
+    /**
+     * @brief Gets the number of occurrences of a key on the path.
+     */
+    [[nodiscard]] std::uint32_t count(zobrist::Key key) const noexcept {
+        auto i = home(key);
+        while (slots_[i].count != 0) {
+            if (slots_[i].key == key) return slots_[i].count;
+            i = (i + 1) & mask_;
+        }
+        return 0;
+    }
+
+    void clear() noexcept {
+        for (auto& slot : slots_) slot = Slot{};
+        used_ = 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return used_; }
+
+  private:
+    struct Slot {
+        zobrist::Key key{};
+        std::uint32_t count{0}; // 0 => empty
+    };
+
+    std::vector<Slot> slots_;
+    std::size_t mask_;
+    std::size_t used_{0};
+
+    // Zobrist keys are uniformly distributed, so the high bits are a good slot index
+    [[nodiscard]] std::size_t home(zobrist::Key key) const noexcept {
+        return static_cast<std::size_t>(key >> 32) & mask_;
+    }
+
+    // Backward-shift deletion: pull later entries of the cluster into the hole if their home allows it
+    void erase_slot(std::size_t hole) noexcept {
+        auto j = hole;
+        while (true) {
+            j = (j + 1) & mask_;
+            if (slots_[j].count == 0) break;
+            const auto h = home(slots_[j].key);
+            // Move the entry unless its home lies cyclically in (hole, j]
+            const bool stays = hole <= j ? (hole < h && h <= j) : (hole < h || h <= j);
+            if (stays) continue;
+            slots_[hole] = slots_[j];
+            hole = j;
+        }
+        slots_[hole] = Slot{};
+        --used_;
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots_.size() * 2);
+        old.swap(slots_);
+        mask_ = slots_.size() - 1;
+        for (const auto& slot : old) {
+            if (slot.count == 0) continue;
+            auto i = home(slot.key);
+            while (slots_[i].count != 0) i = (i + 1) & mask_;
+            slots_[i] = slot;
+        }
+    }
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "Board.h"
+#include "Game.h"
+#include "Move.h"
+#include "Piece.h"
+#include "Zobrist.h"
+
+/**
+ * @brief Negamax alpha-beta search with iterative deepening on top of Game's make/unmake path.
+ *
+ * Scores are from the side to move's point of view. A side without moves loses and a third
+ * repetition is a draw, exactly as in Game. Because captures are mandatory, lines that reach the
+ * horizon with a capture pending are searched on until the captures are resolved, so the evaluation
+ * is never asked about a position in the middle of an exchange.
+ *
+ * Moves are ordered by the transposition table move, then captures (most pieces taken first), then
+ * the two killer moves of the ply, then the history score of their (from, to) squares. The table keys
+ * are Game::position_key(); its entries ignore how a position was reached, so repetition draws found
+ * through one path may be reused on another (the usual engine trade-off).
+ *
+ * With more than one thread the search is Lazy SMP: every thread runs its own iterative deepening
+ * on the same root and they only share the transposition table, so each finds the others' results
+ * as cutoffs and move hints. Odd threads start one ply deeper to spread the work. The table is
+ * lock-free: an entry is two relaxed atomic words and the check word is the key XOR-ed with the data
+ * word, so an entry torn by two concurrent writers fails verification and reads as a miss.
+ */
+class Search {
+  public:
+    using Score = int;
+
+    static constexpr std::size_t MAX_PLY = 128;
+    // A win at ply p scores WIN_SCORE - p, so shorter wins are preferred
+    static constexpr Score WIN_SCORE = 30000;
+    static constexpr Score WIN_THRESHOLD = WIN_SCORE - static_cast<Score>(MAX_PLY);
+    static constexpr std::size_t DEFAULT_TABLE_MB = 16;
+
+    // Static score of a position for the side to move
+    using Evaluator = std::function<Score(const Board&, PieceColor)>;
+
+    // Weights of evaluate_material (shared with the BoardBatch kernels)
+    static constexpr Score PION_VALUE = 100;
+    static constexpr Score DAME_VALUE = 300;
+    static constexpr Score ADVANCE_VALUE = 4;
+
+    // Default evaluation: material (dames count triple) plus a small bonus per row a pion has advanced
+    [[nodiscard]] static Score evaluate_material(const Board& board, PieceColor side) noexcept;
+
+    // Stops at whichever limit is reached first; the last completed iteration is reported
+    struct Limits {
+        std::optional<std::chrono::milliseconds> time;
+        std::optional<std::uint64_t> nodes;
+        std::size_t depth{MAX_PLY - 1};
+    };
+
+    struct Result {
+        std::optional<Move> best_move;           // nullopt when the root has no moves
+        std::uint8_t best_index{0};              // index of best_move for Game::select_move
+        Score score{0};
+        std::size_t depth{0};                    // last completed iteration
+        std::uint64_t nodes{0};                  // nodes of every iteration, including an unfinished last one
+        std::chrono::nanoseconds elapsed{0};     // until the end of the search (in callbacks: so far)
+        std::vector<Move> pv;                    // principal variation, starting with best_move
+        std::vector<std::uint64_t> thread_nodes; // nodes per thread, summing to `nodes`
+
+        [[nodiscard]] double nodes_per_second() const noexcept {
+            const auto seconds = std::chrono::duration<double>(elapsed).count();
+            return seconds > 0 ? static_cast<double>(nodes) / seconds : 0.0;
+        }
+        [[nodiscard]] bool is_win() const noexcept { return score >= WIN_THRESHOLD; }
+        [[nodiscard]] bool is_loss() const noexcept { return score <= -WIN_THRESHOLD; }
+    };
+
+    /**
+     * @brief Construct with a transposition table of the given size (MiB) and an optional callback
+     * that receives the result of every completed iteration.
+     *
+     * With several threads the callback is called, under a lock, whenever any thread completes an
+     * iteration deeper than every one reported before.
+     */
+    explicit Search(std::size_t table_mb = DEFAULT_TABLE_MB, std::function<void(const Result&)> info_cb = {});
+
+    // The evaluator is called concurrently when searching with several threads
+    void set_evaluator(Evaluator evaluator) { evaluator_ = std::move(evaluator); }
+
+    // Number of Lazy SMP threads; 1 (the default) searches on the calling thread only
+    void set_threads(std::size_t threads);
+
+    /**
+     * @brief Searches the game's current position; the game is back at that position on return.
+     *
+     * The table, killers and history carry over between calls (e.g. along a game); clear() forgets them.
+     * An exception thrown on any search thread (by the evaluator, say) stops every thread and is
+     * rethrown here, with the game back at the searched position.
+     */
+    Result run(Game& game, const Limits& limits);
+
+    void clear();
+
+  private:
+    enum class Bound : std::uint8_t { NONE, EXACT, LOWER, UPPER };
+
+    // Unpacked table entry; `bound` is NONE for a miss
+    struct Probe {
+        std::int32_t score{0};
+        std::uint8_t depth{0};
+        Bound bound{Bound::NONE};
+        std::uint8_t best{0};
+        std::uint8_t generation{0};
+    };
+
+    struct Entry {
+        std::atomic<std::uint64_t> check{0}; // key ^ data
+        std::atomic<std::uint64_t> data{0};  // score, depth, bound, best move, generation
+
+        // Verified entry for the key, or a miss
+        [[nodiscard]] Probe read(zobrist::Key key) const noexcept;
+        // Whatever is stored, unverified (for the replacement decision)
+        [[nodiscard]] Probe stored() const noexcept;
+        void write(zobrist::Key key, const Probe& probe) noexcept;
+    };
+
+    // Per-thread search state; killers and history carry over between runs
+    struct Worker {
+        std::size_t id{0};
+        std::uint64_t nodes{0};
+        std::array<std::array<Move, 2>, MAX_PLY> killers{};
+        // Indexed by from square * 32 + to square
+        std::array<std::uint32_t, 32 * 32> history{};
+        // Triangular principal variation: pv[ply] holds the line below ply
+        std::array<std::array<std::uint8_t, MAX_PLY>, MAX_PLY> pv{};
+        std::array<std::size_t, MAX_PLY> pv_length{};
+        Result result; // last completed iteration
+        Game game;     // helpers' copy of the searched game, refilled by Game::copy_from every run
+    };
+
+    std::size_t table_size_;
+    std::unique_ptr<Entry[]> table_;
+    std::uint8_t generation_{0};
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    Evaluator evaluator_;
+    std::function<void(const Result&)> info_cb_;
+
+    // Limits and progress of the current run
+    std::atomic<std::uint64_t> shared_nodes_{0}; // published in steps of the check interval
+    std::optional<std::uint64_t> node_limit_;
+    std::optional<std::chrono::steady_clock::time_point> deadline_;
+    std::chrono::steady_clock::time_point start_;
+    std::atomic<bool> stopped_{false};
+    std::mutex report_mutex_;
+    std::size_t reported_depth_{0};
+
+    Score negamax(Worker& worker, Game& game, int depth, Score alpha, Score beta, std::size_t ply);
+    void iterate(Worker& worker, Game& game, std::size_t first_depth, std::size_t max_depth);
+    void order_moves(const Worker& worker, const MoveList& moves, std::size_t ply,
+                     std::optional<std::uint8_t> table_move, std::array<std::int32_t, MoveList::capacity>& scores) const;
+    void check_limits(Worker& worker) noexcept;
+
+    [[nodiscard]] Entry& entry_for(zobrist::Key key) noexcept { return table_[key & (table_size_ - 1)]; }
+};
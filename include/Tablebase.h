@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Board.h"
+#include "Piece.h"
+
+/**
+ * @brief Win/draw/loss tablebase for every position with up to a given number of pieces.
+ *
+ * Only white-to-move positions are stored: black to move on a board plays like white to move on the
+ * mirrored board (Board::mirrored), and values are for the side to move, so both share one entry.
+ * The white-to-move positions with n pieces are numbered by a perfect (bijective) index over the 32
+ * playable squares: the combinatorial rank of the occupied-square set, then one color bit and one
+ * type bit per piece in ascending square order. Each value takes 2 bits (32 positions per word).
+ *
+ * Values are game-theoretic for the side to move, with the game rules of Game: a side without moves
+ * loses, captures are mandatory, and a line that can only be prolonged forever (repetition) is a draw.
+ * Unreachable placements (e.g. a pion on its own promotion row) are indexed and solved like any other.
+ */
+class Tablebase {
+  public:
+    enum class Value : std::uint8_t { UNKNOWN = 0, WIN = 1, LOSS = 2, DRAW = 3 };
+
+    // 2^(2n) * C(32, n) positions: 6 pieces take about 930 MB, 5 pieces about 50 MB
+    static constexpr std::size_t MAX_SUPPORTED_PIECES = 6;
+
+    /**
+     * @brief Solves every slice from 0 to max_pieces pieces by retrograde analysis.
+     *
+     * Each slice is initialized by forward generation (positions without moves are losses; capture
+     * positions only lead into smaller, already solved slices), then solved in rounds: the positions
+     * decided in one round are taken back through non-capture unmoves (the inverse of a step, slide
+     * or promotion) and their predecessors are decided in the next. Work is split across threads by
+     * index range; values are set with atomic compare-and-swap, so the result does not depend on the
+     * schedule. Positions never decided are draws.
+     * @throws std::invalid_argument if max_pieces exceeds MAX_SUPPORTED_PIECES.
+     */
+    [[nodiscard]] static Tablebase build(std::size_t max_pieces, std::size_t threads = 1);
+
+    /**
+     * @brief Loads a tablebase written by save().
+     * @throws std::runtime_error if the file cannot be read or is not a tablebase.
+     */
+    [[nodiscard]] static Tablebase load(const std::string& path);
+
+    // @throws std::runtime_error on I/O errors
+    void save(const std::string& path) const;
+
+    // Value for the side to move, or nullopt when the position has more pieces than the tablebase
+    [[nodiscard]] std::optional<Value> probe(const Board& board, PieceColor side) const noexcept;
+
+    [[nodiscard]] std::size_t max_pieces() const noexcept { return slices_.empty() ? 0 : slices_.size() - 1; }
+
+    // Number of white-to-move positions with exactly n pieces
+    [[nodiscard]] static std::uint64_t slice_size(std::size_t pieces) noexcept;
+
+    // Index of a position within its slice (the slice is the number of occupied squares); black to
+    // move shares the index of its mirrored white-to-move twin
+    [[nodiscard]] static std::uint64_t index(const Board& board, PieceColor side) noexcept;
+
+    // Inverse of index() within the slice of the given piece count: always a white-to-move position
+    [[nodiscard]] static std::pair<Board, PieceColor> position(std::size_t pieces, std::uint64_t index) noexcept;
+
+  private:
+    // slices_[n] holds the 2-bit values of the n-piece positions
+    std::vector<std::vector<std::uint64_t>> slices_;
+};
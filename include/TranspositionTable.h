@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "TraversalStatistics.h"
+#include "Zobrist.h"
+
+/**
+ * @brief Fixed-size, lock-free cache of finished subtree statistics keyed by position.
+ *
+ * Any number of threads may probe and store concurrently. Every field is a relaxed atomic word and the
+ * stored check word is the key XOR-ed with all payload words, so a torn read (two writers interleaving
+ * on one entry) fails verification and reads as a miss instead of returning mixed counts. Lengths are
+ * stored relative to the subtree root.
+ *
+ * Each bucket has two entries: the first keeps the largest subtree seen, the second always takes the
+ * newest store.
+ */
+class TranspositionTable {
+  public:
+    // Sized in MiB, rounded down to a power-of-two number of buckets (at least one)
+    explicit TranspositionTable(std::size_t size_mb)
+        : bucket_count_(std::bit_floor(std::max<std::size_t>(1, (size_mb << 20) / sizeof(Bucket)))),
+          buckets_(std::make_unique<Bucket[]>(bucket_count_)) {}
+
+    [[nodiscard]] std::optional<TraversalStatistics> probe(zobrist::Key key) const noexcept {
+        const auto& bucket = bucket_for(key);
+        for (const auto& entry : bucket.entries) {
+            if (auto stats = entry.read(key)) return stats;
+        }
+        return std::nullopt;
+    }
+
+    void store(zobrist::Key key, const TraversalStatistics& stats) noexcept {
+        if (stats.games == 0) return;
+        auto& bucket = bucket_for(key);
+        auto& preferred = bucket.entries[0];
+        const bool same_key = preferred.read(key).has_value();
+        if (same_key || preferred.games.load(std::memory_order_relaxed) <= stats.games) {
+            preferred.write(key, stats);
+        } else {
+            bucket.entries[1].write(key, stats);
+        }
+    }
+
+    void clear() noexcept {
+        for (std::size_t i = 0; i < bucket_count_; ++i) {
+            for (auto& entry : buckets_[i].entries) entry.write(0, TraversalStatistics{});
+        }
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return bucket_count_ * 2; }
+
+  private:
+    struct Entry {
+        std::atomic<std::uint64_t> check{0};
+        std::atomic<std::uint64_t> games{0}; // 0 => empty
+        std::atomic<std::uint64_t> black_wins{0};
+        std::atomic<std::uint64_t> white_wins{0};
+        std::atomic<std::uint64_t> draws{0};
+        std::atomic<std::uint64_t> min_length{0};
+        std::atomic<std::uint64_t> max_length{0};
+
+        [[nodiscard]] std::optional<TraversalStatistics> read(zobrist::Key key) const noexcept {
+            const TraversalStatistics stats{
+                .games = games.load(std::memory_order_relaxed),
+                .black_wins = black_wins.load(std::memory_order_relaxed),
+                .white_wins = white_wins.load(std::memory_order_relaxed),
+                .draws = draws.load(std::memory_order_relaxed),
+                .min_length = min_length.load(std::memory_order_relaxed),
+                .max_length = max_length.load(std::memory_order_relaxed),
+            };
+            if (stats.games == 0 || check.load(std::memory_order_relaxed) != (key ^ fold(stats))) return std::nullopt;
+            return stats;
+        }
+
+        void write(zobrist::Key key, const TraversalStatistics& stats) noexcept {
+            check.store(key ^ fold(stats), std::memory_order_relaxed);
+            games.store(stats.games, std::memory_order_relaxed);
+            black_wins.store(stats.black_wins, std::memory_order_relaxed);
+            white_wins.store(stats.white_wins, std::memory_order_relaxed);
+            draws.store(stats.draws, std::memory_order_relaxed);
+            min_length.store(stats.min_length, std::memory_order_relaxed);
+            max_length.store(stats.max_length, std::memory_order_relaxed);
+        }
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[2];
+    };
+
+    std::size_t bucket_count_;
+    std::unique_ptr<Bucket[]> buckets_;
+
+    // Rotations keep equal payload words from cancelling each other out
+    [[nodiscard]] static constexpr std::uint64_t fold(const TraversalStatistics& s) noexcept {
+        return s.games ^ std::rotl(std::uint64_t{s.black_wins}, 11) ^ std::rotl(std::uint64_t{s.white_wins}, 22) ^
+               std::rotl(std::uint64_t{s.draws}, 33) ^ std::rotl(std::uint64_t{s.min_length}, 44) ^
+               std::rotl(std::uint64_t{s.max_length}, 55);
+    }
+
+    [[nodiscard]] const Bucket& bucket_for(zobrist::Key key) const noexcept {
+        return buckets_[static_cast<std::size_t>(key >> 32) & (bucket_count_ - 1)];
+    }
+    [[nodiscard]] Bucket& bucket_for(zobrist::Key key) noexcept {
+        return buckets_[static_cast<std::size_t>(key >> 32) & (bucket_count_ - 1)];
+    }
+};
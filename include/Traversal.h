@@ -1,47 +1,411 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
-#include <unordered_set>
+#include <span>
+#include <string>
 #include <vector>
+#include "Checkpoint.h"
 #include "Game.h"
+#include "Instrumentation.h"
+#include "TranspositionTable.h"
+#include "TraversalBreakdown.h"
+#include "TraversalStatistics.h"
+
+class PositionDatabase;
+class Tablebase;
 
 class Traversal {
   public:
     void traverse_for(Game& game, std::optional<std::chrono::milliseconds> timeout = std::nullopt);
-    struct ResultEvent {
-        std::size_t game_id;              // total games completed so far
-        bool looping;                     // true if ended due to repetition
+
+    /**
+     * @brief Continues a traversal saved in a checkpoint, with a fresh timeout.
+     *
+     * The game must be at the checkpoint's root. Statistics and hit counters continue from the saved
+     * values, and the result sink only receives the games that were not finished before the checkpoint.
+     * @throws std::invalid_argument if the game is not at the checkpoint's root, the depth limit differs from the
+     *         checkpoint's or the frontier does not fit its tree.
+     */
+    void resume_for(Game& game, const Checkpoint& checkpoint,
+                    std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+    // Compact outcome of one finished game
+    struct ResultRecord {
+        std::uint32_t length;             // plies played (size of the game's move sequence)
+        std::uint32_t history_offset;     // start of its move indices in ResultBatch::histories, if recorded
         std::optional<PieceColor> winner; // winner if not looping
-        std::vector<uint8_t> history;     // sequence of board state hashes (initial + each resulting state)
+        bool looping;                     // true if ended due to repetition
+    };
+    /**
+     * @brief Results handed to the sink in one call: up to the batch size records of one worker.
+     *
+     * The spans point into the worker's buffers and are only valid during the call.
+     */
+    struct ResultBatch {
+        std::size_t worker;                      // index of the worker that produced the batch
+        std::span<const ResultRecord> records;   // in the order the games finished
+        std::span<const std::uint8_t> histories; // move indices of every record; empty unless enabled
+
+        // Move indices of one record of this batch (empty unless histories are recorded)
+        [[nodiscard]] std::span<const std::uint8_t> history(const ResultRecord& record) const noexcept {
+            return histories.empty() ? histories : histories.subspan(record.history_offset, record.length);
+        }
+    };
+    // Shape of the enumerated tree; counted in every build, at a few increments per node
+    struct NodeCounters {
+        std::uint64_t nodes{0};            // positions entered, the root and finished games included
+        std::uint64_t inner_nodes{0};      // positions whose children were explored
+        std::uint64_t children{0};         // moves available at the inner nodes
+        std::vector<std::uint64_t> depths; // depths[d]: positions entered d plies below the root
+
+        [[nodiscard]] double branching_factor() const noexcept {
+            return inner_nodes == 0 ? 0.0 : static_cast<double>(children) / static_cast<double>(inner_nodes);
+        }
+        void merge(const NodeCounters& other);
     };
     struct ProgressEvent {
         std::size_t games;
+        std::uint64_t nodes{0};
+        std::uint64_t inner_nodes{0};
+        std::uint64_t children{0};
+        std::chrono::nanoseconds elapsed{0};  // since the traversal started
+        instrumentation::Counters counters{}; // all zero unless built with instrumentation
+
+        [[nodiscard]] double nodes_per_second() const noexcept {
+            const auto seconds = std::chrono::duration<double>(elapsed).count();
+            return seconds > 0 ? static_cast<double>(nodes) / seconds : 0.0;
+        }
+        [[nodiscard]] double branching_factor() const noexcept {
+            return inner_nodes == 0 ? 0.0 : static_cast<double>(children) / static_cast<double>(inner_nodes);
+        }
     };
-    // Construct with optional callbacks
-    explicit Traversal(std::function<void(const ResultEvent&)> result_cb = {},
+    // Aggregated outcome of every finished game
+    using Statistics = TraversalStatistics;
+
+    enum class TranspositionMode : std::uint8_t {
+        // No caching: every game is enumerated
+        OFF,
+        // Subtrees are cached and reused only at nodes entered by a capture or pion move. Below such a
+        // node no earlier position can recur, so its subtree depends on the board and side to move alone
+        // and the statistics are identical to a full enumeration. Inside a reversible stretch (dame moves
+        // only) the outcome also depends on the repetition counts of the path, which a position key cannot
+        // capture; those nodes are never probed or stored and are always enumerated.
+        EXACT,
+        // EXACT with one entry per color-swap symmetry class (see Board::canonical): black-to-move
+        // positions are stored and probed as their mirrored white-to-move twin with the winners swapped,
+        // so a table of the same size holds twice the subtrees
+        CANONICAL,
+    };
+    static constexpr std::size_t DEFAULT_RESULT_BATCH_SIZE = 4096;
+    static constexpr std::chrono::milliseconds DEFAULT_CHECKPOINT_INTERVAL{60000};
+    // A worker also flushes once its history arena reaches this size
+    static constexpr std::size_t HISTORY_ARENA_BYTES = std::size_t{1} << 20;
+
+    /**
+     * @brief Construct with an optional result sink and progress callback.
+     *
+     * Each worker buffers its results and calls the sink once per full batch and once more at the end
+     * of the traversal. In parallel mode the sink is called concurrently from the worker threads,
+     * without locking; ResultBatch::worker lets it keep per-worker state. An exception thrown by the
+     * sink stops the traversal and is rethrown by traverse_for() or resume_for(), in parallel mode
+     * once every worker has stopped.
+     */
+    explicit Traversal(std::function<void(const ResultBatch&)> result_sink = {},
                        std::function<void(const ProgressEvent&)> progress_cb = {})
-        : result_cb_(std::move(result_cb)), progress_cb_(std::move(progress_cb)) {}
+        : result_sink_(std::move(result_sink)), progress_cb_(std::move(progress_cb)) {}
+
+    // Number of records per sink call (0 is treated as 1)
+    void set_result_batch_size(std::size_t size) noexcept { result_batch_size_ = size == 0 ? 1 : size; }
+
+    // Whether batches carry the move indices of every game (off by default)
+    void set_record_histories(bool enabled) noexcept { record_histories_ = enabled; }
+
+    /**
+     * @brief Sets the number of worker threads; 1 (the default) traverses on the calling thread.
+     *
+     * With more than one thread the tree is split into subtree tasks down to the split depth and
+     * the tasks are run on a work-stealing pool. Results are buffered and handed to the sink per
+     * worker; Statistics are gathered per thread and merged at the end.
+     */
+    void set_threads(std::size_t threads) noexcept { threads_ = threads == 0 ? 1 : threads; }
+
+    /**
+     * @brief Sets the depth (in plies below the root) down to which nodes become separate tasks.
+     */
+    void set_split_depth(std::size_t depth) noexcept { split_depth_ = depth; }
+
+    /**
+     * @brief Enables subtree caching with a table of the given size (MiB), shared by all threads.
+     *
+     * Cached subtrees are merged into the statistics without being enumerated again, so the result
+     * sink only receives the games that were actually played out.
+     */
+    void set_transposition_table(TranspositionMode mode, std::size_t size_mb = 64);
+
+    /**
+     * @brief Cuts off subtrees already stored in a position database (not owned, may be null).
+     *
+     * Consulted before the transposition table at the same nodes (see TranspositionMode::EXACT).
+     * The database must outlive the traversals that use it.
+     */
+    void set_position_database(const PositionDatabase* database) noexcept { database_ = database; }
+
+    /**
+     * @brief Ends every line at the first position covered by a tablebase (not owned, may be null).
+     *
+     * The line counts as one game with the tablebase outcome under best play, at the length reached
+     * so far; lines that end on their own before that are recorded as usual. The tablebase must
+     * outlive the traversals that use it.
+     */
+    void set_tablebase(const Tablebase* tablebase) noexcept { tablebase_ = tablebase; }
+
+    /**
+     * @brief Saves the DFS frontier to a file every interval and once more when the traversal stops.
+     *
+     * A traversal stopped by its timeout can then be continued with resume_for(), in this process or
+     * another one. Only the single-threaded traversal keeps an explicit frontier; traverse_for() and
+     * resume_for() throw std::invalid_argument when checkpoints are combined with more than one thread.
+     * A periodic save that fails does not stop the traversal: it is counted in checkpoint_failures()
+     * and retried at the next interval. The final save throws std::runtime_error when it fails.
+     */
+    void set_checkpoint(std::string path, std::chrono::milliseconds interval = DEFAULT_CHECKPOINT_INTERVAL);
+
+    /**
+     * @brief Ends every line `depth` plies below the root (nullopt, the default, for no limit).
+     *
+     * A position at the horizon that still has moves counts as a horizon leaf, not as a game; games
+     * that end at or above the horizon are recorded as usual. Cached subtrees are whole subtrees, so
+     * a depth limit cannot be combined with the transposition table, a position database or a
+     * subtree sink: traverse_for() and resume_for() throw std::invalid_argument.
+     */
+    void set_max_depth(std::optional<std::size_t> depth) noexcept { max_depth_ = depth; }
+
+    /**
+     * @brief Stops after entering `nodes` positions (nullopt, the default, for no limit).
+     *
+     * Like a timeout that does not depend on the machine: the traversal stops with its frontier
+     * open and completed() is false. The serial traversal enters the first `nodes` positions in
+     * depth-first order, so its results are reproducible. Parallel workers claim the budget in
+     * chunks, so exactly `nodes` positions are entered but which ones depends on scheduling.
+     */
+    void set_max_nodes(std::optional<std::uint64_t> nodes) noexcept { max_nodes_ = nodes; }
+
+    /**
+     * @brief Breaks the games down by length, by move-index prefix of up to `prefix_depth` plies and
+     *        by depth (nullopt, the default, for no breakdown; see TraversalBreakdown).
+     *
+     * Every thread tallies into its own fixed-size breakdown and merges it into the traversal's every
+     * TraversalBreakdown::MERGE_INTERVAL games and at the end, so memory does not grow with the number
+     * of games and breakdown() can be read while the traversal runs. Only games that are played out
+     * can be broken down, so traverse_for() and resume_for() throw std::invalid_argument when a
+     * breakdown is combined with the transposition table or a position database. A resumed traversal
+     * breaks down the games played after the checkpoint.
+     */
+    void set_breakdown(std::optional<std::size_t> prefix_depth) noexcept { breakdown_depth_ = prefix_depth; }
+
+    // A finished subtree whose statistics depend on its position alone
+    struct SubtreeResult {
+        const Board& board;
+        PieceColor player;       // side to move at the subtree root
+        const Statistics& stats; // lengths relative to the subtree root
+        std::size_t worker;
+    };
+
+    /**
+     * @brief Receives every fully enumerated subtree that is safe to reuse, e.g. to build a PositionDatabase.
+     *
+     * Subtrees cut short by the timeout are never reported. In parallel mode the sink is called
+     * concurrently from the worker threads.
+     */
+    void set_subtree_sink(std::function<void(const SubtreeResult&)> sink) { subtree_sink_ = std::move(sink); }
+
+    [[nodiscard]] const Statistics& statistics() const noexcept { return stats_; }
+
+    // Whether the last traversal enumerated the whole tree (false if the deadline stopped it)
+    [[nodiscard]] bool completed() const noexcept { return completed_; }
+
+    // Subtrees merged from the transposition table during the last traversal
+    [[nodiscard]] std::size_t transposition_hits() const noexcept { return tt_hits_; }
+
+    // Subtrees merged from the position database during the last traversal
+    [[nodiscard]] std::size_t database_hits() const noexcept { return db_hits_; }
+
+    // Lines ended by the tablebase during the last traversal
+    [[nodiscard]] std::size_t tablebase_hits() const noexcept { return tb_hits_; }
+
+    // Periodic checkpoint saves that failed during the last traversal, and the error of the last one
+    [[nodiscard]] std::size_t checkpoint_failures() const noexcept { return checkpoint_failures_; }
+    [[nodiscard]] const std::string& checkpoint_error() const noexcept { return checkpoint_error_; }
+
+    // Positions at the depth limit that still had moves, during the last traversal
+    [[nodiscard]] std::uint64_t horizon_leaves() const noexcept { return horizon_leaves_; }
+
+    // Breakdown merged so far (empty unless set_breakdown was given a depth); safe to call from the
+    // progress callback while the traversal runs
+    [[nodiscard]] TraversalBreakdown breakdown() const {
+        const std::lock_guard lock(breakdown_mutex_);
+        return breakdown_;
+    }
+
+    // Nodes, branching and depths of the last traversal (subtrees merged from a cache are not entered)
+    [[nodiscard]] const NodeCounters& node_counters() const noexcept { return node_counters_; }
+
+    // Hot-path counters of the last traversal's threads; all zero unless built with instrumentation
+    [[nodiscard]] const instrumentation::Counters& instrumentation_counters() const noexcept {
+        return instrumentation_;
+    }
 
   private:
-    // Counter for completed games (single-threaded)
-    std::size_t game_count{0};
+    // Open node of the depth-first search: children below `next` are done
+    struct Frame {
+        std::uint8_t next;
+        std::uint8_t count;
+        bool cacheable; // entered by an irreversible move (see TranspositionMode::EXACT)
+        bool mirrored;  // keyed by the mirrored board; its table entry has the winners swapped
+        zobrist::Key key;
+        Statistics subtree; // finished games below, relative to the node; only kept when caching
+    };
+
+    // Nodes between two looks at the checkpoint clock
+    static constexpr std::size_t CHECKPOINT_CHECK_INTERVAL = 4096;
+
+    // Nodes a parallel worker takes from the node limit at once
+    static constexpr std::uint64_t NODE_BUDGET_CHUNK = 1024;
+
+    // Games between two instrumentation snapshots for the parallel progress report
+    static constexpr std::size_t INSTRUMENTATION_PUBLISH_INTERVAL = 1024;
+
+    // Per-thread traversal state; the published counters are only written by its owner
+    struct alignas(64) Worker {
+        Statistics stats;
+        NodeCounters counters;
+        std::atomic<std::size_t> published_games{0};
+        std::atomic<std::uint64_t> published_nodes{0};
+        std::atomic<std::uint64_t> published_inner_nodes{0};
+        std::atomic<std::uint64_t> published_children{0};
+        // The thread's instrumentation counters when the worker started, and its counts since then
+        instrumentation::Counters instrumentation_start;
+        std::mutex instrumentation_mutex;
+        instrumentation::Counters instrumentation;
+        std::size_t instrumentation_games{0}; // games at the last snapshot
+        std::size_t tt_hits{0};
+        std::size_t db_hits{0};
+        std::size_t tb_hits{0};
+        std::uint64_t horizon_leaves{0};
+        std::uint64_t node_budget{0}; // nodes claimed from the node limit and not entered yet
+        bool out_of_nodes{false};     // the node limit stopped this worker
+        bool cut_short{false};        // the deadline or node limit left one of its parallel tasks unfinished
+        std::size_t id{0};
+        std::vector<ResultRecord> records;
+        std::vector<std::uint8_t> histories;
+        std::vector<Frame> stack;
+        std::chrono::steady_clock::time_point last_progress_time;
+        // The thread's tallies since its last merge into breakdown_ (unset without a breakdown)
+        std::optional<TraversalBreakdown> breakdown;
+    };
+
+    std::size_t threads_{1};
+    std::size_t split_depth_{6};
+    std::optional<std::size_t> max_depth_;
+    std::optional<std::uint64_t> max_nodes_;
+    // Node limit not yet claimed by any worker
+    std::atomic<std::uint64_t> nodes_left_{0};
+    std::size_t result_batch_size_{DEFAULT_RESULT_BATCH_SIZE};
+    bool record_histories_{false};
+
+    // Merged statistics of the last traversal
+    Statistics stats_;
+    std::size_t tt_hits_{0};
+    std::size_t db_hits_{0};
+    std::size_t tb_hits_{0};
+    std::uint64_t horizon_leaves_{0};
+    NodeCounters node_counters_;
+    instrumentation::Counters instrumentation_;
+    bool completed_{false};
+    std::chrono::steady_clock::time_point start_time_;
+
+    // Root of the current traversal, for checkpoints
+    Board root_board_;
+    PieceColor root_player_{PieceColor::WHITE};
+    std::size_t root_length_{0};
+
+    std::optional<std::string> checkpoint_path_;
+    std::chrono::milliseconds checkpoint_interval_{DEFAULT_CHECKPOINT_INTERVAL};
+    std::chrono::steady_clock::time_point last_checkpoint_time_;
+    std::size_t checkpoint_failures_{0};
+    std::string checkpoint_error_;
+
+    std::optional<std::size_t> breakdown_depth_;
+    mutable std::mutex breakdown_mutex_;
+    TraversalBreakdown breakdown_;
+
+    // Subtree cache; null when TranspositionMode::OFF
+    std::unique_ptr<TranspositionTable> tt_;
+    bool canonical_keys_{false};
+    const PositionDatabase* database_{nullptr};
+    const Tablebase* tablebase_{nullptr};
+    std::function<void(const SubtreeResult&)> subtree_sink_;
 
     // Timeout deadline
     std::optional<std::chrono::steady_clock::time_point> deadline_;
+    // First exception thrown on a parallel worker (by the result sink, say); it stops the other workers
+    // and is rethrown on the calling thread once they have joined
+    std::atomic<bool> failed_{false};
+    std::mutex failure_mutex_;
+    std::exception_ptr failure_;
 
-    // Last time progress was emitted
-    std::chrono::steady_clock::time_point last_progress_time_;
+    // Any caching or cutoff in use: nodes are probed and subtree statistics kept
+    [[nodiscard]] bool caching() const noexcept { return tt_ || database_ || tablebase_ || subtree_sink_; }
 
-    // Depth-aware traversal to limit task creation overhead
-    void traverse_impl(Game& game, std::size_t depth = 0);
+    // Enumerates the subtree of the game's node, or continues the frontier on the stack; stops at the
+    // deadline with the frontier left on the stack and the game back at the subtree root. Returns
+    // whether the subtree was finished (false if the deadline or the node limit cut it short)
+    bool traverse_subtree(Game& game, Worker& worker, std::vector<Frame>& stack);
+    // Sets the frame's transposition key (and mirrored flag) for the game's node
+    void key_frame(const Game& game, Frame& frame) const noexcept;
+    // Pushes a frame for a node with children to explore, or returns false with the node's result
+    bool enter_node(Game& game, Worker& worker, std::vector<Frame>& stack, Statistics& finished);
+    void finish_node(const Game& game, Worker& worker, const Frame& frame);
+    void run(Game& game, std::optional<std::chrono::milliseconds> timeout, const Checkpoint* resume);
+    [[nodiscard]] Checkpoint make_checkpoint(const Worker& worker, const std::vector<Frame>& stack) const;
+    void save_checkpoint_if_needed(Worker& worker, const std::vector<Frame>& stack);
+    void restore(Game& game, Worker& worker, const Checkpoint& checkpoint);
+    void traverse_parallel(Game& game);
+    std::optional<PieceColor> record_result(const Game& game, Worker& worker);
+    void record_outcome(const Game& game, Worker& worker, std::optional<PieceColor> outcome, bool looping);
+    // Records the tablebase outcome if the position is covered
+    std::optional<std::optional<PieceColor>> probe_tablebase(const Game& game, Worker& worker);
+    void prepare_results(Worker& worker, std::size_t id) const;
+    // Adds the worker's breakdown tallies to breakdown_ and starts them afresh
+    void merge_breakdown(Worker& worker);
+    void flush_results(Worker& worker);
+    [[nodiscard]] bool timed_out() const noexcept;
+    // Takes one node from the node limit; false (and the worker stops) once the limit is used up
+    bool claim_node(Worker& worker);
+    // Whether the worker must stop: deadline passed or its share of the node limit used up
+    [[nodiscard]] bool stopped(const Worker& worker) const noexcept {
+        return worker.out_of_nodes || failed_.load(std::memory_order_relaxed) || timed_out();
+    }
+    // Counts a position entered at the game's depth below the root
+    void count_node(const Game& game, Worker& worker) const;
+    void count_inner_node(Worker& worker, std::size_t move_count) const;
+    // Makes the worker's counters visible to the progress report
+    void publish(Worker& worker) const;
+    // Copies the calling thread's instrumentation counts since the worker started into the worker
+    void snapshot_instrumentation(Worker& worker) const;
+    [[nodiscard]] ProgressEvent progress_of(std::span<Worker> workers) const;
 
     // Helper to emit progress every 2 seconds
-    void emit_progress_if_needed();
+    void emit_progress_if_needed(Worker& worker);
 
     // Subscribers
-    const std::function<void(const ResultEvent&)> result_cb_;
+    const std::function<void(const ResultBatch&)> result_sink_;
     const std::function<void(const ProgressEvent&)> progress_cb_;
 };
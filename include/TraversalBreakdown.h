@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Game.h"
+#include "Piece.h"
+#include "TraversalStatistics.h"
+#include "Zobrist.h"
+
+/**
+ * @brief Fixed-size tallies of a traversal broken down by game length, by opening and by depth.
+ *
+ * Three breakdowns, all allocated when the breakdown is built and never resized, so the memory is
+ * the same after a thousand games or a trillion:
+ * - games by length and outcome, lengths above MAX_LENGTH sharing the last bucket;
+ * - TraversalStatistics and a log-spaced length histogram per move-index prefix of up to
+ *   `prefix_depth` plies below the root (a line that ends sooner keeps its shorter prefix). The
+ *   prefixes are enumerated once from the root into a flat tree, so a game finds its prefix with one
+ *   array lookup per ply;
+ * - an estimate of the distinct positions entered at each depth below SKETCH_DEPTHS, from one
+ *   HyperLogLog sketch of SKETCH_REGISTERS registers per depth (about 3% standard error).
+ *
+ * Traversal gives every thread its own breakdown over the same prefix tree and merges it into the
+ * shared one every MERGE_INTERVAL games, so no counter is written by two threads.
+ */
+class TraversalBreakdown {
+  public:
+    // Dame shuffles run to thousands of plies before a repetition ends them
+    static constexpr std::size_t MAX_LENGTH = 4096;
+    static constexpr std::size_t SKETCH_DEPTHS = 64;
+    static constexpr std::size_t SKETCH_BITS = 10;
+    static constexpr std::size_t SKETCH_REGISTERS = std::size_t{1} << SKETCH_BITS;
+    // Prefix trees larger than this are refused (each prefix takes about 160 bytes per thread)
+    static constexpr std::size_t MAX_PREFIXES = std::size_t{1} << 20;
+    static constexpr std::uint64_t MERGE_INTERVAL = std::uint64_t{1} << 16;
+
+    enum class Outcome : std::uint8_t { BLACK_WIN, WHITE_WIN, DRAW };
+    static constexpr std::size_t OUTCOMES = 3;
+
+    // Per-prefix lengths are bucketed by bit width: bucket 0 holds length 0, bucket b the lengths
+    // 2^(b-1) .. 2^b - 1, and the last bucket MAX_LENGTH plies or more
+    static constexpr std::size_t LENGTH_BUCKETS = std::bit_width(MAX_LENGTH) + 1;
+    using LengthHistogram = std::array<std::uint64_t, LENGTH_BUCKETS>;
+
+    [[nodiscard]] static constexpr std::size_t length_bucket(std::size_t length) noexcept {
+        return static_cast<std::size_t>(std::bit_width(std::min(length, MAX_LENGTH)));
+    }
+
+    // Shortest length counted in the bucket
+    [[nodiscard]] static constexpr std::size_t bucket_min_length(std::size_t bucket) noexcept {
+        return bucket == 0 ? 0 : std::size_t{1} << (bucket - 1);
+    }
+
+    // A prefix that no line extends within the prefix depth, with the games below it
+    struct Prefix {
+        std::vector<std::uint8_t> moves; // move indices from the root
+        TraversalStatistics stats;
+        LengthHistogram lengths; // games by length_bucket()
+    };
+
+    TraversalBreakdown() = default;
+
+    /**
+     * @brief Builds an empty breakdown over the prefixes of the game's node.
+     * @throws std::invalid_argument if there are more than MAX_PREFIXES prefixes.
+     */
+    TraversalBreakdown(const Game& root, std::size_t prefix_depth);
+
+    // Zeroed tallies over the same prefix tree, e.g. for another thread
+    [[nodiscard]] TraversalBreakdown empty_copy() const;
+
+    /**
+     * @brief Counts one finished game.
+     * @param moves Move indices below the root (at least the first prefix_depth() of them).
+     * @param length Plies of the whole game, as in TraversalStatistics.
+     */
+    void record_game(std::span<const std::uint8_t> moves, std::optional<PieceColor> winner,
+                     std::size_t length) noexcept {
+        if (!tree_) return;
+        ++games_;
+        const auto outcome = !winner ? Outcome::DRAW
+                                     : (*winner == PieceColor::BLACK ? Outcome::BLACK_WIN : Outcome::WHITE_WIN);
+        ++lengths_[std::min(length, MAX_LENGTH)][static_cast<std::size_t>(outcome)];
+
+        std::size_t node = 0;
+        for (std::size_t ply = 0; ply < prefix_depth_ && ply < moves.size(); ++ply) {
+            if (tree_->child_count[node] == 0) break;
+            node = tree_->first_child[node] + moves[ply];
+        }
+        prefix_stats_[node].record(winner, length);
+        ++prefix_lengths_[node][length_bucket(length)];
+    }
+
+    // Counts a position entered `depth` plies below the root in that depth's sketch
+    void record_position(std::size_t depth, zobrist::Key key) noexcept {
+        if (depth >= SKETCH_DEPTHS) return;
+        // Zobrist keys are already uniform; the multiply only spreads the low bits into the register index
+        const auto hash = key * 0x9E3779B97F4A7C15ull;
+        auto& reg = registers_[depth * SKETCH_REGISTERS + (hash >> (64 - SKETCH_BITS))];
+        const auto rank = static_cast<std::uint8_t>(std::countl_zero((hash << SKETCH_BITS) | 1u) + 1);
+        if (rank > reg) reg = rank;
+    }
+
+    // Adds the tallies of a breakdown built over the same prefix tree
+    void merge(const TraversalBreakdown& other) noexcept;
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t prefix_depth() const noexcept { return prefix_depth_; }
+    [[nodiscard]] std::uint64_t games() const noexcept { return games_; }
+
+    // Games of `length` plies (MAX_LENGTH: that many or more) with the outcome
+    [[nodiscard]] std::uint64_t games(std::size_t length, Outcome outcome) const noexcept {
+        return lengths_.empty() ? 0
+                                : lengths_[std::min(length, MAX_LENGTH)][static_cast<std::size_t>(outcome)];
+    }
+
+    // Every prefix with its games, in move-index order
+    [[nodiscard]] std::vector<Prefix> prefixes() const;
+
+    // Estimated number of distinct positions entered at the depth (0 past SKETCH_DEPTHS)
+    [[nodiscard]] double distinct_positions(std::size_t depth) const noexcept;
+
+    // Bytes of counters held, fixed when the breakdown is built
+    [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
+  private:
+    // Node i's children are nodes first_child[i] .. first_child[i] + child_count[i] - 1, in move order
+    struct PrefixTree {
+        std::vector<std::uint32_t> first_child;
+        std::vector<std::uint8_t> child_count;
+    };
+
+    std::shared_ptr<const PrefixTree> tree_;
+    std::size_t prefix_depth_{0};
+    std::uint64_t games_{0};
+    std::vector<std::array<std::uint64_t, OUTCOMES>> lengths_;
+    // Indexed by prefix tree node; only nodes without children ever count games
+    std::vector<TraversalStatistics> prefix_stats_;
+    std::vector<LengthHistogram> prefix_lengths_;
+    std::vector<std::uint8_t> registers_;
+};
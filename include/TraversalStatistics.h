@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "Piece.h"
+
+// Aggregated outcome of every finished game of a traversal (or of one subtree)
+struct TraversalStatistics {
+    std::size_t games{0};
+    std::size_t black_wins{0};
+    std::size_t white_wins{0};
+    std::size_t draws{0};
+    std::size_t min_length{std::numeric_limits<std::size_t>::max()};
+    std::size_t max_length{0};
+
+    void record(std::optional<PieceColor> winner, std::size_t length) noexcept {
+        ++games;
+        if (!winner) ++draws;
+        else if (*winner == PieceColor::BLACK) ++black_wins;
+        else ++white_wins;
+        min_length = std::min(min_length, length);
+        max_length = std::max(max_length, length);
+    }
+
+    // length_offset is added to the other side's lengths (e.g. the ply of the subtree root)
+    void merge(const TraversalStatistics& other, std::size_t length_offset = 0) noexcept {
+        if (other.games == 0) return;
+        games += other.games;
+        black_wins += other.black_wins;
+        white_wins += other.white_wins;
+        draws += other.draws;
+        min_length = std::min(min_length, other.min_length + length_offset);
+        max_length = std::max(max_length, other.max_length + length_offset);
+    }
+
+    // Statistics of the mirrored position (see Board::mirrored): the same games with the winners swapped
+    [[nodiscard]] constexpr TraversalStatistics mirrored() const noexcept {
+        TraversalStatistics out = *this;
+        std::swap(out.black_wins, out.white_wins);
+        return out;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const TraversalStatistics&) const noexcept = default;
+};
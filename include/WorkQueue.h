@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "Game.h"
+#include "TraversalStatistics.h"
+
+class Traversal;
+
+/**
+ * @brief Queue of traversal work units in a directory shared by every node (e.g. over NFS).
+ *
+ * A unit is one move-index prefix below the root, so the units partition the tree: every prefix
+ * exactly `depth` plies long, plus every shorter line that ends above that depth. Each unit is a
+ * file that moves between subdirectories by atomic renames:
+ *
+ *     pending/ID  -> claimed/ID  (claim)
+ *     claimed/ID  -> pending/ID  (release, or requeue once its lease expired)
+ *     done/ID                    (result, written to a temporary file and renamed)
+ *
+ * Workers renew the lease of a claimed unit by touching its file, so a unit whose worker died or
+ * was preempted goes back to pending once its modification time is older than the lease; the nodes'
+ * clocks must agree to well within the lease. A unit finished twice (after a slow worker's lease
+ * expired) simply overwrites its result with the same statistics.
+ *
+ * The root is the start of a game (white to move, no history). The manifest records it as Board
+ * masks with the prefix depth and the unit count; unit files hold the raw move indices and result
+ * files the statistics as six 64-bit words, all in native byte order.
+ */
+class WorkQueue {
+  public:
+    struct Unit {
+        std::uint64_t id;
+        std::vector<std::uint8_t> prefix; // move indices below the root
+    };
+
+    struct Status {
+        std::size_t pending;
+        std::size_t claimed;
+        std::size_t done;
+        std::size_t total;
+
+        [[nodiscard]] bool finished() const noexcept { return done == total; }
+    };
+
+    static constexpr std::array<char, 8> MAGIC = {'T', 'C', 'W', 'Q', '\0', '\0', '\0', '\0'};
+    static constexpr std::uint32_t VERSION = 1;
+
+    /**
+     * @brief Move-index prefixes of every unit below the game's node, in selection order.
+     *
+     * The game is back at its node on return.
+     */
+    [[nodiscard]] static std::vector<std::vector<std::uint8_t>> prefixes(Game& game, std::size_t depth);
+
+    /**
+     * @brief Creates the queue with one pending unit per prefix of the game's node.
+     *
+     * An existing queue for the same root and depth is opened as is, so a restarted coordinator
+     * continues where it left off.
+     * @throws std::invalid_argument if moves were already played in the game.
+     * @throws std::runtime_error on I/O errors or if the directory holds a queue for another root or depth.
+     */
+    [[nodiscard]] static WorkQueue create(const std::string& directory, Game& game, std::size_t depth);
+
+    // @throws std::runtime_error if the directory holds no queue of this version
+    [[nodiscard]] static WorkQueue open(const std::string& directory);
+
+    // Game at the queue's root
+    [[nodiscard]] Game root() const;
+    [[nodiscard]] std::size_t depth() const noexcept { return depth_; }
+
+    // Takes a pending unit, or nullopt when none is left
+    [[nodiscard]] std::optional<Unit> claim() const;
+    // Extends the lease of a claimed unit
+    void renew(const Unit& unit) const;
+    // Hands an unfinished unit back to pending
+    void release(const Unit& unit) const;
+    // Stores the statistics of the unit's subtree (move sequence lengths counted from the root)
+    void complete(const Unit& unit, const TraversalStatistics& stats) const;
+
+    // Moves claimed units whose lease expired back to pending; returns how many
+    std::size_t requeue_expired(std::chrono::milliseconds lease) const;
+
+    [[nodiscard]] Status status() const;
+
+    /**
+     * @brief Merged statistics of every finished unit.
+     * @throws std::runtime_error if a result file is corrupt.
+     */
+    [[nodiscard]] TraversalStatistics results() const;
+
+  private:
+    struct Manifest {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t occ;
+        std::uint32_t black;
+        std::uint32_t dame;
+        std::uint32_t depth;
+        std::uint32_t reserved;
+        std::uint64_t units;
+    };
+    static_assert(sizeof(Manifest) == 40, "Manifest layout is part of the file format");
+
+    WorkQueue(std::filesystem::path directory, const Manifest& manifest);
+
+    [[nodiscard]] std::filesystem::path unit_path(const char* state, std::uint64_t id) const;
+
+    std::filesystem::path directory_;
+    Board root_;
+    std::size_t depth_{0};
+    std::size_t units_{0};
+};
+
+/**
+ * @brief Claims and traverses units until none is left or the deadline passes.
+ *
+ * The lease of the unit in progress is renewed in the background every third of `lease`. A unit cut
+ * short by the deadline is released for another worker. Returns the number of units completed.
+ */
+std::size_t work_through(const WorkQueue& queue, Traversal& traversal, std::chrono::milliseconds lease,
+                         std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
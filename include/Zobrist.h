@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Piece.h"
+#include "Position.h"
+
+/**
+ * @brief Compile-time Zobrist keys for (color, type, square) and the side to move.
+ *
+ * A position key is the XOR of the keys of every piece on the board, XOR-ed with
+ * side_to_move when black is to play; moving, capturing or promoting a piece only
+ * XORs the affected entries in and out.
+ */
+namespace zobrist {
+
+using Key = std::uint64_t;
+
+namespace detail {
+[[nodiscard]] constexpr Key splitmix64(Key& state) noexcept {
+    Key z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+struct Tables {
+    // [color][type][square]
+    std::array<std::array<std::array<Key, Position::max_positions()>, piece_type_count()>, piece_color_count()>
+        piece{};
+    Key side{};
+};
+
+[[nodiscard]] consteval Tables build_tables() {
+    Tables t{};
+    Key state = 0x7468616963686b72ull; // fixed seed: keys must be stable across builds and runs
+    for (auto& by_type : t.piece) {
+        for (auto& by_square : by_type) {
+            for (auto& key : by_square) key = splitmix64(state);
+        }
+    }
+    t.side = splitmix64(state);
+    return t;
+}
+
+inline constexpr Tables tables = build_tables();
+} // namespace detail
+
+inline constexpr Key side_to_move = detail::tables.side;
+
+[[nodiscard]] constexpr Key piece(PieceColor color, PieceType type, std::size_t square) noexcept {
+    return detail::tables.piece[to_underlying(color)][to_underlying(type)][square];
+}
+
+[[nodiscard]] constexpr Key piece(bool is_black, bool is_dame, std::size_t square) noexcept {
+    return detail::tables.piece[is_black ? 1 : 0][is_dame ? 1 : 0][square];
+}
+
+} // namespace zobrist
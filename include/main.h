@@ -1,6 +1,3 @@
 #pragma once
 
-void random_game_play();
-void random_game_play_quiet();
-
 int smoke_test(int argc, char** argv);
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Compare two benchjson files written by thai_checkers_bench and flag regressions.
+
+Usage: scripts/compare_bench.py BASELINE.json CURRENT.json [--threshold PERCENT]
+
+A benchmark regresses when its mean is more than PERCENT (default 5) slower and the
+confidence intervals of the two means do not overlap. The exit status is 1 if any did.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8") as f:
+        document = json.load(f)
+    return {(b["test_case"], b["name"]): b for b in document["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=5.0, help="slowdown in percent (default 5)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+    width = max((len(name) for _, name in current), default=10)
+    for key, new in current.items():
+        old = baseline.get(key)
+        if old is None:
+            print(f"{key[1]:<{width}}  {new['mean_ns']:>14.1f} ns  (new)")
+            continue
+        change = (new["mean_ns"] / old["mean_ns"] - 1.0) * 100.0
+        regressed = change > args.threshold and new["mean_low_ns"] > old["mean_high_ns"]
+        regressions += regressed
+        print(f"{key[1]:<{width}}  {old['mean_ns']:>14.1f} -> {new['mean_ns']:>14.1f} ns  {change:+7.1f}%"
+              + ("  REGRESSION" if regressed else ""))
+    for key in baseline.keys() - current.keys():
+        print(f"{key[1]:<{width}}  (missing from {args.current})")
+
+    print(f"{regressions} regression(s) over {args.threshold:g}%")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
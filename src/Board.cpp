@@ -1,51 +1,29 @@
 #include "Board.h"
+#include "Bitboard.h"
 #include <stdexcept>
 #include <utility>
 #include <algorithm>
 #include <ranges>
-#include <bitset>
 #include <format>
 #include <optional>
+#include <bit>
 
+// Layout: occupancy in bits 32..63, then the type (bits 0..15) and color (bits 16..31) of the first
+// 16 occupied squares
 Board Board::from_hash(std::size_t hash) {
     Board board;
-
-    std::bitset<64> bits(hash);
-    // Occupancy in bits 32..63
     board.occ_bits_ = static_cast<std::uint32_t>(hash >> 32);
-
-    // Reconstruct dame_bits_ and black_bits_ from first 16 occupied squares' metadata
-    board.dame_bits_ = 0;
-    board.black_bits_ = 0;
-    int count = 0;
-    for (int i = 0; i < 32 && count < 16; ++i) {
-        const auto m = static_cast<std::uint32_t>(1u) << i;
-        if ((board.occ_bits_ & m) == 0u) continue;
-
-        // Dame info is in bits[count], black info is in bits[count + 16]
-        if (bits[count]) board.dame_bits_ |= m;
-        if (bits[count + 16]) board.black_bits_ |= m;
-        ++count;
-    }
-
+    const auto described = bitboard::lowest_squares(board.occ_bits_, 16);
+    board.dame_bits_ = bitboard::deposit(static_cast<std::uint32_t>(hash & 0xFFFFu), described);
+    board.black_bits_ = bitboard::deposit(static_cast<std::uint32_t>((hash >> 16) & 0xFFFFu), described);
+    board.zobrist_ = compute_zobrist(board.occ_bits_, board.black_bits_, board.dame_bits_);
     return board;
 }
 
 std::size_t Board::hash() const noexcept {
-    // Compose a 64-bit hash: top 32 bits are occupancy layout, lower bits summarize first up-to-16 pieces' color/type.
-    std::bitset<64> bits;
-    // Occupancy in bits 32..63
-    for (int i = 0; i < 32; ++i) { bits[i + 32] = ((occ_bits_ >> i) & 1u) != 0u; }
-    // Encode first 16 occupied squares' metadata (type in 0..15, color in 16..31)
-    int count = 0;
-    for (int i = 0; i < 32 && count < 16; ++i) {
-        const auto m = static_cast<std::uint32_t>(1u) << i;
-        if ((occ_bits_ & m) == 0u) continue;
-        bits[count] = ((dame_bits_ & m) != 0u);
-        bits[count + 16] = ((black_bits_ & m) != 0u);
-        ++count;
-    }
-    return bits.to_ullong();
+    const auto described = bitboard::lowest_squares(occ_bits_, 16);
+    return std::size_t{occ_bits_} << 32 | std::size_t{bitboard::extract(black_bits_, described)} << 16 |
+           bitboard::extract(dame_bits_, described);
 }
 
 Board Board::setup() noexcept {
@@ -76,6 +54,24 @@ Board Board::setup() noexcept {
             board.dame_bits_ &= ~m;
         }
     }
+    board.zobrist_ = compute_zobrist(board.occ_bits_, board.black_bits_, board.dame_bits_);
+    return board;
+}
+
+zobrist::Key Board::compute_zobrist(std::uint32_t occ, std::uint32_t black, std::uint32_t dame) noexcept {
+    zobrist::Key key = 0;
+    for (auto rest = occ; rest != 0u; rest &= rest - 1) {
+        const auto idx = static_cast<std::size_t>(std::countr_zero(rest));
+        const auto m = bit(idx);
+        key ^= zobrist::piece((black & m) != 0u, (dame & m) != 0u, idx);
+    }
+    return key;
+}
+
+Board Board::mirrored() const noexcept {
+    Board board;
+    board.set_from_masks(bitboard::rotated(occ_bits_), bitboard::rotated(occ_bits_ & ~black_bits_),
+                         bitboard::rotated(dame_bits_ & occ_bits_));
     return board;
 }
 
@@ -102,7 +98,10 @@ void Board::promote_piece(const Position& pos) noexcept {
     const auto idx = static_cast<unsigned>(pos.hash());
     const auto m = static_cast<std::uint32_t>(1u) << idx;
     if ((occ_bits_ & m) == 0u) return;
+    if ((dame_bits_ & m) != 0u) return;
+    zobrist_ ^= piece_key(m, idx);
     dame_bits_ |= m;
+    zobrist_ ^= piece_key(m, idx);
 }
 
 void Board::move_piece(const Position& from, const Position& to) noexcept {
@@ -115,6 +114,7 @@ void Board::move_piece(const Position& from, const Position& to) noexcept {
     if ((occ_bits_ & tm) != 0u) return;
     const bool was_black = (black_bits_ & fm) != 0u;
     const bool was_dame = (dame_bits_ & fm) != 0u;
+    zobrist_ ^= zobrist::piece(was_black, was_dame, fi) ^ zobrist::piece(was_black, was_dame, ti);
     // Clear from
     occ_bits_ &= ~fm;
     black_bits_ &= ~fm;
@@ -131,11 +131,34 @@ void Board::remove_piece(const Position& pos) noexcept {
     if (!is_valid_position(pos)) return;
     const auto idx = static_cast<unsigned>(pos.hash());
     const auto m = static_cast<std::uint32_t>(1u) << idx;
+    if ((occ_bits_ & m) != 0u) zobrist_ ^= piece_key(m, idx);
     occ_bits_ &= ~m;
     black_bits_ &= ~m;
     dame_bits_ &= ~m;
 }
 
+BoardDelta Board::move_delta(const Move& move) const noexcept {
+    const auto fm = bit(move.from.hash());
+    const auto tm = bit(move.to.hash());
+    // A dame may finish a capture sequence on its starting square, where from ^ to cancels out
+    const auto path = fm ^ tm;
+    const bool was_black = (black_bits_ & fm) != 0u;
+    const bool was_dame = (dame_bits_ & fm) != 0u;
+    const bool promotes = !was_dame && (move.to.y() == 0 || move.to.y() == Position::board_size - 1);
+
+    BoardDelta delta;
+    delta.occ = path ^ move.captured;
+    delta.black = (was_black ? path : 0u) ^ (black_bits_ & move.captured);
+    delta.dame = (was_dame ? path : (promotes ? tm : 0u)) ^ (dame_bits_ & move.captured);
+    delta.key = zobrist::piece(was_black, was_dame, move.from.hash()) ^
+                zobrist::piece(was_black, was_dame || promotes, move.to.hash());
+    for (auto captured = move.captured; captured != 0u; captured &= captured - 1) {
+        const auto idx = static_cast<std::size_t>(std::countr_zero(captured));
+        delta.key ^= piece_key(bit(idx), idx);
+    }
+    return delta;
+}
+
 Pieces Board::get_pieces(PieceColor color) const noexcept {
     Pieces out;
     out.reserve(12);
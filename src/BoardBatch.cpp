@@ -0,0 +1,411 @@
+#include "BoardBatch.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "Bitboard.h"
+#include "Explorer.h"
+#include "Search.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define THAI_CHECKERS_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define THAI_CHECKERS_X86_KERNELS 0
+#endif
+
+void BoardBatch::reserve(std::size_t n) {
+    occ_.reserve(n);
+    black_.reserve(n);
+    dame_.reserve(n);
+    black_to_move_.reserve(n);
+}
+
+void BoardBatch::clear() noexcept {
+    occ_.clear();
+    black_.clear();
+    dame_.clear();
+    black_to_move_.clear();
+}
+
+void BoardBatch::push_back(const Board& board, PieceColor side) {
+    const auto occ = board.occ_bits();
+    occ_.push_back(occ);
+    black_.push_back(occ & board.black_bits());
+    dame_.push_back(occ & board.dame_bits());
+    black_to_move_.push_back(side == PieceColor::BLACK ? 1u : 0u);
+}
+
+Board BoardBatch::board(std::size_t i) const noexcept {
+    Board board;
+    board.set_from_masks(occ_[i], black_[i], dame_[i]);
+    return board;
+}
+
+namespace batch {
+namespace {
+using bitboard::Mask;
+
+// Advancement of evaluate_material without a loop over rows: the row of square i is i / 4, so the
+// rows whose bit 0, 1 or 2 is set are these masks, and a pion's row is the sum of its set bits.
+constexpr Mask ADVANCING_ROWS = 0x0FFFFFF0; // rows 1..6; pions on the back rows score nothing
+constexpr Mask ROW_BIT_0 = 0xF0F0F0F0;
+constexpr Mask ROW_BIT_1 = 0xFF00FF00;
+constexpr Mask ROW_BIT_2 = 0xFFFF0000;
+
+constexpr std::size_t NW = bitboard::index(AnalyzerDirection::NW);
+constexpr std::size_t NE = bitboard::index(AnalyzerDirection::NE);
+constexpr std::size_t SW = bitboard::index(AnalyzerDirection::SW);
+constexpr std::size_t SE = bitboard::index(AnalyzerDirection::SE);
+
+void require_output(std::size_t inputs, std::span<std::int32_t> out) {
+    if (out.size() < inputs) throw std::invalid_argument("The batch output holds fewer values than its input");
+}
+
+// ---- Scalar kernels: these define the results, and finish the tail of the vector kernels ----
+
+[[nodiscard]] std::int32_t row_sum(Mask m) noexcept {
+    return std::popcount(m & ROW_BIT_0) + 2 * std::popcount(m & ROW_BIT_1) + 4 * std::popcount(m & ROW_BIT_2);
+}
+
+[[nodiscard]] std::int32_t evaluate_one(Mask occ, Mask black, Mask dame, Mask black_to_move) noexcept {
+    const auto white = occ & ~black;
+    const auto black_pions = black & ~dame;
+    const auto white_pions = white & ~dame;
+    const auto material = Search::PION_VALUE * (std::popcount(black_pions) - std::popcount(white_pions)) +
+                          Search::DAME_VALUE * (std::popcount(black & dame) - std::popcount(white & dame));
+    // Black pions advance by their row, white ones by 7 - row
+    const auto black_advance = black_pions & ADVANCING_ROWS;
+    const auto white_advance = white_pions & ADVANCING_ROWS;
+    const auto advance = row_sum(black_advance) - (7 * std::popcount(white_advance) - row_sum(white_advance));
+    const auto balance = material + Search::ADVANCE_VALUE * advance;
+    return black_to_move != 0u ? balance : -balance;
+}
+
+[[nodiscard]] std::int32_t mobility_one(Mask occ, Mask black, Mask dame, Mask black_to_move) noexcept {
+    using bitboard::shift;
+    const auto own = black_to_move != 0u ? black : occ & ~black;
+    const auto pions = own & ~dame;
+    const auto dames = own & dame;
+    const auto empty = ~occ;
+    std::int32_t count = 0;
+    const auto color = black_to_move != 0u ? PieceColor::BLACK : PieceColor::WHITE;
+    for (const auto dir : bitboard::forward_directions(color)) count += std::popcount(shift(pions, dir) & empty);
+    for (const auto dir : bitboard::all_directions) count += std::popcount(shift(dames, dir) & empty);
+    return count;
+}
+
+void evaluate_scalar(const BoardBatch& boards, std::span<std::int32_t> out, std::size_t first) noexcept {
+    const auto occ = boards.occ();
+    const auto black = boards.black();
+    const auto dame = boards.dame();
+    const auto side = boards.black_to_move();
+    for (auto i = first; i < boards.size(); ++i) out[i] = evaluate_one(occ[i], black[i], dame[i], side[i]);
+}
+
+void mobility_scalar(const BoardBatch& boards, std::span<std::int32_t> out, std::size_t first) noexcept {
+    const auto occ = boards.occ();
+    const auto black = boards.black();
+    const auto dame = boards.dame();
+    const auto side = boards.black_to_move();
+    for (auto i = first; i < boards.size(); ++i) out[i] = mobility_one(occ[i], black[i], dame[i], side[i]);
+}
+
+void popcount_scalar(std::span<const std::uint32_t> masks, std::span<std::int32_t> out, std::size_t first) noexcept {
+    for (auto i = first; i < masks.size(); ++i) out[i] = std::popcount(masks[i]);
+}
+
+#if THAI_CHECKERS_X86_KERNELS
+
+// ---- AVX2: 8 positions per register ----
+
+#define AVX2_INLINE [[gnu::target("avx2"), gnu::always_inline]] inline
+
+AVX2_INLINE __m256i load8(const std::uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+AVX2_INLINE void store8(std::int32_t* p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+AVX2_INLINE __m256i splat8(Mask m) { return _mm256_set1_epi32(static_cast<int>(m)); }
+
+// Nibble lookup per byte, then the four byte counts of each lane summed by two multiply-adds
+AVX2_INLINE __m256i popcount8(__m256i v) {
+    const auto lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, //
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const auto nibble = _mm256_set1_epi8(0x0F);
+    const auto low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, nibble));
+    const auto high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    const auto bytes = _mm256_add_epi8(low, high);
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+}
+
+// bitboard::shift with the table's shift amounts as immediates
+template <std::size_t D, std::size_t K> AVX2_INLINE __m256i shift_part8(__m256i m) {
+    constexpr int amount = bitboard::tables.shift_amount[D][K];
+    const auto src = _mm256_and_si256(m, splat8(bitboard::tables.shift_from[D][K]));
+    if constexpr (amount >= 0) return _mm256_slli_epi32(src, amount);
+    else return _mm256_srli_epi32(src, -amount);
+}
+template <std::size_t D> AVX2_INLINE __m256i shift8(__m256i m) {
+    return _mm256_or_si256(shift_part8<D, 0>(m), shift_part8<D, 1>(m));
+}
+
+AVX2_INLINE __m256i row_sum8(__m256i m) {
+    const auto bit0 = popcount8(_mm256_and_si256(m, splat8(ROW_BIT_0)));
+    const auto bit1 = popcount8(_mm256_and_si256(m, splat8(ROW_BIT_1)));
+    const auto bit2 = popcount8(_mm256_and_si256(m, splat8(ROW_BIT_2)));
+    return _mm256_add_epi32(bit0, _mm256_add_epi32(_mm256_slli_epi32(bit1, 1), _mm256_slli_epi32(bit2, 2)));
+}
+
+[[gnu::target("avx2")]] void evaluate_avx2(const BoardBatch& boards, std::span<std::int32_t> out) noexcept {
+    const auto n = boards.size() / 8 * 8;
+    const auto advancing = splat8(ADVANCING_ROWS);
+    for (std::size_t i = 0; i < n; i += 8) {
+        const auto occ = load8(boards.occ().data() + i);
+        const auto black = load8(boards.black().data() + i);
+        const auto dame = load8(boards.dame().data() + i);
+        const auto white = _mm256_andnot_si256(black, occ);
+        const auto black_pions = _mm256_andnot_si256(dame, black);
+        const auto white_pions = _mm256_andnot_si256(dame, white);
+        const auto pions = _mm256_sub_epi32(popcount8(black_pions), popcount8(white_pions));
+        const auto dames =
+            _mm256_sub_epi32(popcount8(_mm256_and_si256(black, dame)), popcount8(_mm256_and_si256(white, dame)));
+
+        const auto black_advance = _mm256_and_si256(black_pions, advancing);
+        const auto white_advance = _mm256_and_si256(white_pions, advancing);
+        const auto white_rows = _mm256_sub_epi32(_mm256_mullo_epi32(popcount8(white_advance), _mm256_set1_epi32(7)),
+                                                 row_sum8(white_advance));
+        const auto advance = _mm256_sub_epi32(row_sum8(black_advance), white_rows);
+
+        const auto balance = _mm256_add_epi32(
+            _mm256_add_epi32(_mm256_mullo_epi32(pions, _mm256_set1_epi32(Search::PION_VALUE)),
+                             _mm256_mullo_epi32(dames, _mm256_set1_epi32(Search::DAME_VALUE))),
+            _mm256_mullo_epi32(advance, _mm256_set1_epi32(Search::ADVANCE_VALUE)));
+        // All ones where white is to move: (x ^ -1) - -1 == -x
+        const auto negate = _mm256_sub_epi32(load8(boards.black_to_move().data() + i), _mm256_set1_epi32(1));
+        store8(out.data() + i, _mm256_sub_epi32(_mm256_xor_si256(balance, negate), negate));
+    }
+    evaluate_scalar(boards, out, n);
+}
+
+[[gnu::target("avx2")]] void mobility_avx2(const BoardBatch& boards, std::span<std::int32_t> out) noexcept {
+    const auto n = boards.size() / 8 * 8;
+    for (std::size_t i = 0; i < n; i += 8) {
+        const auto occ = load8(boards.occ().data() + i);
+        const auto black = load8(boards.black().data() + i);
+        const auto dame = load8(boards.dame().data() + i);
+        // All ones where black is to move
+        const auto black_side = _mm256_sub_epi32(_mm256_setzero_si256(), load8(boards.black_to_move().data() + i));
+        const auto own = _mm256_or_si256(_mm256_and_si256(black, black_side),
+                                         _mm256_andnot_si256(black_side, _mm256_andnot_si256(black, occ)));
+        const auto pions = _mm256_andnot_si256(dame, own);
+        const auto dames = _mm256_and_si256(own, dame);
+        const auto black_pions = _mm256_and_si256(pions, black_side);
+        const auto white_pions = _mm256_andnot_si256(black_side, pions);
+        const auto empty = _mm256_xor_si256(occ, _mm256_set1_epi32(-1));
+
+        // Only one side's pions are non-zero in a lane, so its two forward steps can share a count
+        const auto left = _mm256_or_si256(shift8<SW>(black_pions), shift8<NW>(white_pions));
+        const auto right = _mm256_or_si256(shift8<SE>(black_pions), shift8<NE>(white_pions));
+        auto count = _mm256_add_epi32(popcount8(_mm256_and_si256(left, empty)),
+                                      popcount8(_mm256_and_si256(right, empty)));
+        count = _mm256_add_epi32(count, popcount8(_mm256_and_si256(shift8<NW>(dames), empty)));
+        count = _mm256_add_epi32(count, popcount8(_mm256_and_si256(shift8<NE>(dames), empty)));
+        count = _mm256_add_epi32(count, popcount8(_mm256_and_si256(shift8<SW>(dames), empty)));
+        count = _mm256_add_epi32(count, popcount8(_mm256_and_si256(shift8<SE>(dames), empty)));
+        store8(out.data() + i, count);
+    }
+    mobility_scalar(boards, out, n);
+}
+
+[[gnu::target("avx2")]] void popcount_avx2(std::span<const std::uint32_t> masks, std::span<std::int32_t> out) noexcept {
+    const auto n = masks.size() / 8 * 8;
+    for (std::size_t i = 0; i < n; i += 8) store8(out.data() + i, popcount8(load8(masks.data() + i)));
+    popcount_scalar(masks, out, n);
+}
+
+#undef AVX2_INLINE
+
+// ---- AVX-512: 16 positions per register, with a native per-lane popcount ----
+
+#define AVX512_INLINE [[gnu::target("avx512f,avx512vpopcntdq"), gnu::always_inline]] inline
+#define AVX512_KERNEL [[gnu::target("avx512f,avx512vpopcntdq")]]
+
+AVX512_INLINE __m512i load16(const std::uint32_t* p) { return _mm512_loadu_si512(p); }
+AVX512_INLINE void store16(std::int32_t* p, __m512i v) { _mm512_storeu_si512(p, v); }
+AVX512_INLINE __m512i splat16(Mask m) { return _mm512_set1_epi32(static_cast<int>(m)); }
+
+template <std::size_t D, std::size_t K> AVX512_INLINE __m512i shift_part16(__m512i m) {
+    constexpr int amount = bitboard::tables.shift_amount[D][K];
+    const auto src = _mm512_and_si512(m, splat16(bitboard::tables.shift_from[D][K]));
+    if constexpr (amount >= 0) return _mm512_slli_epi32(src, amount);
+    else return _mm512_srli_epi32(src, -amount);
+}
+template <std::size_t D> AVX512_INLINE __m512i shift16(__m512i m) {
+    return _mm512_or_si512(shift_part16<D, 0>(m), shift_part16<D, 1>(m));
+}
+
+AVX512_INLINE __m512i row_sum16(__m512i m) {
+    const auto bit0 = _mm512_popcnt_epi32(_mm512_and_si512(m, splat16(ROW_BIT_0)));
+    const auto bit1 = _mm512_popcnt_epi32(_mm512_and_si512(m, splat16(ROW_BIT_1)));
+    const auto bit2 = _mm512_popcnt_epi32(_mm512_and_si512(m, splat16(ROW_BIT_2)));
+    return _mm512_add_epi32(bit0, _mm512_add_epi32(_mm512_slli_epi32(bit1, 1), _mm512_slli_epi32(bit2, 2)));
+}
+
+AVX512_KERNEL void evaluate_avx512(const BoardBatch& boards, std::span<std::int32_t> out) noexcept {
+    const auto n = boards.size() / 16 * 16;
+    const auto advancing = splat16(ADVANCING_ROWS);
+    for (std::size_t i = 0; i < n; i += 16) {
+        const auto occ = load16(boards.occ().data() + i);
+        const auto black = load16(boards.black().data() + i);
+        const auto dame = load16(boards.dame().data() + i);
+        const auto white = _mm512_andnot_si512(black, occ);
+        const auto black_pions = _mm512_andnot_si512(dame, black);
+        const auto white_pions = _mm512_andnot_si512(dame, white);
+        const auto pions = _mm512_sub_epi32(_mm512_popcnt_epi32(black_pions), _mm512_popcnt_epi32(white_pions));
+        const auto dames = _mm512_sub_epi32(_mm512_popcnt_epi32(_mm512_and_si512(black, dame)),
+                                            _mm512_popcnt_epi32(_mm512_and_si512(white, dame)));
+
+        const auto black_advance = _mm512_and_si512(black_pions, advancing);
+        const auto white_advance = _mm512_and_si512(white_pions, advancing);
+        const auto white_rows = _mm512_sub_epi32(
+            _mm512_mullo_epi32(_mm512_popcnt_epi32(white_advance), _mm512_set1_epi32(7)), row_sum16(white_advance));
+        const auto advance = _mm512_sub_epi32(row_sum16(black_advance), white_rows);
+
+        const auto balance = _mm512_add_epi32(
+            _mm512_add_epi32(_mm512_mullo_epi32(pions, _mm512_set1_epi32(Search::PION_VALUE)),
+                             _mm512_mullo_epi32(dames, _mm512_set1_epi32(Search::DAME_VALUE))),
+            _mm512_mullo_epi32(advance, _mm512_set1_epi32(Search::ADVANCE_VALUE)));
+        const auto white_to_move = _mm512_cmpeq_epi32_mask(load16(boards.black_to_move().data() + i), _mm512_setzero_si512());
+        store16(out.data() + i, _mm512_mask_sub_epi32(balance, white_to_move, _mm512_setzero_si512(), balance));
+    }
+    evaluate_scalar(boards, out, n);
+}
+
+AVX512_KERNEL void mobility_avx512(const BoardBatch& boards, std::span<std::int32_t> out) noexcept {
+    const auto n = boards.size() / 16 * 16;
+    for (std::size_t i = 0; i < n; i += 16) {
+        const auto occ = load16(boards.occ().data() + i);
+        const auto black = load16(boards.black().data() + i);
+        const auto dame = load16(boards.dame().data() + i);
+        const auto black_side = _mm512_sub_epi32(_mm512_setzero_si512(), load16(boards.black_to_move().data() + i));
+        const auto own = _mm512_or_si512(_mm512_and_si512(black, black_side),
+                                         _mm512_andnot_si512(black_side, _mm512_andnot_si512(black, occ)));
+        const auto pions = _mm512_andnot_si512(dame, own);
+        const auto dames = _mm512_and_si512(own, dame);
+        const auto black_pions = _mm512_and_si512(pions, black_side);
+        const auto white_pions = _mm512_andnot_si512(black_side, pions);
+        const auto empty = _mm512_xor_si512(occ, _mm512_set1_epi32(-1));
+
+        const auto left = _mm512_or_si512(shift16<SW>(black_pions), shift16<NW>(white_pions));
+        const auto right = _mm512_or_si512(shift16<SE>(black_pions), shift16<NE>(white_pions));
+        auto count = _mm512_add_epi32(_mm512_popcnt_epi32(_mm512_and_si512(left, empty)),
+                                      _mm512_popcnt_epi32(_mm512_and_si512(right, empty)));
+        count = _mm512_add_epi32(count, _mm512_popcnt_epi32(_mm512_and_si512(shift16<NW>(dames), empty)));
+        count = _mm512_add_epi32(count, _mm512_popcnt_epi32(_mm512_and_si512(shift16<NE>(dames), empty)));
+        count = _mm512_add_epi32(count, _mm512_popcnt_epi32(_mm512_and_si512(shift16<SW>(dames), empty)));
+        count = _mm512_add_epi32(count, _mm512_popcnt_epi32(_mm512_and_si512(shift16<SE>(dames), empty)));
+        store16(out.data() + i, count);
+    }
+    mobility_scalar(boards, out, n);
+}
+
+AVX512_KERNEL void popcount_avx512(std::span<const std::uint32_t> masks, std::span<std::int32_t> out) noexcept {
+    const auto n = masks.size() / 16 * 16;
+    for (std::size_t i = 0; i < n; i += 16) store16(out.data() + i, _mm512_popcnt_epi32(load16(masks.data() + i)));
+    popcount_scalar(masks, out, n);
+}
+
+#undef AVX512_INLINE
+#undef AVX512_KERNEL
+
+#endif // THAI_CHECKERS_X86_KERNELS
+
+// An unsupported kernel falls back to the next narrower one
+[[nodiscard]] Kernel usable(Kernel kernel) noexcept {
+    while (kernel != Kernel::SCALAR && !supported(kernel)) kernel = static_cast<Kernel>(static_cast<int>(kernel) - 1);
+    return kernel;
+}
+} // namespace
+
+bool supported(Kernel kernel) noexcept {
+#if THAI_CHECKERS_X86_KERNELS
+    switch (kernel) {
+    case Kernel::SCALAR:
+        return true;
+    case Kernel::AVX2:
+        return __builtin_cpu_supports("avx2") != 0;
+    case Kernel::AVX512:
+        return __builtin_cpu_supports("avx512f") != 0 && __builtin_cpu_supports("avx512vpopcntdq") != 0;
+    }
+    return false;
+#else
+    return kernel == Kernel::SCALAR;
+#endif
+}
+
+Kernel best_kernel() noexcept {
+    static const Kernel best = usable(Kernel::AVX512);
+    return best;
+}
+
+void evaluate(const BoardBatch& boards, std::span<std::int32_t> out, Kernel kernel) {
+    require_output(boards.size(), out);
+    switch (usable(kernel)) {
+#if THAI_CHECKERS_X86_KERNELS
+    case Kernel::AVX512:
+        return evaluate_avx512(boards, out);
+    case Kernel::AVX2:
+        return evaluate_avx2(boards, out);
+#endif
+    default:
+        return evaluate_scalar(boards, out, 0);
+    }
+}
+
+void mobility(const BoardBatch& boards, std::span<std::int32_t> out, Kernel kernel) {
+    require_output(boards.size(), out);
+    switch (usable(kernel)) {
+#if THAI_CHECKERS_X86_KERNELS
+    case Kernel::AVX512:
+        return mobility_avx512(boards, out);
+    case Kernel::AVX2:
+        return mobility_avx2(boards, out);
+#endif
+    default:
+        return mobility_scalar(boards, out, 0);
+    }
+}
+
+void popcount(std::span<const std::uint32_t> masks, std::span<std::int32_t> out, Kernel kernel) {
+    require_output(masks.size(), out);
+    switch (usable(kernel)) {
+#if THAI_CHECKERS_X86_KERNELS
+    case Kernel::AVX512:
+        return popcount_avx512(masks, out);
+    case Kernel::AVX2:
+        return popcount_avx2(masks, out);
+#endif
+    default:
+        return popcount_scalar(masks, out, 0);
+    }
+}
+
+std::size_t generate_moves(const BoardBatch& boards, std::span<Move> moves, std::span<std::size_t> offsets,
+                           std::size_t first) {
+    if (first > boards.size() || offsets.size() < boards.size() - first + 1) {
+        throw std::invalid_argument("The batch offsets hold fewer values than its positions plus one");
+    }
+    MoveList list;
+    std::size_t used = 0;
+    offsets[0] = 0;
+    std::size_t i = first;
+    for (; i < boards.size(); ++i) {
+        ::generate_moves(boards.board(i), boards.side(i), list);
+        if (list.size() > moves.size() - used) break;
+        std::ranges::copy(list, moves.begin() + static_cast<std::ptrdiff_t>(used));
+        used += list.size();
+        offsets[i - first + 1] = used;
+    }
+    return i - first;
+}
+
+} // namespace batch
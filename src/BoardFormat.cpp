@@ -0,0 +1,331 @@
+#include "BoardFormat.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+#include "Bitboard.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define THAI_CHECKERS_X86_BMI2 1
+#include <immintrin.h>
+#else
+#define THAI_CHECKERS_X86_BMI2 0
+#endif
+
+namespace board_format {
+namespace {
+using bitboard::Mask;
+
+constexpr std::size_t ROWS = 8;
+constexpr std::size_t SQUARES_PER_ROW = 4;
+
+// What a character of a row stands for: an empty run (EMPTY | length) or a piece (PIECE | color | type)
+constexpr std::uint8_t EMPTY = 0x10;
+constexpr std::uint8_t PIECE = 0x20;
+constexpr std::uint8_t BLACK = 0x01;
+constexpr std::uint8_t DAME = 0x02;
+
+constexpr auto square_codes = [] {
+    std::array<std::uint8_t, 256> codes{};
+    for (std::uint8_t run = 1; run <= SQUARES_PER_ROW; ++run) codes['0' + run] = EMPTY | run;
+    codes['w'] = PIECE;
+    codes['b'] = PIECE | BLACK;
+    codes['W'] = PIECE | DAME;
+    codes['B'] = PIECE | BLACK | DAME;
+    return codes;
+}();
+
+constexpr std::array<char, 4> piece_chars = {'w', 'b', 'W', 'B'};
+
+// Writes the text form (without a line end) and returns its length, at most MAX_TEXT_SIZE
+std::size_t write_text(const Board& board, PieceColor side, char* out) noexcept {
+    const Mask occ = board.occ_bits();
+    const char* const begin = out;
+    for (std::size_t row = 0; row < ROWS; ++row) {
+        if (row > 0) *out++ = '/';
+        char run = 0;
+        for (std::size_t square = row * SQUARES_PER_ROW; square < (row + 1) * SQUARES_PER_ROW; ++square) {
+            if ((occ & bitboard::bit(square)) == 0u) {
+                ++run;
+                continue;
+            }
+            if (run > 0) *out++ = static_cast<char>('0' + run);
+            run = 0;
+            *out++ = piece_chars[((board.black_bits() >> square) & 1u) | ((board.dame_bits() >> square) & 1u) << 1];
+        }
+        if (run > 0) *out++ = static_cast<char>('0' + run);
+    }
+    *out++ = ' ';
+    *out++ = side == PieceColor::BLACK ? 'b' : 'w';
+    return static_cast<std::size_t>(out - begin);
+}
+
+// Parses the text form without surrounding whitespace; returns what is wrong, or nullptr
+const char* read_text(std::string_view text, Entry& entry) noexcept {
+    Mask occ = 0;
+    Mask black = 0;
+    Mask dame = 0;
+    std::size_t at = 0;
+    std::size_t square = 0;
+    for (std::size_t row = 0; row < ROWS; ++row) {
+        if (row > 0 && (at == text.size() || text[at++] != '/')) return "expected '/' between rows";
+        const auto row_end = square + SQUARES_PER_ROW;
+        while (square < row_end) {
+            if (at == text.size()) return "the board ends early";
+            const auto code = square_codes[static_cast<unsigned char>(text[at++])];
+            if ((code & EMPTY) != 0u) {
+                square += code & 0x0Fu;
+            } else if ((code & PIECE) != 0u) {
+                const auto m = bitboard::bit(square++);
+                occ |= m;
+                if ((code & BLACK) != 0u) black |= m;
+                if ((code & DAME) != 0u) dame |= m;
+            } else {
+                return "unexpected character on the board";
+            }
+        }
+        if (square != row_end) return "a row holds more than four squares";
+    }
+    if (text.size() - at != 2 || text[at] != ' ' || (text[at + 1] != 'b' && text[at + 1] != 'w')) {
+        return "expected ' b' or ' w' after the board";
+    }
+    entry.board.set_from_masks(occ, black, dame);
+    entry.side = text[at + 1] == 'b' ? PieceColor::BLACK : PieceColor::WHITE;
+    return nullptr;
+}
+
+[[nodiscard]] std::string_view trimmed(std::string_view text) noexcept {
+    constexpr std::string_view whitespace = " \t\r\n";
+    const auto first = text.find_first_not_of(whitespace);
+    if (first == std::string_view::npos) return {};
+    return text.substr(first, text.find_last_not_of(whitespace) - first + 1);
+}
+
+void require_packed_output(std::size_t entries, std::span<std::uint8_t> out) {
+    if (out.size() / PACKED_SIZE < entries) throw std::invalid_argument("The packed output holds fewer positions");
+}
+
+[[noreturn]] void too_many_pieces() {
+    throw std::invalid_argument("A packed position holds at most 31 pieces");
+}
+
+[[noreturn]] void not_packed() { throw std::invalid_argument("Bytes are not a packed position"); }
+
+// The per-square bits above the side to move: colors, then types
+[[nodiscard]] std::uint64_t packed_word(PieceColor side, Mask colors, Mask types, std::size_t pieces) noexcept {
+    return std::uint64_t{side == PieceColor::BLACK ? 1u : 0u} | std::uint64_t{colors} << 1 |
+           std::uint64_t{types} << (1 + pieces);
+}
+
+void store_packed(std::uint8_t* out, Mask occ, std::uint64_t word) noexcept {
+    std::memcpy(out, &occ, sizeof(occ));
+    std::memcpy(out + sizeof(occ), &word, sizeof(word));
+}
+
+void load_packed(const std::uint8_t* in, Mask& occ, std::uint64_t& word) noexcept {
+    std::memcpy(&occ, in, sizeof(occ));
+    std::memcpy(&word, in + sizeof(occ), sizeof(word));
+}
+
+// ---- Scalar kernels: one step per piece ----
+
+void pack_scalar(std::span<const Entry> entries, std::uint8_t* out) {
+    for (const auto& [board, side] : entries) {
+        const Mask occ = board.occ_bits();
+        const auto pieces = static_cast<std::size_t>(std::popcount(occ));
+        if (pieces == bitboard::square_count) too_many_pieces();
+        const auto colors = bitboard::extract(board.black_bits(), occ);
+        const auto types = bitboard::extract(board.dame_bits(), occ);
+        store_packed(out, occ, packed_word(side, colors, types, pieces));
+        out += PACKED_SIZE;
+    }
+}
+
+void unpack_scalar(const std::uint8_t* in, std::span<Entry> out) {
+    for (auto& entry : out) {
+        Mask occ;
+        std::uint64_t word;
+        load_packed(in, occ, word);
+        in += PACKED_SIZE;
+        const auto pieces = static_cast<unsigned>(std::popcount(occ));
+        if (pieces == bitboard::square_count || (word >> (1 + 2 * pieces)) != 0u) not_packed();
+        entry.board.set_from_masks(occ, bitboard::deposit(static_cast<Mask>(word >> 1), occ),
+                                   bitboard::deposit(static_cast<Mask>(word >> (1 + pieces)), occ));
+        entry.side = (word & 1u) != 0u ? PieceColor::BLACK : PieceColor::WHITE;
+    }
+}
+
+// ---- BMI2 kernels: the same records with one PEXT/PDEP per mask ----
+
+#if THAI_CHECKERS_X86_BMI2
+
+[[gnu::target("bmi2")]] void pack_bmi2(std::span<const Entry> entries, std::uint8_t* out) {
+    for (const auto& [board, side] : entries) {
+        const Mask occ = board.occ_bits();
+        const auto pieces = static_cast<std::size_t>(std::popcount(occ));
+        if (pieces == bitboard::square_count) too_many_pieces();
+        const auto colors = _pext_u32(board.black_bits(), occ);
+        const auto types = _pext_u32(board.dame_bits(), occ);
+        store_packed(out, occ, packed_word(side, colors, types, pieces));
+        out += PACKED_SIZE;
+    }
+}
+
+[[gnu::target("bmi2")]] void unpack_bmi2(const std::uint8_t* in, std::span<Entry> out) {
+    for (auto& entry : out) {
+        Mask occ;
+        std::uint64_t word;
+        load_packed(in, occ, word);
+        in += PACKED_SIZE;
+        const auto pieces = static_cast<unsigned>(std::popcount(occ));
+        if (pieces == bitboard::square_count || (word >> (1 + 2 * pieces)) != 0u) not_packed();
+        entry.board.set_from_masks(occ, _pdep_u32(static_cast<Mask>(word >> 1), occ),
+                                   _pdep_u32(static_cast<Mask>(word >> (1 + pieces)), occ));
+        entry.side = (word & 1u) != 0u ? PieceColor::BLACK : PieceColor::WHITE;
+    }
+}
+
+#endif // THAI_CHECKERS_X86_BMI2
+
+struct FileHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint64_t count;
+};
+static_assert(sizeof(FileHeader) == 24, "Header layout is part of the file format");
+
+// Positions packed per write
+constexpr std::size_t WRITE_CHUNK = std::size_t{1} << 16;
+} // namespace
+
+bool supported(Kernel kernel) noexcept {
+#if THAI_CHECKERS_X86_BMI2
+    return kernel == Kernel::SCALAR || __builtin_cpu_supports("bmi2") != 0;
+#else
+    return kernel == Kernel::SCALAR;
+#endif
+}
+
+Kernel best_kernel() noexcept {
+#if THAI_CHECKERS_X86_BMI2
+    // Bulldozer-family and Zen 1/2 cores run PEXT/PDEP in microcode, slower than the scalar loops
+    static const Kernel best = supported(Kernel::BMI2) && __builtin_cpu_is("amdfam15h") == 0 &&
+                                       __builtin_cpu_is("amdfam17h") == 0
+                                   ? Kernel::BMI2
+                                   : Kernel::SCALAR;
+    return best;
+#else
+    return Kernel::SCALAR;
+#endif
+}
+
+std::string to_text(const Board& board, PieceColor side) {
+    std::array<char, MAX_TEXT_SIZE> buffer{};
+    return std::string(buffer.data(), write_text(board, side, buffer.data()));
+}
+
+Entry from_text(std::string_view text) {
+    Entry entry;
+    if (const char* error = read_text(trimmed(text), entry)) {
+        throw std::invalid_argument("Invalid position '" + std::string(text) + "': " + error);
+    }
+    return entry;
+}
+
+void append_text(std::span<const Entry> entries, std::string& out) {
+    // Written in place into the worst-case size, then cut back
+    auto size = out.size();
+    out.resize(size + entries.size() * (MAX_TEXT_SIZE + 1));
+    for (const auto& [board, side] : entries) {
+        size += write_text(board, side, out.data() + size);
+        out[size++] = '\n';
+    }
+    out.resize(size);
+}
+
+void parse_text(std::string_view text, std::vector<Entry>& out) {
+    std::size_t line_number = 0;
+    while (!text.empty()) {
+        ++line_number;
+        const auto end = std::min(text.find('\n'), text.size());
+        const auto line = trimmed(text.substr(0, end));
+        text.remove_prefix(std::min(end + 1, text.size()));
+        if (line.empty()) continue;
+        if (const char* error = read_text(line, out.emplace_back())) {
+            out.pop_back();
+            throw std::invalid_argument("Line " + std::to_string(line_number) + " is not a position: " + error);
+        }
+    }
+}
+
+void pack(std::span<const Entry> entries, std::span<std::uint8_t> out, Kernel kernel) {
+    require_packed_output(entries.size(), out);
+#if THAI_CHECKERS_X86_BMI2
+    if (kernel == Kernel::BMI2 && supported(kernel)) return pack_bmi2(entries, out.data());
+#endif
+    pack_scalar(entries, out.data());
+}
+
+void unpack(std::span<const std::uint8_t> in, std::span<Entry> out, Kernel kernel) {
+    if (in.size() % PACKED_SIZE != 0) throw std::invalid_argument("Packed positions are 12 bytes each");
+    const auto entries = out.first(std::min(out.size(), in.size() / PACKED_SIZE));
+    if (entries.size() < in.size() / PACKED_SIZE) {
+        throw std::invalid_argument("The position output holds fewer positions than its input");
+    }
+#if THAI_CHECKERS_X86_BMI2
+    if (kernel == Kernel::BMI2 && supported(kernel)) return unpack_bmi2(in.data(), entries);
+#endif
+    unpack_scalar(in.data(), entries);
+}
+
+void write_packed(const std::string& path, std::span<const Entry> entries) {
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot create position file '" + path + "'");
+    const FileHeader header{.magic = MAGIC, .version = VERSION, .record_size = PACKED_SIZE, .count = entries.size()};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+
+    std::vector<std::uint8_t> buffer(std::min(entries.size(), WRITE_CHUNK) * PACKED_SIZE);
+    for (std::size_t first = 0; ok && first < entries.size(); first += WRITE_CHUNK) {
+        const auto chunk = entries.subspan(first, std::min(WRITE_CHUNK, entries.size() - first));
+        pack(chunk, buffer);
+        ok = std::fwrite(buffer.data(), PACKED_SIZE, chunk.size(), file.get()) == chunk.size();
+    }
+    if (!ok || std::fflush(file.get()) != 0) throw std::runtime_error("Cannot write position file '" + path + "'");
+}
+
+std::vector<Entry> read_packed(const std::string& path) {
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot open position file '" + path + "'");
+    FileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1 || header.magic != MAGIC ||
+        header.version != VERSION || header.record_size != PACKED_SIZE) {
+        throw std::runtime_error("'" + path + "' is not a version " + std::to_string(VERSION) + " position file");
+    }
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error || (size - sizeof(header)) / PACKED_SIZE != header.count ||
+        (size - sizeof(header)) % PACKED_SIZE != 0) {
+        throw std::runtime_error("Position file '" + path + "' does not hold its " + std::to_string(header.count) +
+                                 " positions");
+    }
+
+    std::vector<std::uint8_t> bytes(header.count * PACKED_SIZE);
+    if (std::fread(bytes.data(), 1, bytes.size(), file.get()) != bytes.size()) {
+        throw std::runtime_error("Cannot read position file '" + path + "'");
+    }
+    std::vector<Entry> entries(header.count);
+    try {
+        unpack(bytes, entries);
+    } catch (const std::invalid_argument&) {
+        throw std::runtime_error("Position file '" + path + "' is corrupt");
+    }
+    return entries;
+}
+
+} // namespace board_format
@@ -0,0 +1,158 @@
+#include "Checkpoint.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace {
+struct Header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t occ;
+    std::uint32_t black;
+    std::uint32_t dame;
+    std::uint8_t side;
+    std::uint8_t has_subtrees;
+    std::array<std::uint8_t, 6> padding;
+    std::uint64_t root_length;
+    std::uint64_t depth;          // entries of `next`
+    std::uint64_t horizon_leaves;
+    std::uint64_t max_depth; // NO_DEPTH_LIMIT without one
+};
+static_assert(sizeof(Header) == 64, "Header layout is part of the file format");
+
+constexpr std::uint64_t NO_DEPTH_LIMIT = ~std::uint64_t{0};
+
+// Statistics as fixed-width words: games, black wins, white wins, draws, min length, max length
+using StatisticsWords = std::array<std::uint64_t, 6>;
+
+[[nodiscard]] StatisticsWords words_of(const TraversalStatistics& s) noexcept {
+    return {s.games, s.black_wins, s.white_wins, s.draws, s.min_length, s.max_length};
+}
+
+[[nodiscard]] TraversalStatistics statistics_of(const StatisticsWords& w) noexcept {
+    return TraversalStatistics{.games = w[0],
+                               .black_wins = w[1],
+                               .white_wins = w[2],
+                               .draws = w[3],
+                               .min_length = static_cast<std::size_t>(w[4]),
+                               .max_length = static_cast<std::size_t>(w[5])};
+}
+
+using File = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+template <typename T> bool write_all(std::FILE* file, const T* data, std::size_t count) {
+    return count == 0 || std::fwrite(data, sizeof(T), count, file) == count;
+}
+
+template <typename T> bool read_all(std::FILE* file, T* data, std::size_t count) {
+    return count == 0 || std::fread(data, sizeof(T), count, file) == count;
+}
+} // namespace
+
+bool Checkpoint::matches(const Board& board, PieceColor player, std::size_t length) const noexcept {
+    const auto board_occ = board.occ_bits();
+    return occ == board_occ && black == (board.black_bits() & board_occ) && dame == (board.dame_bits() & board_occ) &&
+           side == player && root_length == length;
+}
+
+void Checkpoint::save(const std::string& filename) const {
+    const Header header{
+        .magic = MAGIC,
+        .version = VERSION,
+        .occ = occ,
+        .black = black,
+        .dame = dame,
+        .side = to_underlying(side),
+        .has_subtrees = static_cast<std::uint8_t>(subtrees.empty() ? 0 : 1),
+        .padding = {},
+        .root_length = root_length,
+        .depth = next.size(),
+        .horizon_leaves = horizon_leaves,
+        .max_depth = max_depth.value_or(NO_DEPTH_LIMIT),
+    };
+    const std::array<std::uint64_t, 3> hits = {transposition_hits, database_hits, tablebase_hits};
+    const auto totals = words_of(stats);
+    std::vector<StatisticsWords> open(subtrees.size());
+    for (std::size_t i = 0; i < subtrees.size(); ++i) open[i] = words_of(subtrees[i]);
+
+    const auto temporary = filename + ".tmp";
+    {
+        const File file(std::fopen(temporary.c_str(), "wb"), &std::fclose);
+        if (!file) throw std::runtime_error("Cannot create checkpoint '" + temporary + "'");
+        const bool ok = write_all(file.get(), &header, 1) && write_all(file.get(), &totals, 1) &&
+                        write_all(file.get(), hits.data(), hits.size()) &&
+                        write_all(file.get(), path.data(), path.size()) &&
+                        write_all(file.get(), next.data(), next.size()) &&
+                        write_all(file.get(), open.data(), open.size());
+        // On disk before the rename, so a crash cannot leave the new name on an unwritten file
+        if (!ok || std::fflush(file.get()) != 0 || ::fsync(::fileno(file.get())) != 0) {
+            throw std::runtime_error("Cannot write checkpoint '" + temporary + "'");
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, filename, error);
+    if (error) throw std::runtime_error("Cannot replace checkpoint '" + filename + "': " + error.message());
+}
+
+Checkpoint Checkpoint::load(const std::string& filename) {
+    const File file(std::fopen(filename.c_str(), "rb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot open checkpoint '" + filename + "'");
+
+    Header header{};
+    if (!read_all(file.get(), &header, 1) || header.magic != MAGIC || header.version != VERSION ||
+        header.side > to_underlying(PieceColor::BLACK)) {
+        throw std::runtime_error("'" + filename + "' is not a version " + std::to_string(VERSION) + " checkpoint");
+    }
+
+    Checkpoint checkpoint;
+    checkpoint.occ = header.occ;
+    checkpoint.black = header.black;
+    checkpoint.dame = header.dame;
+    checkpoint.side = static_cast<PieceColor>(header.side);
+    checkpoint.root_length = header.root_length;
+    checkpoint.horizon_leaves = header.horizon_leaves;
+    if (header.max_depth != NO_DEPTH_LIMIT) checkpoint.max_depth = header.max_depth;
+
+    // The header is untrusted: check the frontier it announces against the file before allocating it
+    std::error_code error;
+    const auto size = std::filesystem::file_size(filename, error);
+    const auto fixed = sizeof(Header) + sizeof(StatisticsWords) + 3 * sizeof(std::uint64_t);
+    if (error || size < fixed || header.depth > size - fixed) {
+        throw std::runtime_error("Checkpoint '" + filename + "' is truncated");
+    }
+    const auto depth = static_cast<std::size_t>(header.depth);
+    // `path` and `next` take a byte per entry, every open subtree a StatisticsWords
+    const auto frontier =
+        (depth == 0 ? 0 : 2 * depth - 1) + (header.has_subtrees != 0 ? depth * sizeof(StatisticsWords) : 0);
+    if (fixed + frontier != size) throw std::runtime_error("Checkpoint '" + filename + "' does not match its header");
+    StatisticsWords totals{};
+    std::array<std::uint64_t, 3> hits{};
+    checkpoint.path.resize(depth == 0 ? 0 : depth - 1);
+    checkpoint.next.resize(depth);
+    std::vector<StatisticsWords> open(header.has_subtrees != 0 ? depth : 0);
+    const bool ok = read_all(file.get(), &totals, 1) && read_all(file.get(), hits.data(), hits.size()) &&
+                    read_all(file.get(), checkpoint.path.data(), checkpoint.path.size()) &&
+                    read_all(file.get(), checkpoint.next.data(), checkpoint.next.size()) &&
+                    read_all(file.get(), open.data(), open.size());
+    if (!ok) throw std::runtime_error("Checkpoint '" + filename + "' is truncated");
+
+    // Every open node above the deepest one is exploring the child on the path
+    for (std::size_t i = 0; i < checkpoint.path.size(); ++i) {
+        if (checkpoint.next[i] != checkpoint.path[i] + 1) {
+            throw std::runtime_error("Checkpoint '" + filename + "' has an inconsistent frontier");
+        }
+    }
+
+    checkpoint.stats = statistics_of(totals);
+    checkpoint.transposition_hits = hits[0];
+    checkpoint.database_hits = hits[1];
+    checkpoint.tablebase_hits = hits[2];
+    checkpoint.subtrees.reserve(open.size());
+    for (const auto& words : open) checkpoint.subtrees.push_back(statistics_of(words));
+    return checkpoint;
+}
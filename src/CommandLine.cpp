@@ -0,0 +1,37 @@
+#include "CommandLine.h"
+#include <exception>
+#include <string>
+
+std::optional<std::size_t> parse_count(std::string_view arg) {
+    if (arg.empty()) return std::nullopt;
+    try {
+        std::size_t consumed = 0;
+        const auto value = std::stoull(std::string(arg), &consumed);
+        if (consumed != arg.size()) return std::nullopt;
+        return static_cast<std::size_t>(value);
+    } catch (const std::exception&) { return std::nullopt; }
+}
+
+std::optional<std::chrono::milliseconds> parse_timeout(std::string_view arg) {
+    if (arg.empty()) return std::nullopt;
+
+    try {
+        // Check for 'ms' suffix (milliseconds) FIRST - before checking 's'
+        if (arg.ends_with("ms")) {
+            const auto ms_str = arg.substr(0, arg.length() - 2);
+            const long long ms = std::stoll(std::string(ms_str));
+            return std::chrono::milliseconds(ms);
+        }
+
+        // Check for 's' suffix (seconds)
+        if (arg.ends_with('s')) {
+            const auto seconds_str = arg.substr(0, arg.length() - 1);
+            const double seconds = std::stod(std::string(seconds_str));
+            return std::chrono::milliseconds(static_cast<long long>(seconds * 1000));
+        }
+
+        // Default to seconds if no suffix
+        const double seconds = std::stod(std::string(arg));
+        return std::chrono::milliseconds(static_cast<long long>(seconds * 1000));
+    } catch (const std::exception&) { return std::nullopt; }
+}
@@ -1,4 +1,5 @@
 #include "Explorer.h"
+#include "Instrumentation.h"
 #include <stdexcept>
 #include <array>
 #include <algorithm>
@@ -6,218 +7,338 @@
 #include <concepts>
 #include <span>
 #include <utility>
+#include <bit>
+
+template <PieceType Type>
+constexpr std::optional<AnalyzerCaptureMove> Explorer::find_capture_in_direction(std::uint32_t occ,
+                                                                                 std::uint32_t opponent,
+                                                                                 std::size_t square,
+                                                                                 AnalyzerDirection dir) noexcept {
+    // Dame: nearest piece along the diagonal; Pion: the adjacent square only
+    std::uint8_t target = bitboard::no_square;
+    if constexpr (Type == PieceType::DAME) {
+        const auto blockers = bitboard::ray(dir, square) & occ;
+        if (blockers == 0u) [[likely]] { return std::nullopt; }
+        target = bitboard::first_blocker(dir, blockers);
+    } else {
+        target = bitboard::neighbor(dir, square);
+        if (target == bitboard::no_square) [[unlikely]] { return std::nullopt; }
+        if ((occ & bitboard::bit(target)) == 0u) [[likely]] { return std::nullopt; }
+    }
 
-// Static member definition
-constexpr std::array<AnalyzerDirectionDelta, 4> Explorer::dir_deltas;
-
-const std::vector<AnalyzerDirectionDelta>& Explorer::get_valid_directions(const Board& board,
-                                                                          const Position& pos) noexcept {
-    const bool is_dame = board.is_dame_piece(pos);
-    const bool is_black = board.is_black_piece(pos);
-
-    // Use designated initializers for clarity and C++20 features
-    static const auto all = std::vector<AnalyzerDirectionDelta>{
-        {.row = -1, .col = -1}, // NW
-        {.row = -1, .col = 1},  // NE
-        {.row = 1, .col = -1},  // SW
-        {.row = 1, .col = 1}    // SE
-    };
-    static const auto down_moves = std::vector<AnalyzerDirectionDelta>{
-        {.row = 1, .col = -1}, // SW
-        {.row = 1, .col = 1}   // SE
-    };
-    static const auto up_moves = std::vector<AnalyzerDirectionDelta>{
-        {.row = -1, .col = -1}, // NW
-        {.row = -1, .col = 1}   // NE
-    };
+    // Found a piece - it must belong to the opponent
+    if ((opponent & bitboard::bit(target)) == 0u) [[unlikely]] { return std::nullopt; }
 
-    if (is_dame) [[likely]] { return all; }
+    // The landing square immediately beyond it must be on the board and empty
+    const auto landing = bitboard::neighbor(dir, target);
+    if (landing == bitboard::no_square) [[unlikely]] { return std::nullopt; }
+    if ((occ & bitboard::bit(landing)) != 0u) [[unlikely]] { return std::nullopt; }
 
-    return is_black ? down_moves : up_moves;
+    return AnalyzerCaptureMove{.captured_piece = Position{target}, .landing_position = Position{landing}};
 }
 
-std::optional<AnalyzerCaptureMove> Explorer::find_capture_in_direction(const Board& board, const Position& pos,
-                                                                       const AnalyzerDirectionDelta& delta,
-                                                                       bool is_dame) noexcept {
-
-    const bool player_is_black = board.is_black_piece(pos);
+template <typename F> decltype(auto) Explorer::dispatch_piece(const Board& board, std::size_t square, F&& f) {
+    const auto m = bitboard::bit(square);
+    const bool is_black = (board.black_bits() & m) != 0u;
+    const bool is_dame = (board.dame_bits() & m) != 0u;
+    if (is_black) {
+        return is_dame ? f.template operator()<PieceColor::BLACK, PieceType::DAME>()
+                       : f.template operator()<PieceColor::BLACK, PieceType::PION>();
+    }
+    return is_dame ? f.template operator()<PieceColor::WHITE, PieceType::DAME>()
+                   : f.template operator()<PieceColor::WHITE, PieceType::PION>();
+}
 
-    if (is_dame) [[likely]] {
-        // Dame logic: search along the direction for an opponent piece to capture
-        for (const auto step : std::views::iota(1u, 8u)) { // C++20 ranges view
-            const auto [current_col, current_row] =
-                std::pair{pos.x() + delta.col * static_cast<int>(step), pos.y() + delta.row * static_cast<int>(step)};
+std::uint64_t Explorer::CapturePath::order_key() const noexcept {
+    // 6 bits per captured square (index + 1), first capture in the top bits; a shorter prefix sorts first
+    std::uint64_t key = 0;
+    const auto n = std::min<std::size_t>(length, 10);
+    for (std::size_t i = 0; i < n; ++i) { key |= static_cast<std::uint64_t>(captured[i] + 1u) << (58 - 6 * i); }
+    return key;
+}
 
-            if (!Position::is_valid(current_col, current_row)) [[unlikely]] {
-                break; // Reached board boundary
+template <PieceColor Color, PieceType Type, typename Sink>
+void Explorer::find_capture_sequences(const Board& board, std::size_t from, Sink&& sink) {
+    constexpr auto& directions = bitboard::piece_directions<Color, Type>;
+
+    // The moving piece is never a blocker: rays start beyond it and it may land on its own origin
+    const auto occ = board.occ_bits() & ~bitboard::bit(from);
+    const auto opponent =
+        Color == PieceColor::BLACK ? board.occ_bits() & ~board.black_bits() : board.occ_bits() & board.black_bits();
+
+    // Frame i holds the jumps available to the piece after i jumps, in direction order
+    struct Frame {
+        std::array<std::uint8_t, bitboard::direction_count> captured;
+        std::array<std::uint8_t, bitboard::direction_count> landing;
+        std::uint8_t count;
+        std::uint8_t next;
+    };
+    auto expand = [&](Frame& frame, std::size_t square, std::uint32_t captured) {
+        frame.count = 0;
+        frame.next = 0;
+        for (const auto dir : directions) {
+            if (const auto capture =
+                    find_capture_in_direction<Type>(occ & ~captured, opponent & ~captured, square, dir)) {
+                frame.captured[frame.count] = static_cast<std::uint8_t>(capture->captured_piece.hash());
+                frame.landing[frame.count] = static_cast<std::uint8_t>(capture->landing_position.hash());
+                ++frame.count;
             }
+        }
+    };
 
-            const Position current_pos(current_col, current_row);
+    std::array<Frame, bitboard::square_count + 1> stack;
+    CapturePath path;
+    std::uint32_t captured = 0;
+    expand(stack[0], from, captured);
+
+    // path.length is the depth of the frame being explored
+    while (true) {
+        auto& frame = stack[path.length];
+        if (frame.next == frame.count) {
+            if (path.length == 0) return;
+
+            // Back to the previous jump: the captured piece returns to the board
+            --path.length;
+            captured &= ~bitboard::bit(path.captured[path.length]);
+            continue;
+        }
 
-            if (!board.is_occupied(current_pos)) [[likely]] {
-                continue; // Empty square, keep searching
-            }
+        const auto target = frame.captured[frame.next];
+        const auto landing = frame.landing[frame.next];
+        ++frame.next;
+        path.captured[path.length] = target;
+        path.landing[path.length] = landing;
+        captured |= bitboard::bit(target);
+        ++path.length;
+        instrumentation::count(instrumentation::Counter::CAPTURE_SEARCH_NODES);
+
+        auto& child = stack[path.length];
+        expand(child, landing, captured);
+        if (child.count == 0) {
+            // No further jump: the sequence is complete
+            instrumentation::capture_depth(path.length);
+            sink(landing, captured, path);
+            --path.length;
+            captured &= ~bitboard::bit(target);
+        }
+    }
+}
 
-            // Found a piece - check if it's an opponent piece
-            const bool is_opponent = board.is_black_piece(current_pos) != player_is_black;
-            if (!is_opponent) [[unlikely]] {
-                break; // Friendly piece blocks the path
-            }
+Legals Explorer::find_valid_moves(const Position& from) const {
+    // Check for captures first - they are mandatory in Thai Checkers.
+    // Equivalent sequences (same landing square and captured set) are kept once, first found first.
+    std::array<std::pair<std::uint8_t, std::uint32_t>, MoveList::capacity> seen{};
+    std::size_t seen_count = 0;
+    CaptureSequences capture_sequences;
+    auto collect = [&](std::size_t final_square, std::uint32_t captured_mask, const CapturePath& path) {
+        const auto key = std::pair{static_cast<std::uint8_t>(final_square), captured_mask};
+        const auto known = std::span{seen}.first(seen_count);
+        if (std::ranges::find(known, key) != known.end()) {
+            instrumentation::count(instrumentation::Counter::DEDUP_COLLISIONS);
+            return;
+        }
+        if (seen_count < seen.size()) seen[seen_count++] = key;
+        CaptureSequence sequence;
+        sequence.reserve(path.length * 2);
+        for (std::size_t i = 0; i < path.length; ++i) {
+            sequence.emplace_back(path.captured[i]);
+            sequence.emplace_back(path.landing[i]);
+        }
+        capture_sequences.insert(std::move(sequence));
+    };
+    dispatch_piece(board, from.hash(), [&]<PieceColor Color, PieceType Type>() {
+        find_capture_sequences<Color, Type>(board, from.hash(), collect);
+    });
 
-            // Found opponent piece - check if we can land beyond it
-            const auto [landing_col, landing_row] = std::pair{current_col + delta.col, current_row + delta.row};
+    if (!capture_sequences.empty()) { return Legals(capture_sequences); }
 
-            if (Position::is_valid(landing_col, landing_row)) [[likely]] {
-                const Position landing_pos(landing_col, landing_row);
-                if (!board.is_occupied(landing_pos)) [[likely]] {
-                    return AnalyzerCaptureMove{.captured_piece = current_pos, .landing_position = landing_pos};
-                }
+    // No captures available, find regular moves
+    return Legals(find_regular_moves(from));
+}
+
+template <PieceColor Color, PieceType Type> void Explorer::append_captures(std::size_t from, MoveList& out) const {
+    const auto first = out.size();
+    std::array<std::uint64_t, MoveList::capacity> order{};
+
+    // Keep the first sequence found for each (landing, captured set); equivalent orders are the same move
+    auto collect = [&](std::size_t final_square, std::uint32_t captured_mask, const CapturePath& path) {
+        const auto to = Position{static_cast<std::uint8_t>(final_square)};
+        for (std::size_t i = first; i < out.size(); ++i) {
+            if (out[i].to == to && out[i].captured == captured_mask) {
+                instrumentation::count(instrumentation::Counter::DEDUP_COLLISIONS);
+                return;
             }
-            break; // Can't capture (landing square occupied or invalid)
         }
-    } else {
-        // Pion logic: check the adjacent square in the given direction
-        const auto [adjacent_col, adjacent_row] = std::pair{pos.x() + delta.col, pos.y() + delta.row};
-
-        if (!Position::is_valid(adjacent_col, adjacent_row)) [[unlikely]] {
-            return std::nullopt; // Can't capture outside board
+        order[out.size() - first] = path.order_key();
+        out.push_back(Move{.from = Position{static_cast<std::uint8_t>(from)}, .to = to, .captured = captured_mask});
+    };
+    find_capture_sequences<Color, Type>(board, from, collect);
+
+    // Insertion sort by (landing square, captured sequence); lists per piece are tiny
+    for (std::size_t i = first + 1; i < out.size(); ++i) {
+        const auto move = out[i];
+        const auto key = order[i - first];
+        std::size_t j = i;
+        for (; j > first; --j) {
+            const auto& prev = out[j - 1];
+            const auto prev_key = order[j - 1 - first];
+            if (prev.to < move.to || (prev.to == move.to && prev_key <= key)) break;
+            out[j] = prev;
+            order[j - first] = prev_key;
         }
+        out[j] = move;
+        order[j - first] = key;
+    }
+}
 
-        const Position adjacent_pos(adjacent_col, adjacent_row);
-
-        if (!board.is_occupied(adjacent_pos)) [[likely]] {
-            return std::nullopt; // No piece to capture
-        }
+template <PieceColor Color, PieceType Type>
+void Explorer::append_regular_moves(std::size_t from, MoveList& out) const {
+    const auto occ = board.occ_bits();
 
-        // Check if it's an opponent piece
-        const bool is_opponent = board.is_black_piece(adjacent_pos) != player_is_black;
-        if (!is_opponent) [[unlikely]] {
-            return std::nullopt; // Can't capture friendly piece
+    bitboard::Mask targets = 0;
+    for (const auto dir : bitboard::piece_directions<Color, Type>) {
+        if constexpr (Type == PieceType::DAME) {
+            targets |= bitboard::slide_targets(dir, from, occ);
+        } else if (const auto next = bitboard::neighbor(dir, from); next != bitboard::no_square) {
+            targets |= bitboard::bit(next) & ~occ;
         }
+    }
 
-        // Check if we can land beyond the captured piece
-        const auto [landing_col, landing_row] = std::pair{adjacent_col + delta.col, adjacent_row + delta.row};
+    // Targets are distinct squares, so ascending bit order is the deterministic order
+    for (; targets != 0u; targets &= targets - 1) {
+        out.push_back(Move{.from = Position{static_cast<std::uint8_t>(from)},
+                           .to = Position{static_cast<std::uint8_t>(std::countr_zero(targets))},
+                           .captured = 0u});
+    }
+}
 
-        if (!Position::is_valid(landing_col, landing_row)) [[unlikely]] {
-            return std::nullopt; // Landing position is outside board
+template <PieceColor Color> void Explorer::find_side_moves(MoveList& out) const {
+    out.clear();
+    const auto side = bitboard::SideMasks::of(board, Color);
+
+    // One mask test decides whether the whole side is bound by mandatory capture
+    const auto captures = bitboard::capture_sources(side, Color);
+    if (captures != 0u) {
+        for (auto sources = captures; sources != 0u; sources &= sources - 1) {
+            const auto from = static_cast<std::size_t>(std::countr_zero(sources));
+            if ((side.own_dames & bitboard::bit(from)) != 0u) {
+                append_captures<Color, PieceType::DAME>(from, out);
+            } else {
+                append_captures<Color, PieceType::PION>(from, out);
+            }
         }
+        return;
+    }
 
-        const Position landing_pos(landing_col, landing_row);
-        if (board.is_occupied(landing_pos)) [[unlikely]] {
-            return std::nullopt; // Landing square is occupied
+    for (auto sources = bitboard::step_sources(side, Color); sources != 0u; sources &= sources - 1) {
+        const auto from = static_cast<std::size_t>(std::countr_zero(sources));
+        if ((side.own_dames & bitboard::bit(from)) != 0u) {
+            append_regular_moves<Color, PieceType::DAME>(from, out);
+        } else {
+            append_regular_moves<Color, PieceType::PION>(from, out);
         }
-
-        return AnalyzerCaptureMove{.captured_piece = adjacent_pos, .landing_position = landing_pos};
     }
-
-    return std::nullopt;
 }
 
-void Explorer::find_capture_sequences_recursive(
-    Board board, const Position& current_pos, std::uint64_t captured_mask, CaptureSequence current_sequence,
-    std::unordered_map<SequenceKey, CaptureSequence, SequenceKeyHash>& unique_sequences) const {
+template void Explorer::find_side_moves<PieceColor::WHITE>(MoveList& out) const;
+template void Explorer::find_side_moves<PieceColor::BLACK>(MoveList& out) const;
 
-    std::vector<AnalyzerCaptureMove> valid_captures;
-    valid_captures.reserve(4);
-    const auto& valid_directions = get_valid_directions(board, current_pos);
-    const bool is_dame = board.is_dame_piece(current_pos);
-
-    // Find all valid captures from current position using ranges
-    auto capture_moves = valid_directions | std::views::transform([&](const auto& delta) {
-                             return find_capture_in_direction(board, current_pos, delta, is_dame);
-                         }) |
-                         std::views::filter([](const auto& capture_opt) { return capture_opt.has_value(); }) |
-                         std::views::transform([](const auto& capture_opt) { return capture_opt.value(); });
+void Explorer::find_side_moves(PieceColor color, MoveList& out) const {
+    if (color == PieceColor::BLACK) {
+        find_side_moves<PieceColor::BLACK>(out);
+    } else {
+        find_side_moves<PieceColor::WHITE>(out);
+    }
+}
 
-    // Convert to vector for easier manipulation
-    std::ranges::copy(capture_moves, std::back_inserter(valid_captures));
+std::uint32_t Explorer::capture_sources(PieceColor color) const noexcept {
+    return bitboard::capture_sources(bitboard::SideMasks::of(board, color), color);
+}
 
-    // If no captures are available, finalize this sequence if not empty
-    if (valid_captures.empty()) [[likely]] {
-        if (!current_sequence.empty()) [[likely]] {
-            SequenceKey key{.captured_mask = captured_mask, .final_pos = current_pos};
-            unique_sequences.try_emplace(key, std::move(current_sequence));
-        }
-        return;
+template <PieceColor Color> std::size_t Explorer::count_side_moves() const {
+    const auto side = bitboard::SideMasks::of(board, Color);
+    if (bitboard::capture_sources(side, Color) != 0u) {
+        MoveList captures;
+        find_side_moves<Color>(captures);
+        return captures.size();
     }
 
-    // Try each valid capture using range-based loop
-    for (const auto& [captured_piece, landing_position] : valid_captures) {
-        // Mutate/undo model on a copied board (we still copy once per level due to value param).
-        Board new_board = board; // one copy per branch (cheap with bitboards)
-        auto new_mask = captured_mask;
-        auto new_sequence = current_sequence;
-
-        // Apply capture
-        new_board.remove_piece(captured_piece);
-        new_board.move_piece(current_pos, landing_position);
-        new_mask |= (1ull << captured_piece.hash());
-
-        // Sequence bookkeeping
-        new_sequence.emplace_back(captured_piece);
-        new_sequence.emplace_back(landing_position);
-
-        // Recurse
-        find_capture_sequences_recursive(std::move(new_board), landing_position, new_mask, std::move(new_sequence),
-                                         unique_sequences);
+    // Two pions never step onto the same square in the same direction, so each direction counts once
+    std::size_t count = 0;
+    for (const auto dir : bitboard::piece_directions<Color, PieceType::PION>) {
+        count += static_cast<std::size_t>(std::popcount(bitboard::shift(side.own_pions(), dir) & side.empty));
     }
+    for (auto dames = side.own_dames; dames != 0u; dames &= dames - 1) {
+        const auto from = static_cast<std::size_t>(std::countr_zero(dames));
+        for (const auto dir : bitboard::all_directions) {
+            count += static_cast<std::size_t>(std::popcount(bitboard::slide_targets(dir, from, ~side.empty)));
+        }
+    }
+    return count;
 }
 
-Legals Explorer::find_valid_moves(const Position& from) const {
-    // Check for captures first - they are mandatory in Thai Checkers.
-    // We'll build a map keyed by (captured set, final position) to avoid storing equivalent sequences multiple times.
-    std::unordered_map<SequenceKey, CaptureSequence, SequenceKeyHash> unique_sequences;
-    unique_sequences.reserve(64);
-    const CaptureSequence empty_sequence;
-    find_capture_sequences_recursive(board, from, 0ull, empty_sequence, unique_sequences);
+template std::size_t Explorer::count_side_moves<PieceColor::WHITE>() const;
+template std::size_t Explorer::count_side_moves<PieceColor::BLACK>() const;
 
-    CaptureSequences capture_sequences;
-    for (auto& kv : unique_sequences) { capture_sequences.insert(std::move(kv.second)); }
-
-    if (!capture_sequences.empty()) { return Legals(capture_sequences); }
-
-    // No captures available, find regular moves
-    const auto regular_positions = find_regular_moves(from);
-    return Legals(regular_positions);
+std::size_t Explorer::count_side_moves(PieceColor color) const {
+    return color == PieceColor::BLACK ? count_side_moves<PieceColor::BLACK>() : count_side_moves<PieceColor::WHITE>();
 }
 
-// Removed deduplicate_equivalent_sequences: logic integrated into recursion
+std::uint32_t Explorer::move_sources(PieceColor color) const noexcept {
+    return bitboard::step_sources(bitboard::SideMasks::of(board, color), color);
+}
 
 Positions Explorer::find_regular_moves(const Position& from) const {
-    const auto& valid_directions = get_valid_directions(board, from);
-    const bool is_dame = board.is_dame_piece(from);
-
-    Positions positions;
+    const auto square = from.hash();
+    const auto occ = board.occ_bits();
+
+    return dispatch_piece(board, square, [&]<PieceColor Color, PieceType Type>() {
+        Positions positions;
+        positions.reserve(Type == PieceType::DAME ? 13 : 2);
+
+        for (const auto dir : bitboard::piece_directions<Color, Type>) {
+            // Dame slides until blocked, Pion steps to the adjacent square only
+            bitboard::Mask targets = 0;
+            if constexpr (Type == PieceType::DAME) {
+                targets = bitboard::slide_targets(dir, square, occ);
+            } else if (const auto next = bitboard::neighbor(dir, square); next != bitboard::no_square) {
+                targets = bitboard::bit(next) & ~occ;
+            }
 
-    for (const auto& delta : valid_directions) {
-        if (is_dame) [[likely]] {
-            // Dame can move multiple squares in a direction until blocked
-            // Use ranges::iota for modern iteration
-            for (const auto step : std::views::iota(1u, 8u)) {
-                const auto [new_col, new_row] = std::pair{from.x() + delta.col * static_cast<int>(step),
-                                                          from.y() + delta.row * static_cast<int>(step)};
+            // Emit squares nearest-first along the diagonal
+            while (targets != 0u) {
+                const auto sq = bitboard::first_blocker(dir, targets);
+                positions.emplace_back(Position{sq});
+                targets &= ~bitboard::bit(sq);
+            }
+        }
 
-                if (!Position::is_valid(new_col, new_row)) [[unlikely]] {
-                    break; // Reached board boundary
-                }
+        return positions;
+    });
+}
 
-                const Position new_pos(new_col, new_row);
-                if (board.is_occupied(new_pos)) [[unlikely]] {
-                    break; // Blocked by another piece
-                }
+void generate_moves(const Board& board, PieceColor side, MoveList& out) {
+    const Explorer explorer(board);
+    if (side == PieceColor::BLACK) {
+        explorer.find_side_moves<PieceColor::BLACK>(out);
+    } else {
+        explorer.find_side_moves<PieceColor::WHITE>(out);
+    }
+}
 
-                positions.emplace_back(new_pos);
-            }
-        } else {
-            // Pion can only move one square in forward directions
-            const auto [new_col, new_row] = std::pair{from.x() + delta.col, from.y() + delta.row};
+std::size_t count_moves(const Board& board, PieceColor side) { return Explorer(board).count_side_moves(side); }
 
-            if (Position::is_valid(new_col, new_row)) [[likely]] {
-                const Position new_pos(new_col, new_row);
-                if (!board.is_occupied(new_pos)) [[likely]] { positions.emplace_back(new_pos); }
+void QuietMoves::iterator::load_targets() noexcept {
+    targets_ = 0;
+    if (sources_ == 0u) return;
+    const auto from = static_cast<std::size_t>(std::countr_zero(sources_));
+    if ((side_.own_dames & bitboard::bit(from)) != 0u) {
+        for (const auto dir : bitboard::all_directions) targets_ |= bitboard::slide_targets(dir, from, ~side_.empty);
+    } else {
+        for (const auto dir : bitboard::forward_directions(color_)) {
+            if (const auto next = bitboard::neighbor(dir, from); next != bitboard::no_square) {
+                targets_ |= bitboard::bit(next) & side_.empty;
             }
         }
     }
-
-    return positions;
 }
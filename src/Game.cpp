@@ -1,163 +1,107 @@
 #include "Game.h"
 #include "Explorer.h"
+#include "Instrumentation.h"
 #include <iostream>
 #include <format>
+#include <algorithm>
 #include <ranges>
+#include <bit>
 
 std::string piece_symbol(bool is_black, bool is_dame) {
     return is_black ? (is_dame ? "□" : "○") : (is_dame ? "■" : "●");
 }
 
 std::string board_to_string(const Board& board) {
-    return [&]() {
-        std::string str = "   ";
-        for (char col : std::views::iota('A', 'I')) { str += std::format("{} ", col); }
-        str += "\n";
-
-        for (auto i : std::views::iota(0, 8)) {
-            str += std::format(" {} ", i + 1);
-            for (auto j : std::views::iota(0, 8)) {
-                const bool is_light_square = (i + j) % 2 == 0;
-
-                const std::string symbol = [&]() -> std::string {
-                    if (is_light_square) {
-                        return ".";
-                    } else {
-                        // Only create Position for valid black squares
-                        const auto pos = Position{j, i};
-                        if (board.is_occupied(pos)) {
-                            return piece_symbol(board.is_black_piece(pos), board.is_dame_piece(pos));
-                        } else {
-                            return " ";
-                        }
-                    }
-                }();
-
-                str += std::format("{} ", symbol);
+    // Appended in place: one reserve instead of a formatted temporary per square
+    std::string str;
+    str.reserve(512);
+    str += "   ";
+    for (char col = 'A'; col <= 'H'; ++col) {
+        str += col;
+        str += ' ';
+    }
+    str += '\n';
+
+    for (int i = 0; i < 8; ++i) {
+        str += ' ';
+        str += static_cast<char>('1' + i);
+        str += ' ';
+        for (int j = 0; j < 8; ++j) {
+            if ((i + j) % 2 == 0) {
+                str += '.';
+            } else {
+                // Only create Position for valid black squares
+                const auto pos = Position{j, i};
+                if (board.is_occupied(pos)) {
+                    str += piece_symbol(board.is_black_piece(pos), board.is_dame_piece(pos));
+                } else {
+                    str += ' ';
+                }
             }
-            str += "\n";
-        }
-        return str;
-    }();
-}
-
-const std::vector<Move>& Game::get_choices() const {
-    if (!choices_dirty_) return choices_cache_;
-
-    choices_cache_.clear();
-
-    const auto moveable_pieces = get_moveable_pieces();
-
-    // Gather and sort positions for deterministic iteration order
-    std::vector<Position> from_positions;
-    from_positions.reserve(moveable_pieces.size());
-    for (const auto& kv : moveable_pieces) from_positions.push_back(kv.first);
-    std::sort(from_positions.begin(), from_positions.end(),
-              [](const Position& a, const Position& b) { return a.hash() < b.hash(); });
-
-    bool any_capture = false;
-    for (const auto& from : from_positions) {
-        const auto& legals = moveable_pieces.at(from);
-        struct TmpMove {
-            Position to;
-            std::vector<Position> captured;
-        };
-        std::vector<TmpMove> tmp;
-        tmp.reserve(legals.size());
-        for (std::size_t i = 0; i < legals.size(); ++i) {
-            const bool is_cap = legals.has_captured();
-            std::vector<Position> captured = is_cap ? legals.get_capture_pieces(i) : std::vector<Position>{};
-            any_capture = any_capture || !captured.empty();
-            tmp.push_back(TmpMove{legals.get_position(i), std::move(captured)});
+            str += ' ';
         }
-        // Sort: captures first handled later, but ensure deterministic order by (to, captured...)
-        std::sort(tmp.begin(), tmp.end(), [](const TmpMove& a, const TmpMove& b) {
-            if (a.to.hash() != b.to.hash()) return a.to.hash() < b.to.hash();
-            return a.captured < b.captured; // lexicographic on positions
-        });
-        for (auto& m : tmp) { choices_cache_.push_back(Move{from, m.to, std::move(m.captured)}); }
-    }
-
-    if (any_capture) {
-        // Keep only capture moves
-        std::vector<Move> capture_only;
-        capture_only.reserve(choices_cache_.size());
-        for (auto& m : choices_cache_)
-            if (m.is_capture()) capture_only.push_back(std::move(m));
-        choices_cache_.swap(capture_only);
+        str += '\n';
     }
-
-    choices_dirty_ = false;
-    return choices_cache_;
+    return str;
 }
 
-void Game::push_history_state() {
-    // Count the current board state with the current player
-    const auto key = get_position_key(current_board, player());
-    position_count[key]++;
+std::string move_to_string(const Move& move) {
+    return std::format("{}{}{}", move.from.to_string(), move.is_capture() ? 'x' : '-', move.to.to_string());
 }
 
-std::size_t Game::get_position_key(const Board& board, PieceColor player) const noexcept {
-    // Combine board hash with player using bit manipulation
-    // Use the board hash and set/clear the highest bit based on player color
-    std::size_t hash = board.hash();
-    if (player == PieceColor::BLACK) {
-        hash |= (std::size_t(1) << (sizeof(std::size_t) * 8 - 1)); // Set highest bit for BLACK
-    } else {
-        hash &= ~(std::size_t(1) << (sizeof(std::size_t) * 8 - 1)); // Clear highest bit for WHITE
+const MoveList& Game::get_choices() const {
+    auto& cache = choices_stack_[index_history.size()];
+    if (!cache.dirty) {
+        instrumentation::count(instrumentation::Counter::CHOICE_CACHE_HITS);
+        return cache.moves;
     }
-    return hash;
-}
+    instrumentation::count(instrumentation::Counter::MOVE_GENERATIONS);
+    const instrumentation::ScopedPhase phase(instrumentation::Phase::MOVE_GENERATION);
 
-std::unordered_map<Position, Legals> Game::get_moveable_pieces() const {
-    const auto explorer = Explorer(current_board);
-    const auto pieces = current_board.get_pieces(player());
+    // Ordered by (from, to, captured sequence) with mandatory capture already applied side-wide
+    generate_moves(current_board, player(), cache.moves);
 
-    std::unordered_map<Position, Legals> out;
-    out.reserve(pieces.size());
-    for (const auto& [pos, _info] : pieces) {
-        auto opts = explorer.find_valid_moves(pos);
-        if (!opts.empty()) { out.emplace(pos, std::move(opts)); }
-    }
-    return out;
+    cache.dirty = false;
+    return cache.moves;
 }
 
-void Game::execute_move(const Move& move) {
-    const auto& from = move.from;
-    const auto& to = move.to;
-    const auto& captured = move.captured;
-
-    // Execute the specified move
-    auto new_board = Board::copy(current_board);
-    new_board.move_piece(from, to);
-
-    // Check if the piece is promoted to a dame
-    if (to.y() == 0 || to.y() == Position::board_size - 1) { new_board.promote_piece(to); }
-
-    // Remove captured pieces
-    for (const auto& pos : captured) { new_board.remove_piece(pos); }
-
-    // Update current player and board state
-    current_board = new_board;
-
-    // Store the new board state in history
-    board_history.push_back(current_board);
+std::size_t Game::count_moves() const {
+    if (is_looping_) return 0;
+    const auto& cache = choices_stack_[index_history.size()];
+    return cache.dirty ? ::count_moves(current_board, player()) : cache.moves.size();
+}
 
-    // Push history state
+void Game::init_stacks() {
+    index_history.reserve(INITIAL_PLY_CAPACITY);
+    ply_stack_.reserve(INITIAL_PLY_CAPACITY);
+    choices_stack_.reserve(INITIAL_PLY_CAPACITY);
+    choices_stack_.emplace_back();
     push_history_state();
+}
 
-    // Check for repeated board states
-    is_looping_ = seen(current_board);
+std::uint32_t Game::push_history_state() {
+    // Count the current board state with the current player
+    return position_count.push(get_position_key(current_board, player()));
+}
 
-    // Mark cached choices dirty due to state change
-    choices_dirty_ = true;
+std::size_t Game::get_position_key(const Board& board, PieceColor player) const noexcept {
+    // Zobrist key of the pieces, with the side-to-move key folded in for BLACK
+    return board.zobrist() ^ (player == PieceColor::BLACK ? zobrist::side_to_move : zobrist::Key{0});
 }
 
-bool Game::seen(const Board& board) const noexcept {
-    const auto key = get_position_key(board, player());
-    const auto it = position_count.find(key);
-    // 3-fold repetition rule: position with same player becomes a draw if it occurs 3 times
-    return it != position_count.end() && it->second >= 3;
+void Game::execute_move(const Move& move) {
+    // Apply the move (step/jump, promotion and captures) as one XOR delta
+    const bool irreversible = move.is_capture() || (current_board.dame_bits() & (1u << move.from.hash())) == 0u;
+    const auto delta = current_board.move_delta(move);
+    current_board.apply_delta(delta);
+    ply_stack_.push_back(PlyRecord{.delta = delta, .parent_looping = is_looping_, .irreversible = irreversible});
+
+    // The child node starts with no cached choices
+    if (choices_stack_.size() <= index_history.size()) choices_stack_.emplace_back();
+    choices_stack_[index_history.size()].dirty = true;
+
+    // Count the new position; a third occurrence ends the game (3-fold repetition)
+    is_looping_ = push_history_state() >= 3;
 }
 
 void Game::undo_move() {
@@ -166,37 +110,73 @@ void Game::undo_move() {
         return;
     }
 
-    // Remove the current board state from history, but keep at least the initial state
-    if (board_history.size() > 1) {
-        // Decrease the count for the current position with current player
-        const auto key = get_position_key(current_board, player());
-        auto it = position_count.find(key);
-        if (it != position_count.end()) {
-            it->second--;
-            if (it->second == 0) { position_count.erase(it); }
-        }
+    // Decrease the count for the current position with current player
+    position_count.pop(get_position_key(current_board, player()));
+
+    // XOR the move back out; the parent's cached choices are still valid
+    const auto& record = ply_stack_.back();
+    current_board.apply_delta(record.delta);
+    is_looping_ = record.parent_looping;
+    ply_stack_.pop_back();
 
-        board_history.pop_back();
-        // Restore the previous board state
-        current_board = board_history.back();
+    // Pop the last move index from history
+    index_history.pop_back();
+}
+
+void Game::rewind(std::size_t length) {
+    while (index_history.size() > length) undo_move();
+}
+
+template <typename Visit> void Game::visit_path_keys(Visit&& visit) const {
+    // Walk back from the current board by XOR-ing out each move; White moves at even plies
+    auto board = current_board;
+    auto ply = ply_stack_.size();
+    visit(get_position_key(board, player()));
+    while (ply > 0) {
+        board.apply_delta(ply_stack_[--ply].delta);
+        visit(get_position_key(board, ply % 2 == 0 ? PieceColor::WHITE : PieceColor::BLACK));
+    }
+}
 
-        // Pop the last move index from history
-        index_history.pop_back();
+void Game::copy_from(const Game& other) {
+    if (this == &other) return;
 
-        is_looping_ = false;   // Reset loop detection
-        choices_dirty_ = true; // Mark choices as dirty to recompute
+    // Trade this path's repetition counts for the other's; a moved-from game starts a fresh table
+    if (choices_stack_.empty()) {
+        position_count = RepetitionTable{};
     } else {
-        std::cerr << "Cannot undo: already at initial state.\n";
+        visit_path_keys([this](zobrist::Key key) { position_count.pop(key); });
+    }
+    other.visit_path_keys([this](zobrist::Key key) { position_count.push(key); });
+
+    current_board = other.current_board;
+    is_looping_ = other.is_looping_;
+    index_history.assign(other.index_history.begin(), other.index_history.end());
+    ply_stack_.assign(other.ply_stack_.begin(), other.ply_stack_.end());
+
+    // Slots past the current node are marked dirty when a move reaches them
+    const auto length = index_history.size();
+    while (choices_stack_.size() <= length) choices_stack_.emplace_back();
+    for (std::size_t ply = 0; ply < length; ++ply) choices_stack_[ply].dirty = true;
+    const auto& source = other.choices_stack_[length];
+    auto& cache = choices_stack_[length];
+    cache.dirty = source.dirty;
+    if (!source.dirty) {
+        cache.moves.resize(source.moves.size());
+        std::ranges::copy(source.moves, cache.moves.begin());
     }
 }
 
 void Game::select_move(std::size_t index) {
     const auto& choices = get_choices();
 
+    // Copy the move before the child's cache slot is (re)allocated
+    const Move move = choices[index];
+
     // Store the selected move index in history
     index_history.push_back(static_cast<uint8_t>(index));
 
-    execute_move(choices[index]);
+    execute_move(move);
 }
 
 void Game::print_board() const noexcept { std::cout << board_to_string(current_board); }
@@ -205,11 +185,11 @@ void Game::print_choices() const {
     const auto& choices = get_choices();
     for (const auto& m : choices) {
         std::cout << "From: " << m.from.to_string() << " To: " << m.to.to_string();
-        if (!m.captured.empty()) {
+        if (m.is_capture()) {
             std::cout << " (Captures: ";
-            for (std::size_t i = 0; i < m.captured.size(); ++i) {
-                std::cout << m.captured[i].to_string();
-                if (i + 1 < m.captured.size()) std::cout << ", ";
+            for (auto captured = m.captured; captured != 0u; captured &= captured - 1) {
+                std::cout << Position{static_cast<std::uint8_t>(std::countr_zero(captured))}.to_string();
+                if ((captured & (captured - 1)) != 0u) std::cout << ", ";
             }
             std::cout << ")";
         }
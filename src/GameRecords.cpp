@@ -0,0 +1,293 @@
+#include "GameRecords.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// Set by CMake when libzstd is found
+#ifndef THAI_CHECKERS_HAVE_ZSTD
+#define THAI_CHECKERS_HAVE_ZSTD 0
+#endif
+#if THAI_CHECKERS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+struct Header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t records;
+    std::uint64_t reserved;
+};
+static_assert(sizeof(Header) == 32, "Header layout is part of the file format");
+
+struct BlockHeader {
+    std::uint32_t records;
+    std::uint32_t raw_bytes;    // encoded records
+    std::uint32_t stored_bytes; // bytes that follow in the file (raw_bytes unless compressed)
+    std::uint32_t worker;
+};
+static_assert(sizeof(BlockHeader) == 16, "Block header layout is part of the file format");
+
+// Outcome byte: winner in the low two bits, then the flags
+constexpr std::uint8_t WINNER_WHITE = 1;
+constexpr std::uint8_t WINNER_BLACK = 2;
+constexpr std::uint8_t WINNER_MASK = 3;
+constexpr std::uint8_t LOOPING = 4;
+constexpr std::uint8_t HAS_MOVES = 8;
+
+void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    for (; value >= 0x80; value >>= 7) out.push_back(static_cast<std::uint8_t>(value | 0x80));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Length of the common prefix, eight bytes at a time (games thousands of plies long share most of theirs)
+std::size_t shared_prefix(std::span<const std::uint8_t> a, std::span<const std::uint8_t> b) noexcept {
+    const auto n = std::min(a.size(), b.size());
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t x;
+        std::uint64_t y;
+        std::memcpy(&x, a.data() + i, 8);
+        std::memcpy(&y, b.data() + i, 8);
+        if (x != y) {
+            const auto diff = x ^ y;
+            return i + static_cast<std::size_t>(std::endian::native == std::endian::little ? std::countr_zero(diff)
+                                                                                           : std::countl_zero(diff)) /
+                           8;
+        }
+    }
+    while (i < n && a[i] == b[i]) ++i;
+    return i;
+}
+
+template <typename T> bool write_all(std::FILE* file, const T* data, std::size_t count) {
+    return count == 0 || std::fwrite(data, sizeof(T), count, file) == count;
+}
+
+template <typename T> bool read_all(std::FILE* file, T* data, std::size_t count) {
+    return count == 0 || std::fread(data, sizeof(T), count, file) == count;
+}
+} // namespace
+
+bool game_records::compression_available() noexcept { return THAI_CHECKERS_HAVE_ZSTD != 0; }
+
+GameRecordWriter::GameRecordWriter(const std::string& filename, Options options)
+    : options_(options), filename_(filename), file_(nullptr, &std::fclose) {
+    if (options_.compress && !game_records::compression_available()) {
+        throw std::invalid_argument("This build has no zstd support for compressed game records");
+    }
+    options_.block_bytes = std::clamp<std::size_t>(options_.block_bytes, 1, std::size_t{1} << 30);
+    options_.sample_every = std::max<std::size_t>(options_.sample_every, 1);
+
+    file_.reset(std::fopen(filename.c_str(), "wb"));
+    if (!file_) throw std::runtime_error("Cannot create game record file '" + filename + "'");
+    const Header header{.magic = game_records::MAGIC,
+                        .version = game_records::VERSION,
+                        .flags = options_.compress ? game_records::FLAG_ZSTD : 0u,
+                        .records = 0,
+                        .reserved = 0};
+    if (!write_all(file_.get(), &header, 1)) {
+        throw std::runtime_error("Cannot write game record file '" + filename + "'");
+    }
+    bytes_ = sizeof(Header);
+}
+
+GameRecordWriter::~GameRecordWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // Only reachable when the owner skipped close(); it had no way to see the error anyway
+    }
+}
+
+GameRecordWriter::Encoder& GameRecordWriter::encoder(std::size_t worker) {
+    const std::lock_guard lock(encoders_mutex_);
+    if (encoders_.size() <= worker) encoders_.resize(worker + 1);
+    auto& slot = encoders_[worker];
+    if (!slot) {
+        slot = std::make_unique<Encoder>();
+        slot->worker = worker;
+        slot->block.reserve(options_.block_bytes + 1024);
+    }
+    return *slot;
+}
+
+void GameRecordWriter::write(const Traversal::ResultBatch& batch) {
+    if (batch.records.empty()) return;
+    if (!file_) throw std::logic_error("Game record writer is closed");
+    auto& state = encoder(batch.worker);
+    const bool has_moves = !batch.histories.empty();
+    // Moves of the previous record: in the batch, or kept from the batch before
+    std::span<const std::uint8_t> previous = state.previous;
+
+    for (const auto& record : batch.records) {
+        if (state.seen++ % options_.sample_every != 0) continue;
+
+        std::uint8_t outcome = record.looping ? LOOPING : 0;
+        if (record.winner) outcome |= *record.winner == PieceColor::WHITE ? WINNER_WHITE : WINNER_BLACK;
+        if (has_moves) outcome |= HAS_MOVES;
+        state.block.push_back(outcome);
+        put_varint(state.block, record.length);
+        if (has_moves) {
+            // Only the moves after the prefix shared with the previous game are stored
+            const auto moves = batch.history(record);
+            const auto shared = shared_prefix(moves, previous);
+            put_varint(state.block, shared);
+            state.block.insert(state.block.end(), moves.begin() + static_cast<std::ptrdiff_t>(shared), moves.end());
+            previous = moves;
+        }
+        ++state.count;
+        if (state.block.size() >= options_.block_bytes) {
+            flush(state);
+            previous = {};
+        }
+    }
+    // The batch's buffers are reused once the sink returns
+    if (previous.data() != state.previous.data()) state.previous.assign(previous.begin(), previous.end());
+}
+
+void GameRecordWriter::flush(Encoder& state) {
+    if (state.count == 0) return;
+    BlockHeader header{.records = state.count,
+                       .raw_bytes = static_cast<std::uint32_t>(state.block.size()),
+                       .stored_bytes = static_cast<std::uint32_t>(state.block.size()),
+                       .worker = static_cast<std::uint32_t>(state.worker)};
+    const std::uint8_t* payload = state.block.data();
+
+#if THAI_CHECKERS_HAVE_ZSTD
+    // Compressed before taking the file lock, so workers only serialize on the write itself
+    if (options_.compress) {
+        state.compressed.resize(ZSTD_compressBound(state.block.size()));
+        const auto size = ZSTD_compress(state.compressed.data(), state.compressed.size(), state.block.data(),
+                                        state.block.size(), options_.compression_level);
+        if (ZSTD_isError(size) != 0u) {
+            throw std::runtime_error(std::string("Cannot compress game records: ") + ZSTD_getErrorName(size));
+        }
+        header.stored_bytes = static_cast<std::uint32_t>(size);
+        payload = state.compressed.data();
+    }
+#endif
+
+    {
+        const std::lock_guard lock(file_mutex_);
+        if (!write_all(file_.get(), &header, 1) || !write_all(file_.get(), payload, header.stored_bytes)) {
+            throw std::runtime_error("Cannot write game record file '" + filename_ + "'");
+        }
+    }
+    records_ += state.count;
+    bytes_ += sizeof(BlockHeader) + header.stored_bytes;
+
+    // The next block starts a new prefix chain
+    state.block.clear();
+    state.previous.clear();
+    state.count = 0;
+}
+
+void GameRecordWriter::close() {
+    if (!file_) return;
+    for (auto& state : encoders_) {
+        if (state) flush(*state);
+    }
+    encoders_.clear();
+
+    const Header header{.magic = game_records::MAGIC,
+                        .version = game_records::VERSION,
+                        .flags = options_.compress ? game_records::FLAG_ZSTD : 0u,
+                        .records = records_,
+                        .reserved = 0};
+    const bool ok = std::fseek(file_.get(), 0, SEEK_SET) == 0 && write_all(file_.get(), &header, 1) &&
+                    std::fflush(file_.get()) == 0;
+    // Closed either way, so a failed close() is not retried by the destructor
+    file_.reset();
+    if (!ok) throw std::runtime_error("Cannot write game record file '" + filename_ + "'");
+}
+
+GameRecordReader::GameRecordReader(const std::string& filename)
+    : filename_(filename), file_(std::fopen(filename.c_str(), "rb"), &std::fclose) {
+    if (!file_) throw std::runtime_error("Cannot open game record file '" + filename + "'");
+    Header header{};
+    if (!read_all(file_.get(), &header, 1) || header.magic != game_records::MAGIC ||
+        header.version != game_records::VERSION) {
+        throw std::runtime_error("'" + filename + "' is not a version " + std::to_string(game_records::VERSION) +
+                                 " game record file");
+    }
+    compressed_ = (header.flags & game_records::FLAG_ZSTD) != 0u;
+    if (compressed_ && !game_records::compression_available()) {
+        throw std::runtime_error("'" + filename + "' is zstd-compressed and this build has no zstd support");
+    }
+    stored_records_ = header.records;
+}
+
+bool GameRecordReader::read_block() {
+    BlockHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file_.get()) != 1) {
+        if (std::feof(file_.get()) == 0) throw std::runtime_error("Cannot read game record file '" + filename_ + "'");
+        return false;
+    }
+    const auto corrupt = [&] { return std::runtime_error("Game record file '" + filename_ + "' is corrupt"); };
+
+    stored_.resize(header.stored_bytes);
+    if (!read_all(file_.get(), stored_.data(), stored_.size())) {
+        throw std::runtime_error("Game record file '" + filename_ + "' is truncated");
+    }
+    if (compressed_) {
+#if THAI_CHECKERS_HAVE_ZSTD
+        block_.resize(header.raw_bytes);
+        const auto size = ZSTD_decompress(block_.data(), block_.size(), stored_.data(), stored_.size());
+        if (ZSTD_isError(size) != 0u || size != header.raw_bytes) throw corrupt();
+#endif
+    } else {
+        if (header.stored_bytes != header.raw_bytes) throw corrupt();
+        block_.swap(stored_);
+    }
+    offset_ = 0;
+    remaining_ = header.records;
+    worker_ = header.worker;
+    moves_.clear();
+    return true;
+}
+
+std::optional<GameRecord> GameRecordReader::next() {
+    while (remaining_ == 0) {
+        if (!read_block()) return std::nullopt;
+    }
+    const auto corrupt = [&] { return std::runtime_error("Game record file '" + filename_ + "' is corrupt"); };
+    const auto byte = [&] {
+        if (offset_ >= block_.size()) throw corrupt();
+        return block_[offset_++];
+    };
+    const auto varint = [&] {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const auto b = byte();
+            value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return value;
+        }
+        throw corrupt();
+    };
+
+    const auto outcome = byte();
+    GameRecord record;
+    const auto length = varint();
+    if (length > std::numeric_limits<std::uint32_t>::max() || (outcome & WINNER_MASK) == WINNER_MASK) throw corrupt();
+    record.length = static_cast<std::uint32_t>(length);
+    record.looping = (outcome & LOOPING) != 0;
+    if ((outcome & WINNER_MASK) == WINNER_WHITE) record.winner = PieceColor::WHITE;
+    if ((outcome & WINNER_MASK) == WINNER_BLACK) record.winner = PieceColor::BLACK;
+
+    if ((outcome & HAS_MOVES) != 0) {
+        const auto shared = varint();
+        if (shared > moves_.size() || shared > length || block_.size() - offset_ < length - shared) throw corrupt();
+        moves_.resize(shared);
+        const auto suffix = block_.begin() + static_cast<std::ptrdiff_t>(offset_);
+        moves_.insert(moves_.end(), suffix, suffix + static_cast<std::ptrdiff_t>(length - shared));
+        offset_ += length - shared;
+        record.moves = moves_;
+    }
+    --remaining_;
+    return record;
+}
@@ -0,0 +1,313 @@
+#include "Mcts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+[[nodiscard]] PieceColor opponent(PieceColor color) noexcept {
+    return color == PieceColor::BLACK ? PieceColor::WHITE : PieceColor::BLACK;
+}
+} // namespace
+
+Mcts::Mcts(std::size_t tree_mb)
+    : capacity_(std::clamp<std::size_t>(tree_mb * 1024 * 1024 / sizeof(Node), 1 + MoveList::capacity,
+                                        std::numeric_limits<std::uint32_t>::max())),
+      nodes_(std::make_unique<Node[]>(capacity_)) {
+    clear();
+}
+
+void Mcts::clear() noexcept {
+    auto& root = nodes_[0];
+    root.score.store(0, std::memory_order_relaxed);
+    root.visits.store(0, std::memory_order_relaxed);
+    root.virtual_loss.store(0, std::memory_order_relaxed);
+    root.child_count.store(0, std::memory_order_relaxed);
+    root.state.store(UNEXPANDED, std::memory_order_relaxed);
+    next_free_.store(1, std::memory_order_relaxed);
+    tree_full_.store(false, std::memory_order_relaxed);
+    root_key_.reset();
+    root_path_.clear();
+}
+
+void Mcts::compact(std::uint32_t root) {
+    struct Copy {
+        std::uint64_t score;
+        std::uint32_t visits;
+        std::uint32_t first_child;
+        std::uint8_t child_count;
+        std::uint8_t state;
+        std::uint8_t move;
+    };
+    // Breadth-first, so each node's children are appended as one range
+    std::vector<std::uint32_t> order{root};
+    std::vector<Copy> copies;
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        const auto& node = nodes_[order[k]];
+        Copy copy{
+            .score = node.score.load(std::memory_order_relaxed),
+            .visits = node.visits.load(std::memory_order_relaxed),
+            .first_child = 0,
+            .child_count = 0,
+            .state = node.state.load(std::memory_order_relaxed),
+            .move = node.move,
+        };
+        if (copy.state == EXPANDED) {
+            copy.first_child = static_cast<std::uint32_t>(order.size());
+            copy.child_count = node.child_count.load(std::memory_order_relaxed);
+            const auto first = node.first_child.load(std::memory_order_relaxed);
+            for (std::uint32_t i = 0; i < copy.child_count; ++i) order.push_back(first + i);
+        } else {
+            copy.state = UNEXPANDED;
+        }
+        copies.push_back(copy);
+    }
+
+    for (std::size_t k = 0; k < copies.size(); ++k) {
+        auto& node = nodes_[k];
+        node.score.store(copies[k].score, std::memory_order_relaxed);
+        node.visits.store(copies[k].visits, std::memory_order_relaxed);
+        node.virtual_loss.store(0, std::memory_order_relaxed);
+        node.first_child.store(copies[k].first_child, std::memory_order_relaxed);
+        node.child_count.store(copies[k].child_count, std::memory_order_relaxed);
+        node.state.store(copies[k].state, std::memory_order_relaxed);
+        node.move = copies[k].move;
+    }
+    next_free_.store(copies.size(), std::memory_order_relaxed);
+    tree_full_.store(false, std::memory_order_relaxed);
+}
+
+void Mcts::reroot(Game& game) {
+    const auto path = game.get_move_sequence();
+    const bool extends = root_key_ && path.size() >= root_path_.size() &&
+                         std::equal(root_path_.begin(), root_path_.end(), path.begin());
+    if (!extends) {
+        clear();
+        root_key_ = game.position_key();
+        root_path_ = path;
+        return;
+    }
+
+    // The same game only if it passed through the old root's position
+    const auto plies = path.size() - root_path_.size();
+    for (std::size_t i = 0; i < plies; ++i) game.undo_move();
+    const bool same_root = game.position_key() == *root_key_;
+    for (std::size_t i = root_path_.size(); i < path.size(); ++i) game.select_move(path[i]);
+
+    std::uint32_t root = 0;
+    for (std::size_t i = root_path_.size(); same_root && i < path.size(); ++i) {
+        const auto& node = nodes_[root];
+        if (node.state.load(std::memory_order_relaxed) != EXPANDED) {
+            root = std::numeric_limits<std::uint32_t>::max();
+            break;
+        }
+        // Children are allocated in choice order
+        root = node.first_child.load(std::memory_order_relaxed) + path[i];
+    }
+    if (!same_root || root == std::numeric_limits<std::uint32_t>::max()) {
+        clear();
+    } else if (root != 0) {
+        compact(root);
+    }
+    root_key_ = game.position_key();
+    root_path_ = path;
+}
+
+bool Mcts::expand(Node& node, std::size_t move_count) noexcept {
+    auto expected = UNEXPANDED;
+    if (!node.state.compare_exchange_strong(expected, EXPANDING, std::memory_order_acquire)) return false;
+    const auto first = tree_full_.load(std::memory_order_relaxed)
+                           ? capacity_
+                           : next_free_.fetch_add(move_count, std::memory_order_relaxed);
+    if (first + move_count > capacity_) {
+        tree_full_.store(true, std::memory_order_relaxed);
+        node.state.store(UNEXPANDED, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (std::size_t i = 0; i < move_count; ++i) {
+        auto& child = nodes_[first + i];
+        child.score.store(0, std::memory_order_relaxed);
+        child.visits.store(0, std::memory_order_relaxed);
+        child.virtual_loss.store(0, std::memory_order_relaxed);
+        child.child_count.store(0, std::memory_order_relaxed);
+        child.state.store(UNEXPANDED, std::memory_order_relaxed);
+        child.move = static_cast<std::uint8_t>(i);
+    }
+    node.first_child.store(static_cast<std::uint32_t>(first), std::memory_order_relaxed);
+    node.child_count.store(static_cast<std::uint8_t>(move_count), std::memory_order_relaxed);
+    // Publishes the children to threads that see EXPANDED
+    node.state.store(EXPANDED, std::memory_order_release);
+    return true;
+}
+
+std::uint32_t Mcts::select_child(const Node& node) const noexcept {
+    const auto first = node.first_child.load(std::memory_order_relaxed);
+    const auto count = node.child_count.load(std::memory_order_relaxed);
+    const auto parent_visits =
+        node.visits.load(std::memory_order_relaxed) + node.virtual_loss.load(std::memory_order_relaxed);
+    const auto log_visits = std::log(static_cast<double>(std::max<std::uint32_t>(parent_visits, 1)));
+
+    auto best = first;
+    auto best_priority = -std::numeric_limits<double>::infinity();
+    for (std::uint32_t i = first; i < first + count; ++i) {
+        const auto& child = nodes_[i];
+        // Virtual losses count as visits that scored nothing
+        const auto visits =
+            child.visits.load(std::memory_order_relaxed) + child.virtual_loss.load(std::memory_order_relaxed);
+        if (visits == 0) return i;
+        const auto n = static_cast<double>(visits);
+        const auto mean = static_cast<double>(child.score.load(std::memory_order_relaxed)) / (2.0 * n);
+        const auto priority = mean + exploration_ * std::sqrt(log_visits / n);
+        if (priority > best_priority) {
+            best_priority = priority;
+            best = i;
+        }
+    }
+    return best;
+}
+
+std::uint32_t Mcts::most_visited_child(const Node& node) const noexcept {
+    const auto first = node.first_child.load(std::memory_order_relaxed);
+    const auto count = node.child_count.load(std::memory_order_relaxed);
+    auto best = first;
+    for (std::uint32_t i = first + 1; i < first + count; ++i) {
+        if (nodes_[i].visits.load(std::memory_order_relaxed) > nodes_[best].visits.load(std::memory_order_relaxed)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void Mcts::iterate(Game& game, playout::Random& random, std::vector<std::uint32_t>& path) {
+    path.clear();
+    path.push_back(0);
+    auto* node = &nodes_[0];
+    while (node->state.load(std::memory_order_acquire) == EXPANDED) {
+        const auto child = select_child(*node);
+        node = &nodes_[child];
+        node->virtual_loss.fetch_add(1, std::memory_order_relaxed);
+        game.select_move(node->move);
+        path.push_back(child);
+    }
+
+    // A leaf is expanded on its second visit, so single-visit lines cost no arena space
+    const auto move_count = game.move_count();
+    if (move_count > 0 && node->visits.load(std::memory_order_relaxed) > 0 && expand(*node, move_count)) {
+        const auto child = node->first_child.load(std::memory_order_relaxed) +
+                           static_cast<std::uint32_t>(random.below(move_count));
+        node = &nodes_[child];
+        node->virtual_loss.fetch_add(1, std::memory_order_relaxed);
+        game.select_move(node->move);
+        path.push_back(child);
+    }
+
+    const auto outcome = playout::play(game, random, max_playout_plies_);
+
+    // Back up from the leaf; the mover into a node is the opponent of its side to move
+    auto mover = opponent(game.player());
+    for (auto k = path.size(); k-- > 0;) {
+        auto& visited = nodes_[path[k]];
+        std::uint64_t half_points = 1;
+        if (outcome.finished && outcome.winner) half_points = *outcome.winner == mover ? 2 : 0;
+        visited.score.fetch_add(half_points, std::memory_order_relaxed);
+        visited.visits.fetch_add(1, std::memory_order_relaxed);
+        if (k > 0) {
+            visited.virtual_loss.fetch_sub(1, std::memory_order_relaxed);
+            game.undo_move();
+        }
+        mover = opponent(mover);
+    }
+}
+
+Mcts::Result Mcts::run(Game& game, const Limits& limits) {
+    if (!limits.time && !limits.iterations) throw std::invalid_argument("MCTS needs a time or iteration limit");
+
+    const auto start = std::chrono::steady_clock::now();
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (limits.time) deadline = start + *limits.time;
+    // Headroom above the limit, so claims past it (or past a stop) never wrap the counter
+    const auto limit = std::min(limits.iterations.value_or(std::numeric_limits<std::uint64_t>::max()),
+                                std::numeric_limits<std::uint64_t>::max() / 2);
+
+    reroot(game);
+    Result result;
+    result.reused = nodes_[0].visits.load(std::memory_order_relaxed);
+    const auto move_count = game.move_count();
+    if (move_count == 0) {
+        result.nodes = size();
+        result.elapsed = std::chrono::steady_clock::now() - start;
+        return result;
+    }
+    expand(nodes_[0], move_count);
+
+    // Copies taken before any thread starts moving on its own
+    games_.resize(threads_ - 1);
+    for (auto& copy : games_) copy.copy_from(game);
+    std::atomic<std::uint64_t> started{0};
+    std::vector<std::uint64_t> thread_iterations(threads_);
+    // The first exception of any thread (a bad_alloc, say) ends the claims of every thread and is
+    // rethrown once they have joined; one escaping a helper would call std::terminate
+    std::mutex failure_mutex;
+    std::exception_ptr failure;
+    const auto work = [&](Game& thread_game, std::size_t t) {
+        try {
+            playout::Random random(seed_ + (run_count_ << 16) + t);
+            std::vector<std::uint32_t> path;
+            while (started.fetch_add(1, std::memory_order_relaxed) < limit) {
+                if (deadline && std::chrono::steady_clock::now() >= *deadline) break;
+                iterate(thread_game, random, path);
+                ++thread_iterations[t];
+            }
+        } catch (...) {
+            const std::lock_guard lock(failure_mutex);
+            if (!failure) failure = std::current_exception();
+            started.store(limit, std::memory_order_relaxed);
+        }
+    };
+    const auto root_length = game.get_move_sequence().size();
+    {
+        std::vector<std::jthread> helpers;
+        for (std::size_t t = 1; t < threads_; ++t) helpers.emplace_back(work, std::ref(games_[t - 1]), t);
+        work(game, 0);
+    }
+    ++run_count_;
+    if (failure) {
+        // An interrupted iteration leaves virtual losses (or a node mid-expansion) behind
+        clear();
+        game.rewind(root_length);
+        std::rethrow_exception(failure);
+    }
+
+    for (const auto count : thread_iterations) result.iterations += count;
+    const auto& best = nodes_[most_visited_child(nodes_[0])];
+    result.best_index = best.move;
+    result.best_move = game.choices()[best.move];
+    result.visits = best.visits.load(std::memory_order_relaxed);
+    if (result.visits > 0) {
+        result.value = static_cast<double>(best.score.load(std::memory_order_relaxed)) / (2.0 * result.visits);
+    }
+
+    // Principal variation: most visited children while they have been visited
+    std::uint32_t node = 0;
+    std::size_t plies = 0;
+    while (nodes_[node].state.load(std::memory_order_relaxed) == EXPANDED) {
+        const auto child = most_visited_child(nodes_[node]);
+        if (nodes_[child].visits.load(std::memory_order_relaxed) == 0) break;
+        result.pv.push_back(game.choices()[nodes_[child].move]);
+        game.select_move(nodes_[child].move);
+        ++plies;
+        node = child;
+    }
+    for (; plies > 0; --plies) game.undo_move();
+
+    result.nodes = size();
+    result.tree_full = tree_full_.load(std::memory_order_relaxed);
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
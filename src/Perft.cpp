@@ -0,0 +1,37 @@
+#include "Perft.h"
+
+namespace perft {
+
+std::uint64_t perft(Game& game, std::size_t depth) {
+    if (depth == 0) return 1;
+
+    // Bulk count: the leaves are the moves themselves, counted without listing them
+    if (depth == 1) return game.count_moves();
+    const std::size_t move_count = game.move_count();
+
+    std::uint64_t nodes = 0;
+    for (std::size_t i = 0; i < move_count; ++i) {
+        game.select_move(i);
+        nodes += perft(game, depth - 1);
+        game.undo_move();
+    }
+    return nodes;
+}
+
+std::vector<DivideEntry> divide(Game& game, std::size_t depth) {
+    std::vector<DivideEntry> entries;
+    if (depth == 0) return entries;
+
+    const std::size_t move_count = game.move_count();
+    entries.reserve(move_count);
+    for (std::size_t i = 0; i < move_count; ++i) {
+        // Re-read the root choices each time: deeper plies may reallocate the game's cache
+        const Move move = game.choices()[i];
+        game.select_move(i);
+        entries.push_back(DivideEntry{.move = move, .nodes = perft(game, depth - 1)});
+        game.undo_move();
+    }
+    return entries;
+}
+
+} // namespace perft
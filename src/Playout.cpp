@@ -0,0 +1,139 @@
+#include "Playout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace playout {
+namespace {
+// Playouts a thread claims at once from the shared counter
+constexpr std::uint64_t CHUNK = 64;
+
+[[nodiscard]] std::uint64_t splitmix64(std::uint64_t& state) noexcept {
+    auto z = (state += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+} // namespace
+
+Random::Random(std::uint64_t seed) noexcept {
+    for (auto& word : state_) word = splitmix64(seed);
+}
+
+std::uint64_t Random::next() noexcept {
+    const auto result = std::rotl(state_[1] * 5, 7) * 9;
+    const auto t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = std::rotl(state_[3], 45);
+    return result;
+}
+
+void Statistics::record(const Outcome& outcome) {
+    plies += outcome.length;
+    if (!outcome.finished) {
+        ++unfinished;
+        return;
+    }
+    outcomes.record(outcome.winner, outcome.length);
+    if (lengths.size() <= outcome.length) lengths.resize(outcome.length + 1);
+    ++lengths[outcome.length];
+}
+
+void Statistics::merge(const Statistics& other) {
+    outcomes.merge(other.outcomes);
+    unfinished += other.unfinished;
+    plies += other.plies;
+    if (lengths.size() < other.lengths.size()) lengths.resize(other.lengths.size());
+    for (std::size_t length = 0; length < other.lengths.size(); ++length) lengths[length] += other.lengths[length];
+}
+
+double Statistics::mean_length() const noexcept {
+    std::uint64_t total = 0;
+    for (std::size_t length = 0; length < lengths.size(); ++length) total += lengths[length] * length;
+    return outcomes.games == 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(outcomes.games);
+}
+
+Outcome play(Game& game, Random& random, std::size_t max_plies) {
+    Outcome outcome;
+    for (;;) {
+        const auto move_count = game.move_count();
+        if (move_count == 0) {
+            // The side to move is stuck and loses, unless the game ended on a repetition
+            outcome.finished = true;
+            if (!game.is_looping()) {
+                outcome.winner = game.player() == PieceColor::BLACK ? PieceColor::WHITE : PieceColor::BLACK;
+            }
+            break;
+        }
+        if (outcome.length == max_plies) break;
+        game.select_move(random.below(move_count));
+        ++outcome.length;
+    }
+    game.rewind(game.get_move_sequence().size() - outcome.length);
+    return outcome;
+}
+
+Result run(const Game& root, const Limits& limits, const Options& options) {
+    if (!limits.time && !limits.playouts) throw std::invalid_argument("Playouts need a time or playout limit");
+
+    const auto start = std::chrono::steady_clock::now();
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (limits.time) deadline = start + *limits.time;
+    // Headroom above the limit, so claims past it (or past a stop) never wrap the counter
+    const auto limit =
+        std::min(limits.playouts.value_or(std::numeric_limits<std::uint64_t>::max()),
+                 std::numeric_limits<std::uint64_t>::max() / 2);
+
+    const auto thread_count = std::max<std::size_t>(1, options.threads);
+    std::atomic<std::uint64_t> next_index{0};
+    std::vector<Statistics> thread_stats(thread_count);
+
+    // The first exception of any thread (a bad_alloc, say) ends the claims of every thread and is
+    // rethrown once they have joined; one escaping a helper would call std::terminate
+    std::mutex failure_mutex;
+    std::exception_ptr failure;
+    const auto work = [&](Statistics& stats) {
+        try {
+            auto game = Game::copy(root);
+            for (;;) {
+                const auto first = next_index.fetch_add(CHUNK, std::memory_order_relaxed);
+                if (first >= limit) return;
+                const auto last = std::min(limit, first + CHUNK);
+                for (auto index = first; index < last; ++index) {
+                    if (deadline && std::chrono::steady_clock::now() >= *deadline) return;
+                    Random random(options.seed + index);
+                    stats.record(play(game, random, options.max_plies));
+                }
+            }
+        } catch (...) {
+            const std::lock_guard lock(failure_mutex);
+            if (!failure) failure = std::current_exception();
+            next_index.store(limit, std::memory_order_relaxed);
+        }
+    };
+
+    {
+        std::vector<std::jthread> helpers;
+        for (std::size_t t = 1; t < thread_count; ++t) helpers.emplace_back(work, std::ref(thread_stats[t]));
+        work(thread_stats[0]);
+    }
+    if (failure) std::rethrow_exception(failure);
+
+    Result result;
+    for (const auto& stats : thread_stats) result.stats.merge(stats);
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+} // namespace playout
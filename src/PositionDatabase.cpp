@@ -0,0 +1,143 @@
+#include "PositionDatabase.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+[[nodiscard]] constexpr auto key_of(const PositionDatabase::Record& r) noexcept {
+    return std::tuple{r.occ, r.black, r.dame, r.side};
+}
+} // namespace
+
+PositionDatabase::Record PositionDatabase::Record::of(const Board& board, PieceColor side,
+                                                      const TraversalStatistics& stats) noexcept {
+    const auto occ = board.occ_bits();
+    return Record{
+        .occ = occ,
+        .black = board.black_bits() & occ,
+        .dame = board.dame_bits() & occ,
+        .side = to_underlying(side),
+        .padding = {},
+        .games = stats.games,
+        .black_wins = stats.black_wins,
+        .white_wins = stats.white_wins,
+        .draws = stats.draws,
+        .min_length = static_cast<std::uint32_t>(stats.min_length),
+        .max_length = static_cast<std::uint32_t>(stats.max_length),
+    };
+}
+
+TraversalStatistics PositionDatabase::Record::statistics() const noexcept {
+    return TraversalStatistics{
+        .games = games,
+        .black_wins = black_wins,
+        .white_wins = white_wins,
+        .draws = draws,
+        .min_length = min_length,
+        .max_length = max_length,
+    };
+}
+
+PositionDatabase::Record PositionDatabase::Record::canonical() const noexcept {
+    if (side == to_underlying(PieceColor::WHITE)) return *this;
+    Board board;
+    board.set_from_masks(occ, black, dame);
+    return of(board.mirrored(), PieceColor::WHITE, statistics().mirrored());
+}
+
+PositionDatabase PositionDatabase::open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open position database '" + path + "'");
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error("Position database '" + path + "' is truncated");
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (mapping == MAP_FAILED) throw std::runtime_error("Cannot map position database '" + path + "'");
+
+    Header header{};
+    std::memcpy(&header, mapping, sizeof(Header));
+    const bool valid = header.magic == MAGIC && header.version == VERSION && header.record_size == sizeof(Record) &&
+                       header.record_count == (size - sizeof(Header)) / sizeof(Record);
+    if (!valid) {
+        ::munmap(mapping, size);
+        throw std::runtime_error("'" + path + "' is not a version " + std::to_string(VERSION) + " position database");
+    }
+
+    // The header keeps the records 8-byte aligned within the page-aligned mapping
+    const auto* records = reinterpret_cast<const Record*>(static_cast<const std::byte*>(mapping) + sizeof(Header));
+    return PositionDatabase(mapping, size, {records, static_cast<std::size_t>(header.record_count)},
+                            (header.flags & FLAG_CANONICAL) != 0u);
+}
+
+void PositionDatabase::write(const std::string& path, std::vector<Record> records, bool canonical) {
+    if (canonical) {
+        for (auto& record : records) record = record.canonical();
+    }
+    std::ranges::stable_sort(records, {}, key_of);
+    const auto duplicates = std::ranges::unique(records, {}, key_of);
+    records.erase(duplicates.begin(), duplicates.end());
+
+    const Header header{
+        .magic = MAGIC,
+        .version = VERSION,
+        .record_size = sizeof(Record),
+        .record_count = records.size(),
+        .flags = canonical ? FLAG_CANONICAL : 0u,
+    };
+
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot create position database '" + path + "'");
+    const bool ok = std::fwrite(&header, sizeof(Header), 1, file.get()) == 1 &&
+                    std::fwrite(records.data(), sizeof(Record), records.size(), file.get()) == records.size();
+    if (!ok || std::fflush(file.get()) != 0) throw std::runtime_error("Cannot write position database '" + path + "'");
+}
+
+PositionDatabase::PositionDatabase(PositionDatabase&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr)), mapping_size_(std::exchange(other.mapping_size_, 0)),
+      records_(std::exchange(other.records_, {})), canonical_(other.canonical_) {}
+
+PositionDatabase& PositionDatabase::operator=(PositionDatabase&& other) noexcept {
+    if (this != &other) {
+        if (mapping_ != nullptr) ::munmap(mapping_, mapping_size_);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mapping_size_ = std::exchange(other.mapping_size_, 0);
+        records_ = std::exchange(other.records_, {});
+        canonical_ = other.canonical_;
+    }
+    return *this;
+}
+
+PositionDatabase::~PositionDatabase() {
+    if (mapping_ != nullptr) ::munmap(mapping_, mapping_size_);
+}
+
+std::optional<TraversalStatistics> PositionDatabase::find(const Board& board, PieceColor side) const noexcept {
+    if (canonical_ && side == PieceColor::BLACK) {
+        const auto found = find_record(board.mirrored(), PieceColor::WHITE);
+        return found ? std::optional(found->mirrored()) : std::nullopt;
+    }
+    return find_record(board, side);
+}
+
+std::optional<TraversalStatistics> PositionDatabase::find_record(const Board& board, PieceColor side) const noexcept {
+    const auto occ = board.occ_bits();
+    const auto key = std::tuple{occ, board.black_bits() & occ, board.dame_bits() & occ, to_underlying(side)};
+    const auto it = std::ranges::lower_bound(records_, key, {}, key_of);
+    if (it == records_.end() || key_of(*it) != key) return std::nullopt;
+    return it->statistics();
+}
@@ -0,0 +1,354 @@
+#include "Search.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "Explorer.h"
+
+namespace {
+constexpr Search::Score INFINITE_SCORE = std::numeric_limits<std::int16_t>::max();
+
+constexpr std::uint32_t HISTORY_LIMIT = 1u << 26;
+
+// Nodes between two looks at the clock
+constexpr std::uint64_t LIMIT_CHECK_INTERVAL = 1024;
+
+// Squares of one row (4 playable squares per row; white moves towards row 0, black towards row 7)
+[[nodiscard]] constexpr std::uint32_t row_mask(int row) noexcept { return std::uint32_t{0xF} << (4 * row); }
+
+[[nodiscard]] Search::Score side_material(std::uint32_t own, std::uint32_t dames, bool black) noexcept {
+    const auto pions = own & ~dames;
+    Search::Score score = Search::PION_VALUE * std::popcount(pions) + Search::DAME_VALUE * std::popcount(own & dames);
+    for (int row = 1; row < 7; ++row) {
+        const auto advanced = black ? row : 7 - row;
+        score += Search::ADVANCE_VALUE * advanced * std::popcount(pions & row_mask(row));
+    }
+    return score;
+}
+
+// Win scores are stored relative to the node, so they stay valid at any ply
+[[nodiscard]] Search::Score to_table(Search::Score score, std::size_t ply) noexcept {
+    if (score >= Search::WIN_THRESHOLD) return score + static_cast<Search::Score>(ply);
+    if (score <= -Search::WIN_THRESHOLD) return score - static_cast<Search::Score>(ply);
+    return score;
+}
+
+[[nodiscard]] Search::Score from_table(Search::Score score, std::size_t ply) noexcept {
+    if (score >= Search::WIN_THRESHOLD) return score - static_cast<Search::Score>(ply);
+    if (score <= -Search::WIN_THRESHOLD) return score + static_cast<Search::Score>(ply);
+    return score;
+}
+
+[[nodiscard]] std::size_t history_index(const Move& move) noexcept { return move.from.hash() * 32 + move.to.hash(); }
+} // namespace
+
+Search::Score Search::evaluate_material(const Board& board, PieceColor side) noexcept {
+    const auto occ = board.occ_bits();
+    const auto black = occ & board.black_bits();
+    const auto white = occ & ~black;
+    const auto dames = occ & board.dame_bits();
+    const auto balance = side_material(black, dames, true) - side_material(white, dames, false);
+    return side == PieceColor::BLACK ? balance : -balance;
+}
+
+namespace {
+[[nodiscard]] constexpr std::uint64_t pack(std::int32_t score, std::uint8_t depth, std::uint8_t bound, std::uint8_t best,
+                                           std::uint8_t generation) noexcept {
+    return std::uint64_t{static_cast<std::uint32_t>(score)} | std::uint64_t{depth} << 32 | std::uint64_t{bound} << 40 |
+           std::uint64_t{best} << 48 | std::uint64_t{generation} << 56;
+}
+} // namespace
+
+Search::Probe Search::Entry::stored() const noexcept {
+    const auto word = data.load(std::memory_order_relaxed);
+    return Probe{
+        .score = static_cast<std::int32_t>(static_cast<std::uint32_t>(word)),
+        .depth = static_cast<std::uint8_t>(word >> 32),
+        .bound = static_cast<Bound>(static_cast<std::uint8_t>(word >> 40)),
+        .best = static_cast<std::uint8_t>(word >> 48),
+        .generation = static_cast<std::uint8_t>(word >> 56),
+    };
+}
+
+Search::Probe Search::Entry::read(zobrist::Key key) const noexcept {
+    const auto word = data.load(std::memory_order_relaxed);
+    if ((check.load(std::memory_order_relaxed) ^ word) != key) return Probe{};
+    return stored();
+}
+
+void Search::Entry::write(zobrist::Key key, const Probe& probe) noexcept {
+    const auto word = pack(probe.score, probe.depth, static_cast<std::uint8_t>(probe.bound), probe.best, probe.generation);
+    check.store(key ^ word, std::memory_order_relaxed);
+    data.store(word, std::memory_order_relaxed);
+}
+
+Search::Search(std::size_t table_mb, std::function<void(const Result&)> info_cb)
+    : table_size_(std::bit_floor(std::max<std::size_t>(1, (table_mb << 20) / sizeof(Entry)))),
+      table_(std::make_unique<Entry[]>(table_size_)), evaluator_(&Search::evaluate_material),
+      info_cb_(std::move(info_cb)) {
+    set_threads(1);
+}
+
+void Search::set_threads(std::size_t threads) {
+    workers_.resize(std::max<std::size_t>(1, threads));
+    for (std::size_t id = 0; id < workers_.size(); ++id) {
+        if (!workers_[id]) workers_[id] = std::make_unique<Worker>();
+        workers_[id]->id = id;
+    }
+}
+
+void Search::clear() {
+    for (std::size_t i = 0; i < table_size_; ++i) table_[i].write(0, Probe{});
+    generation_ = 0;
+    for (auto& worker : workers_) {
+        worker->killers = {};
+        worker->history = {};
+    }
+}
+
+void Search::check_limits(Worker& worker) noexcept {
+    if (worker.nodes % LIMIT_CHECK_INTERVAL == 0) {
+        const auto total = shared_nodes_.fetch_add(LIMIT_CHECK_INTERVAL, std::memory_order_relaxed) + LIMIT_CHECK_INTERVAL;
+        if (node_limit_ && total >= *node_limit_) stopped_.store(true, std::memory_order_relaxed);
+    }
+    if (deadline_ && std::chrono::steady_clock::now() >= *deadline_) stopped_.store(true, std::memory_order_relaxed);
+}
+
+void Search::order_moves(const Worker& worker, const MoveList& moves, std::size_t ply,
+                         std::optional<std::uint8_t> table_move,
+                         std::array<std::int32_t, MoveList::capacity>& scores) const {
+    const auto& killers = worker.killers[ply];
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const auto& move = moves[i];
+        std::int32_t score = static_cast<std::int32_t>(worker.history[history_index(move)]);
+        if (table_move && *table_move == i) {
+            score = std::numeric_limits<std::int32_t>::max();
+        } else if (move.is_capture()) {
+            score = (1 << 28) + static_cast<std::int32_t>(move.capture_count());
+        } else if (move == killers[0]) {
+            score = (1 << 27) + 1;
+        } else if (move == killers[1]) {
+            score = 1 << 27;
+        }
+        scores[i] = score;
+    }
+}
+
+Search::Score Search::negamax(Worker& worker, Game& game, int depth, Score alpha, Score beta, std::size_t ply) {
+    worker.pv_length[ply] = 0;
+    if (++worker.nodes % LIMIT_CHECK_INTERVAL == 0) check_limits(worker);
+    if (stopped_.load(std::memory_order_relaxed)) return 0;
+    if (game.is_looping()) return 0;
+
+    // Below the horizon a quiet node is decided by two mask tests, without generating its moves
+    if (depth <= 0) {
+        const Explorer explorer(game.board());
+        if (explorer.capture_sources(game.player()) == 0u) {
+            if (explorer.move_sources(game.player()) == 0u) return -(WIN_SCORE - static_cast<Score>(ply));
+            return evaluator_(game.board(), game.player());
+        }
+    }
+
+    const auto choices = game.choices();
+    if (choices.empty()) return -(WIN_SCORE - static_cast<Score>(ply));
+    if (ply + 1 >= MAX_PLY) return evaluator_(game.board(), game.player());
+    // Pending captures extend the horizon (they are forced, so the position is not quiet)
+    const bool capturing = choices.front().is_capture();
+    if (depth <= 0 && !capturing) return evaluator_(game.board(), game.player());
+
+    // Copied: deeper plies may reallocate the game's choice cache
+    MoveList moves;
+    for (const auto& move : choices) moves.push_back(move);
+
+    const auto key = game.position_key();
+    auto& entry = entry_for(key);
+    const auto probe = entry.read(key);
+    std::optional<std::uint8_t> table_move;
+    if (probe.bound != Bound::NONE && probe.best < moves.size()) {
+        table_move = probe.best;
+        if (ply > 0 && static_cast<int>(probe.depth) >= depth) {
+            const auto score = from_table(probe.score, ply);
+            if (probe.bound == Bound::EXACT || (probe.bound == Bound::LOWER && score >= beta) ||
+                (probe.bound == Bound::UPPER && score <= alpha)) {
+                return score;
+            }
+        }
+    }
+
+    std::array<std::int32_t, MoveList::capacity> scores{};
+    order_moves(worker, moves, ply, table_move, scores);
+
+    const Score original_alpha = alpha;
+    Score best = -INFINITE_SCORE;
+    std::uint8_t best_index = 0;
+    std::array<std::uint8_t, MoveList::capacity> order{};
+    for (std::size_t i = 0; i < moves.size(); ++i) order[i] = static_cast<std::uint8_t>(i);
+
+    for (std::size_t n = 0; n < moves.size(); ++n) {
+        // Selection sort step: the rest is often never searched after a cutoff
+        const auto pick = std::max_element(order.begin() + static_cast<std::ptrdiff_t>(n),
+                                           order.begin() + static_cast<std::ptrdiff_t>(moves.size()),
+                                           [&](std::uint8_t a, std::uint8_t b) { return scores[a] < scores[b]; });
+        std::iter_swap(order.begin() + static_cast<std::ptrdiff_t>(n), pick);
+        const auto index = order[n];
+
+        game.select_move(index);
+        const Score score = -negamax(worker, game, depth - 1, -beta, -alpha, ply + 1);
+        game.undo_move();
+        if (stopped_.load(std::memory_order_relaxed)) return 0;
+
+        if (score > best) {
+            best = score;
+            best_index = index;
+        }
+        if (score > alpha) {
+            alpha = score;
+            auto& line = worker.pv[ply];
+            line[0] = index;
+            std::copy_n(worker.pv[ply + 1].begin(), worker.pv_length[ply + 1], line.begin() + 1);
+            worker.pv_length[ply] = worker.pv_length[ply + 1] + 1;
+        }
+        if (alpha >= beta) {
+            const auto& move = moves[index];
+            if (!move.is_capture()) {
+                auto& killers = worker.killers[ply];
+                if (!(move == killers[0])) {
+                    killers[1] = killers[0];
+                    killers[0] = move;
+                }
+                auto& history = worker.history[history_index(move)];
+                history += static_cast<std::uint32_t>(depth * depth);
+                // Kept below the killer and capture bands of the ordering scores
+                if (history >= HISTORY_LIMIT) {
+                    for (auto& h : worker.history) h /= 2;
+                }
+            }
+            break;
+        }
+    }
+
+    // Capture extensions below the horizon are not worth a table slot
+    const auto stored = entry.stored();
+    if (depth > 0 && (stored.generation != generation_ || probe.bound != Bound::NONE || depth >= stored.depth)) {
+        entry.write(key, Probe{
+                             .score = to_table(best, ply),
+                             .depth = static_cast<std::uint8_t>(depth),
+                             .bound = best >= beta ? Bound::LOWER
+                                                   : (best > original_alpha ? Bound::EXACT : Bound::UPPER),
+                             .best = best_index,
+                             .generation = generation_,
+                         });
+    }
+    return best;
+}
+
+void Search::iterate(Worker& worker, Game& game, std::size_t first_depth, std::size_t max_depth) {
+    for (std::size_t depth = first_depth; depth <= max_depth; ++depth) {
+        const auto score = negamax(worker, game, static_cast<int>(depth), -INFINITE_SCORE, INFINITE_SCORE, 0);
+        if (stopped_.load(std::memory_order_relaxed) || worker.pv_length[0] == 0) break;
+
+        auto& result = worker.result;
+        result.score = score;
+        result.depth = depth;
+        result.best_index = worker.pv[0][0];
+        result.pv.clear();
+        for (std::size_t ply = 0; ply < worker.pv_length[0]; ++ply) {
+            result.pv.push_back(game.choices()[worker.pv[0][ply]]);
+            game.select_move(worker.pv[0][ply]);
+        }
+        for (std::size_t ply = 0; ply < worker.pv_length[0]; ++ply) game.undo_move();
+        result.best_move = result.pv.front();
+
+        if (info_cb_) {
+            const std::lock_guard lock(report_mutex_);
+            if (depth > reported_depth_) {
+                reported_depth_ = depth;
+                auto info = result;
+                // Published counts of every thread plus this thread's unpublished remainder
+                info.nodes = shared_nodes_.load(std::memory_order_relaxed) + worker.nodes % LIMIT_CHECK_INTERVAL;
+                info.elapsed = std::chrono::steady_clock::now() - start_;
+                info_cb_(info);
+            }
+        }
+
+        // A forced result within the searched depth does not change with more depth
+        if (std::abs(score) >= WIN_THRESHOLD && WIN_SCORE - std::abs(score) <= static_cast<Score>(depth)) break;
+        if (deadline_ && std::chrono::steady_clock::now() >= *deadline_) break;
+    }
+}
+
+Search::Result Search::run(Game& game, const Limits& limits) {
+    start_ = std::chrono::steady_clock::now();
+    shared_nodes_.store(0, std::memory_order_relaxed);
+    stopped_.store(false, std::memory_order_relaxed);
+    node_limit_ = limits.nodes;
+    deadline_ = limits.time ? std::make_optional(start_ + *limits.time) : std::nullopt;
+    reported_depth_ = 0;
+    ++generation_;
+
+    const auto root_moves = game.choices();
+    if (game.is_looping() || root_moves.empty()) {
+        Result result;
+        result.score = game.is_looping() ? 0 : -WIN_SCORE;
+        return result;
+    }
+    for (auto& worker : workers_) {
+        worker->nodes = 0;
+        worker->killers = {};
+        // Some move is always reported, even if the first iteration does not finish
+        worker->result = Result{};
+        worker->result.best_move = root_moves.front();
+    }
+
+    const auto max_depth = std::min(limits.depth, MAX_PLY - 1);
+    {
+        // The first exception of any thread (from the evaluator, say) stops the others and is rethrown
+        // once they have joined; one escaping a helper would call std::terminate
+        std::mutex failure_mutex;
+        std::exception_ptr failure;
+        const auto guarded = [&](Worker& worker, Game& searched, std::size_t first_depth) {
+            try {
+                iterate(worker, searched, first_depth, max_depth);
+            } catch (...) {
+                const std::lock_guard lock(failure_mutex);
+                if (!failure) failure = std::current_exception();
+                stopped_.store(true, std::memory_order_relaxed);
+            }
+        };
+
+        // Helpers search copies of the game, taken before the calling thread (the first worker) moves it
+        const auto root_length = game.get_move_sequence().size();
+        for (std::size_t id = 1; id < workers_.size(); ++id) workers_[id]->game.copy_from(game);
+        std::vector<std::jthread> helpers;
+        helpers.reserve(workers_.size() - 1);
+        for (std::size_t id = 1; id < workers_.size(); ++id) {
+            helpers.emplace_back([&, id] { guarded(*workers_[id], workers_[id]->game, 1 + id % 2); });
+        }
+        guarded(*workers_[0], game, 1);
+        stopped_.store(true, std::memory_order_relaxed);
+        helpers.clear();
+        if (failure) {
+            game.rewind(root_length);
+            std::rethrow_exception(failure);
+        }
+    }
+
+    // The deepest completed iteration wins, the first worker on ties
+    const Worker* chosen = workers_[0].get();
+    for (const auto& worker : workers_) {
+        if (worker->result.depth > chosen->result.depth) chosen = worker.get();
+    }
+    Result result = chosen->result;
+    result.nodes = 0;
+    for (const auto& worker : workers_) {
+        result.thread_nodes.push_back(worker->nodes);
+        result.nodes += worker->nodes;
+    }
+    result.elapsed = std::chrono::steady_clock::now() - start_;
+    return result;
+}
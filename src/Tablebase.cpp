@@ -0,0 +1,305 @@
+#include "Tablebase.h"
+
+#include "Bitboard.h"
+#include "Explorer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+using Value = Tablebase::Value;
+using Word = std::uint64_t;
+using bitboard::Mask;
+
+constexpr std::size_t VALUES_PER_WORD = 32;
+constexpr std::size_t FLAGS_PER_WORD = 64;
+constexpr std::size_t WORDS_PER_CHUNK = 1024;
+
+constexpr std::array<char, 8> MAGIC = {'T', 'C', 'T', 'B', '\0', '\0', '\0', '\0'};
+constexpr std::uint32_t VERSION = 2;
+
+struct Header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t max_pieces;
+};
+
+// binomial[n][k] for n <= 32, k <= MAX_SUPPORTED_PIECES
+constexpr auto binomial = [] {
+    std::array<std::array<std::uint64_t, Tablebase::MAX_SUPPORTED_PIECES + 1>, bitboard::square_count + 1> c{};
+    for (std::size_t n = 0; n <= bitboard::square_count; ++n) {
+        c[n][0] = 1;
+        for (std::size_t k = 1; k <= Tablebase::MAX_SUPPORTED_PIECES && k <= n; ++k) {
+            c[n][k] = c[n - 1][k - 1] + (k < n ? c[n - 1][k] : 0);
+        }
+    }
+    return c;
+}();
+
+[[nodiscard]] constexpr PieceColor opponent(PieceColor color) noexcept {
+    return color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE;
+}
+
+// Row a pion of the color promotes on: 0 for white, 7 for black
+[[nodiscard]] constexpr Mask promotion_row(PieceColor color) noexcept {
+    return color == PieceColor::WHITE ? Mask{0x0000000Fu} : Mask{0xF0000000u};
+}
+
+[[nodiscard]] Value get(std::span<const Word> words, std::uint64_t i) noexcept {
+    return static_cast<Value>((words[i / VALUES_PER_WORD] >> (2 * (i % VALUES_PER_WORD))) & 3u);
+}
+
+[[nodiscard]] Value load_value(std::vector<Word>& words, std::uint64_t i) noexcept {
+    const Word w = std::atomic_ref(words[i / VALUES_PER_WORD]).load(std::memory_order_relaxed);
+    return static_cast<Value>((w >> (2 * (i % VALUES_PER_WORD))) & 3u);
+}
+
+// Sets an UNKNOWN value; false if another thread decided the position first
+bool decide(std::vector<Word>& words, std::uint64_t i, Value value) noexcept {
+    std::atomic_ref word(words[i / VALUES_PER_WORD]);
+    const auto shift = 2 * (i % VALUES_PER_WORD);
+    Word w = word.load(std::memory_order_relaxed);
+    do {
+        if (((w >> shift) & 3u) != 0u) return false;
+    } while (!word.compare_exchange_weak(w, w | (Word{static_cast<std::uint8_t>(value)} << shift),
+                                         std::memory_order_relaxed));
+    return true;
+}
+
+void flag(std::vector<Word>& flags, std::uint64_t i) noexcept {
+    std::atomic_ref(flags[i / FLAGS_PER_WORD]).fetch_or(Word{1} << (i % FLAGS_PER_WORD), std::memory_order_relaxed);
+}
+
+// Runs body(first_word, last_word) over [0, words) in chunks handed out dynamically to the threads
+template <typename Body> void parallel_for(std::size_t words, std::size_t threads, const Body& body) {
+    std::atomic<std::size_t> next{0};
+    const auto run = [&] {
+        for (auto begin = next.fetch_add(WORDS_PER_CHUNK); begin < words; begin = next.fetch_add(WORDS_PER_CHUNK)) {
+            body(begin, std::min(words, begin + WORDS_PER_CHUNK));
+        }
+    };
+    std::vector<std::jthread> pool;
+    for (std::size_t t = 1; t < threads; ++t) pool.emplace_back(run);
+    run();
+}
+
+// Takes one piece of the mover back: a pion step, a dame slide, or a promotion undone
+template <typename Emit> void for_each_unmove(const Board& board, PieceColor mover, Emit&& emit) {
+    const Mask occ = board.occ_bits();
+    const Mask black = board.black_bits() & occ;
+    const Mask dame = board.dame_bits() & occ;
+    const Mask own = mover == PieceColor::BLACK ? black : occ & ~black;
+    const Mask own_dames = own & dame;
+    const auto forward = bitboard::forward_directions(mover);
+
+    const auto emit_from = [&](std::size_t to, std::size_t from, bool was_dame) {
+        const Mask moved = bitboard::bit(to) | bitboard::bit(from);
+        Board q;
+        q.set_from_masks(occ ^ moved, mover == PieceColor::BLACK ? black ^ moved : black,
+                         (dame & ~bitboard::bit(to)) | (was_dame ? bitboard::bit(from) : 0u));
+        emit(q);
+    };
+    const auto pion_origins = [&](std::size_t to) {
+        for (const auto dir : forward) {
+            const auto from = bitboard::neighbor(bitboard::opposite(dir), to);
+            if (from != bitboard::no_square && (occ & bitboard::bit(from)) == 0u &&
+                (promotion_row(mover) & bitboard::bit(from)) == 0u) {
+                emit_from(to, from, false);
+            }
+        }
+    };
+
+    for (Mask pieces = own; pieces != 0u; pieces &= pieces - 1) {
+        const auto to = static_cast<std::size_t>(std::countr_zero(pieces));
+        const bool on_promotion_row = (promotion_row(mover) & bitboard::bit(to)) != 0u;
+        if ((own_dames & bitboard::bit(to)) == 0u) {
+            // A pion on its promotion row would have been promoted by the move that brought it there
+            if (!on_promotion_row) pion_origins(to);
+            continue;
+        }
+        for (const auto dir : bitboard::all_directions) {
+            for (Mask from = bitboard::slide_targets(dir, to, occ); from != 0u; from &= from - 1) {
+                emit_from(to, static_cast<std::size_t>(std::countr_zero(from)), true);
+            }
+        }
+        if (on_promotion_row) pion_origins(to);
+    }
+}
+
+[[nodiscard]] Board after(const Board& board, const Move& move) noexcept {
+    Board next = board;
+    next.apply_delta(board.move_delta(move));
+    return next;
+}
+} // namespace
+
+std::uint64_t Tablebase::slice_size(std::size_t pieces) noexcept {
+    return binomial[bitboard::square_count][pieces] << (2 * pieces);
+}
+
+std::uint64_t Tablebase::index(const Board& board, PieceColor side) noexcept {
+    Mask occ = board.occ_bits();
+    Mask black = board.black_bits() & occ;
+    Mask dame = board.dame_bits() & occ;
+    if (side == PieceColor::BLACK) {
+        // The white-to-move twin (Board::mirrored), from the masks alone
+        black = bitboard::rotated(occ & ~black);
+        dame = bitboard::rotated(dame);
+        occ = bitboard::rotated(occ);
+    }
+    std::uint64_t rank = 0;
+    std::uint64_t colors = 0;
+    std::uint64_t types = 0;
+    std::size_t i = 0;
+    for (Mask m = occ; m != 0u; m &= m - 1, ++i) {
+        const auto square = static_cast<std::size_t>(std::countr_zero(m));
+        rank += binomial[square][i + 1];
+        colors |= std::uint64_t{(black >> square) & 1u} << i;
+        types |= std::uint64_t{(dame >> square) & 1u} << i;
+    }
+    return (((rank << i) | colors) << i) | types;
+}
+
+std::pair<Board, PieceColor> Tablebase::position(std::size_t pieces, std::uint64_t index) noexcept {
+    const auto low = (std::uint64_t{1} << pieces) - 1;
+    const auto types = index & low;
+    const auto colors = (index >> pieces) & low;
+    auto rank = index >> (2 * pieces);
+
+    Mask occ = 0;
+    Mask black = 0;
+    Mask dame = 0;
+    std::size_t square = bitboard::square_count;
+    for (auto i = pieces; i-- > 0;) {
+        // Largest square whose binomial still fits in the remaining rank
+        while (binomial[--square][i + 1] > rank) {}
+        rank -= binomial[square][i + 1];
+        occ |= bitboard::bit(square);
+        if ((colors >> i) & 1u) black |= bitboard::bit(square);
+        if ((types >> i) & 1u) dame |= bitboard::bit(square);
+    }
+    Board board;
+    board.set_from_masks(occ, black, dame);
+    return {board, PieceColor::WHITE};
+}
+
+std::optional<Tablebase::Value> Tablebase::probe(const Board& board, PieceColor side) const noexcept {
+    const auto pieces = static_cast<std::size_t>(std::popcount(board.occ_bits()));
+    if (pieces >= slices_.size()) return std::nullopt;
+    return get(slices_[pieces], index(board, side));
+}
+
+Tablebase Tablebase::build(std::size_t max_pieces, std::size_t threads) {
+    if (max_pieces > MAX_SUPPORTED_PIECES) {
+        throw std::invalid_argument("Tablebases are limited to " + std::to_string(MAX_SUPPORTED_PIECES) + " pieces");
+    }
+    threads = std::max<std::size_t>(threads, 1);
+
+    Tablebase tb;
+    for (std::size_t n = 0; n <= max_pieces; ++n) {
+        const auto size = slice_size(n);
+        auto& values = tb.slices_.emplace_back((size + VALUES_PER_WORD - 1) / VALUES_PER_WORD, Word{0});
+        const auto flag_words = (size + FLAGS_PER_WORD - 1) / FLAGS_PER_WORD;
+        std::vector<Word> frontier(flag_words, 0);
+        std::vector<Word> next(flag_words, 0);
+
+        // Terminal and capture positions: decided by their moves alone, captures land in the solved slices below
+        parallel_for(flag_words, threads, [&](std::size_t first, std::size_t last) {
+            MoveList moves;
+            for (auto i = first * FLAGS_PER_WORD; i < std::min(size, last * FLAGS_PER_WORD); ++i) {
+                const auto [board, side] = position(n, i);
+                Explorer(board).find_side_moves(side, moves);
+                if (!moves.empty() && !moves[0].is_capture()) continue;
+                bool any_draw = false;
+                bool any_loss = false;
+                for (const auto& move : moves) {
+                    const auto next_board = after(board, move);
+                    const auto value = get(tb.slices_[n - move.capture_count()], index(next_board, opponent(side)));
+                    any_loss |= value == Value::LOSS;
+                    any_draw |= value == Value::DRAW;
+                }
+                const auto value = any_loss ? Value::WIN : any_draw ? Value::DRAW : Value::LOSS;
+                decide(values, i, value);
+                if (value != Value::DRAW) flag(frontier, i);
+            }
+        });
+
+        // Retrograde rounds over the positions decided in the previous round
+        for (bool progress = true; progress;) {
+            std::atomic<bool> decided{false};
+            parallel_for(flag_words, threads, [&](std::size_t first, std::size_t last) {
+                MoveList moves;
+                for (auto w = first; w < last; ++w) {
+                    for (Word bits = frontier[w]; bits != 0u; bits &= bits - 1) {
+                        const auto i = w * FLAGS_PER_WORD + static_cast<std::size_t>(std::countr_zero(bits));
+                        const auto [board, side] = position(n, i);
+                        const bool lost = load_value(values, i) == Value::LOSS;
+                        const auto mover = opponent(side);
+                        for_each_unmove(board, mover, [&](const Board& prev) {
+                            const auto j = index(prev, mover);
+                            if (load_value(values, j) != Value::UNKNOWN) return;
+                            if (!lost) {
+                                // Lost only if every move leads to a position won by the opponent
+                                Explorer(prev).find_side_moves(mover, moves);
+                                const bool all_won = std::ranges::all_of(moves, [&](const Move& move) {
+                                    return load_value(values, index(after(prev, move), side)) == Value::WIN;
+                                });
+                                if (!all_won) return;
+                            }
+                            if (decide(values, j, lost ? Value::WIN : Value::LOSS)) {
+                                flag(next, j);
+                                decided.store(true, std::memory_order_relaxed);
+                            }
+                        });
+                    }
+                }
+            });
+            progress = decided.load();
+            frontier.swap(next);
+            std::ranges::fill(next, Word{0});
+        }
+
+        // Whatever neither side can force is a draw
+        for (auto& w : values) {
+            const Word unknown = ~(w | (w >> 1)) & 0x5555555555555555ull;
+            w |= unknown | (unknown << 1);
+        }
+        // Lanes past the end of the slice stay zero
+        if (const auto tail = size % VALUES_PER_WORD; tail != 0) values.back() &= (Word{1} << (2 * tail)) - 1;
+    }
+    return tb;
+}
+
+void Tablebase::save(const std::string& path) const {
+    const Header header{.magic = MAGIC, .version = VERSION, .max_pieces = static_cast<std::uint32_t>(max_pieces())};
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot create tablebase '" + path + "'");
+    bool ok = std::fwrite(&header, sizeof(Header), 1, file.get()) == 1;
+    for (const auto& slice : slices_) {
+        ok = ok && std::fwrite(slice.data(), sizeof(Word), slice.size(), file.get()) == slice.size();
+    }
+    if (!ok || std::fflush(file.get()) != 0) throw std::runtime_error("Cannot write tablebase '" + path + "'");
+}
+
+Tablebase Tablebase::load(const std::string& path) {
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot open tablebase '" + path + "'");
+    Header header{};
+    if (std::fread(&header, sizeof(Header), 1, file.get()) != 1 || header.magic != MAGIC ||
+        header.version != VERSION || header.max_pieces > MAX_SUPPORTED_PIECES) {
+        throw std::runtime_error("'" + path + "' is not a version " + std::to_string(VERSION) + " tablebase");
+    }
+    Tablebase tb;
+    for (std::size_t n = 0; n <= header.max_pieces; ++n) {
+        auto& slice = tb.slices_.emplace_back((slice_size(n) + VALUES_PER_WORD - 1) / VALUES_PER_WORD);
+        if (std::fread(slice.data(), sizeof(Word), slice.size(), file.get()) != slice.size()) {
+            throw std::runtime_error("Tablebase '" + path + "' is truncated");
+        }
+    }
+    return tb;
+}
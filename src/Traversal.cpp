@@ -1,78 +1,607 @@
 #include "Traversal.h"
+#include "PositionDatabase.h"
+#include "Tablebase.h"
+#include <algorithm>
 #include <chrono>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+// Subtree task: move indices from the traversal root down to the task's node
+using TaskPath = std::vector<std::uint8_t>;
+
+// Per-worker task deque: the owner pushes and pops at the back, thieves take from the front,
+// where the shallowest (largest) subtrees are
+class TaskDeque {
+  public:
+    void push(TaskPath&& task) {
+        const std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    std::optional<TaskPath> pop() {
+        const std::lock_guard lock(mutex_);
+        if (tasks_.empty()) return std::nullopt;
+        auto task = std::move(tasks_.back());
+        tasks_.pop_back();
+        return task;
+    }
+    std::optional<TaskPath> steal() {
+        const std::lock_guard lock(mutex_);
+        if (tasks_.empty()) return std::nullopt;
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        return task;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::deque<TaskPath> tasks_;
+};
+
+// Moves a worker's game onto the task's node, undoing only back to the common prefix
+void navigate(Game& game, std::size_t root_length, const TaskPath& path) {
+    const auto& sequence = game.get_move_sequence();
+    std::size_t common = 0;
+    while (root_length + common < sequence.size() && common < path.size() &&
+           sequence[root_length + common] == path[common]) {
+        ++common;
+    }
+    game.rewind(root_length + common);
+    for (std::size_t i = common; i < path.size(); ++i) game.select_move(path[i]);
+}
+} // namespace
+
+void Traversal::NodeCounters::merge(const NodeCounters& other) {
+    nodes += other.nodes;
+    inner_nodes += other.inner_nodes;
+    children += other.children;
+    if (depths.size() < other.depths.size()) depths.resize(other.depths.size());
+    for (std::size_t depth = 0; depth < other.depths.size(); ++depth) depths[depth] += other.depths[depth];
+}
 
 // Helper function to emit progress if 2 seconds have elapsed
-void Traversal::emit_progress_if_needed() {
+void Traversal::emit_progress_if_needed(Worker& worker) {
     if (!progress_cb_) return;
 
     const auto now = std::chrono::steady_clock::now();
-    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_progress_time_);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - worker.last_progress_time);
 
     if (elapsed >= std::chrono::milliseconds(2000)) { // 2 seconds
-        ProgressEvent prog_ev{.games = game_count};
-        progress_cb_(prog_ev);
-        last_progress_time_ = now;
-    }
-}
-
-void Traversal::traverse_impl(Game& game, std::size_t depth) {
-    // Check timeout first
-    if (deadline_ && std::chrono::steady_clock::now() >= *deadline_) {
-        return; // Time's up, stop traversal
-    }
-
-    // // Add depth limit to prevent infinite exploration
-    // const std::size_t MAX_DEPTH = 50; // Reasonable limit for demonstration
-    // if (depth >= MAX_DEPTH) {
-    //     // Treat as draw due to depth limit
-    //     ++game_count;
-    //     ResultEvent ev{
-    //         .game_id = game_count,
-    //         .looping = false,
-    //         .winner = std::nullopt, // Draw due to depth limit
-    //         .history = game.get_move_sequence(),
-    //     };
-    //     if (result_cb_) result_cb_(ev);
-
-    //     // Emit progress every 2 seconds
-    //     emit_progress_if_needed();
-    //     return;
-    // }
-
-    // Check for early termination conditions.
-    const std::size_t move_count = game.move_count();
+        publish(worker);
+        snapshot_instrumentation(worker);
+        progress_cb_(progress_of(std::span{&worker, 1}));
+        worker.last_progress_time = now;
+    }
+}
+
+void Traversal::count_node(const Game& game, Worker& worker) const {
+    const auto depth = game.get_move_sequence().size() - root_length_;
+    auto& counters = worker.counters;
+    ++counters.nodes;
+    if (counters.depths.size() <= depth) counters.depths.resize(depth + 1);
+    ++counters.depths[depth];
+    if (worker.breakdown) worker.breakdown->record_position(depth, game.position_key());
+}
+
+void Traversal::count_inner_node(Worker& worker, std::size_t move_count) const {
+    ++worker.counters.inner_nodes;
+    worker.counters.children += move_count;
+}
+
+void Traversal::publish(Worker& worker) const {
+    worker.published_games.store(worker.stats.games, std::memory_order_relaxed);
+    worker.published_nodes.store(worker.counters.nodes, std::memory_order_relaxed);
+    worker.published_inner_nodes.store(worker.counters.inner_nodes, std::memory_order_relaxed);
+    worker.published_children.store(worker.counters.children, std::memory_order_relaxed);
+    if constexpr (instrumentation::enabled) {
+        if (threads_ > 1 && worker.stats.games - worker.instrumentation_games >= INSTRUMENTATION_PUBLISH_INTERVAL) {
+            snapshot_instrumentation(worker);
+        }
+    }
+}
+
+void Traversal::snapshot_instrumentation(Worker& worker) const {
+    if constexpr (instrumentation::enabled) {
+        const auto counts = instrumentation::local() - worker.instrumentation_start;
+        const std::lock_guard lock(worker.instrumentation_mutex);
+        worker.instrumentation = counts;
+        worker.instrumentation_games = worker.stats.games;
+    }
+}
+
+Traversal::ProgressEvent Traversal::progress_of(std::span<Worker> workers) const {
+    ProgressEvent event{.games = 0};
+    for (auto& worker : workers) {
+        event.games += worker.published_games.load(std::memory_order_relaxed);
+        event.nodes += worker.published_nodes.load(std::memory_order_relaxed);
+        event.inner_nodes += worker.published_inner_nodes.load(std::memory_order_relaxed);
+        event.children += worker.published_children.load(std::memory_order_relaxed);
+        if constexpr (instrumentation::enabled) {
+            const std::lock_guard lock(worker.instrumentation_mutex);
+            event.counters.merge(worker.instrumentation);
+        }
+    }
+    event.elapsed = std::chrono::steady_clock::now() - start_time_;
+    return event;
+}
+
+bool Traversal::timed_out() const noexcept { return deadline_ && std::chrono::steady_clock::now() >= *deadline_; }
+
+bool Traversal::claim_node(Worker& worker) {
+    if (!max_nodes_) return true;
+    if (worker.node_budget == 0) {
+        // A serial traversal takes the whole limit at once
+        auto left = nodes_left_.load(std::memory_order_relaxed);
+        std::uint64_t chunk = 0;
+        do {
+            chunk = threads_ > 1 ? std::min(left, NODE_BUDGET_CHUNK) : left;
+        } while (chunk > 0 && !nodes_left_.compare_exchange_weak(left, left - chunk, std::memory_order_relaxed));
+        if (chunk == 0) {
+            worker.out_of_nodes = true;
+            return false;
+        }
+        worker.node_budget = chunk;
+    }
+    --worker.node_budget;
+    return true;
+}
+
+std::optional<PieceColor> Traversal::record_result(const Game& game, Worker& worker) {
+    const auto is_looping = game.is_looping();
+    const auto winner = game.player() == PieceColor::BLACK ? PieceColor::WHITE : PieceColor::BLACK;
+    const auto outcome = is_looping ? std::nullopt : std::make_optional(winner);
+    record_outcome(game, worker, outcome, is_looping);
+    return outcome;
+}
+
+void Traversal::record_outcome(const Game& game, Worker& worker, std::optional<PieceColor> outcome, bool looping) {
+    worker.stats.record(outcome, game.get_move_sequence().size());
+    publish(worker);
+
+    if (worker.breakdown) {
+        const std::span<const std::uint8_t> sequence = game.get_move_sequence();
+        worker.breakdown->record_game(sequence.subspan(root_length_), outcome, sequence.size());
+        if (worker.breakdown->games() >= TraversalBreakdown::MERGE_INTERVAL) merge_breakdown(worker);
+    }
+
+    if (result_sink_) {
+        const auto& sequence = game.get_move_sequence();
+        worker.records.push_back(ResultRecord{
+            .length = static_cast<std::uint32_t>(sequence.size()),
+            .history_offset = static_cast<std::uint32_t>(worker.histories.size()),
+            .winner = outcome,
+            .looping = looping,
+        });
+        if (record_histories_) worker.histories.insert(worker.histories.end(), sequence.begin(), sequence.end());
+        if (worker.records.size() >= result_batch_size_ || worker.histories.size() >= HISTORY_ARENA_BYTES) {
+            flush_results(worker);
+        }
+    }
+
+    // Emit progress every 2 seconds (the parallel driver reports progress itself)
+    if (threads_ == 1) emit_progress_if_needed(worker);
+}
+
+std::optional<std::optional<PieceColor>> Traversal::probe_tablebase(const Game& game, Worker& worker) {
+    if (!tablebase_) return std::nullopt;
+    std::optional<Tablebase::Value> value;
+    {
+        const instrumentation::ScopedPhase phase(instrumentation::Phase::PROBE);
+        value = tablebase_->probe(game.board(), game.player());
+    }
+    if (!value) return std::nullopt;
+
+    const auto opponent = game.player() == PieceColor::BLACK ? PieceColor::WHITE : PieceColor::BLACK;
+    std::optional<PieceColor> outcome;
+    if (*value == Tablebase::Value::WIN) outcome = game.player();
+    if (*value == Tablebase::Value::LOSS) outcome = opponent;
+    ++worker.tb_hits;
+    record_outcome(game, worker, outcome, false);
+    return outcome;
+}
+
+void Traversal::prepare_results(Worker& worker, std::size_t id) const {
+    worker.id = id;
+    if (!result_sink_) return;
+    worker.records.reserve(result_batch_size_);
+    if (record_histories_) worker.histories.reserve(HISTORY_ARENA_BYTES);
+}
+
+void Traversal::merge_breakdown(Worker& worker) {
+    if (!worker.breakdown) return;
+    const std::lock_guard lock(breakdown_mutex_);
+    breakdown_.merge(*worker.breakdown);
+    worker.breakdown->clear();
+}
+
+void Traversal::flush_results(Worker& worker) {
+    if (worker.records.empty()) return;
+    const instrumentation::ScopedPhase phase(instrumentation::Phase::RESULTS);
+    result_sink_(ResultBatch{.worker = worker.id, .records = worker.records, .histories = worker.histories});
+    worker.records.clear();
+    worker.histories.clear();
+}
+
+bool Traversal::enter_node(Game& game, Worker& worker, std::vector<Frame>& stack, Statistics& finished) {
+    count_node(game, worker);
+    // A horizon node only needs to know whether it has moves, not the moves themselves
+    const bool horizon = max_depth_ && game.get_move_sequence().size() - root_length_ >= *max_depth_;
+    const std::size_t move_count = horizon ? game.count_moves() : game.move_count();
     if (move_count == 0) {
         // Game is over - emit result
-        ++game_count;
-        const auto is_looping = game.is_looping();
-        const auto winner = game.player() == PieceColor::BLACK ? PieceColor::WHITE : PieceColor::BLACK;
-        ResultEvent ev{
-            .game_id = game_count,
-            .looping = is_looping,
-            .winner = is_looping ? std::nullopt : std::make_optional(winner),
-            .history = game.get_move_sequence(),
-        };
-        // Invoke result callback
-        if (result_cb_) result_cb_(ev);
-
-        // Emit progress every 2 seconds
-        emit_progress_if_needed();
-
-        // No need to undo here - backtracking will handle it
+        finished.record(record_result(game, worker), 0);
+        return false;
+    }
+    if (horizon) {
+        ++worker.horizon_leaves;
+        return false;
+    }
+
+    Frame frame{.next = 0,
+                .count = static_cast<std::uint8_t>(move_count),
+                .cacheable = false,
+                .mirrored = false,
+                .key = 0,
+                .subtree = {}};
+    if (caching()) {
+        if (const auto outcome = probe_tablebase(game, worker)) {
+            finished.record(*outcome, 0);
+            return false;
+        }
+
+        // With repetition counts in play a cached subtree may not apply (see TranspositionMode::EXACT)
+        frame.cacheable = game.after_irreversible_move();
+        if (frame.cacheable) {
+            key_frame(game, frame);
+            auto merge_known = [&](const Statistics& known, std::size_t& hits) {
+                worker.stats.merge(known, game.get_move_sequence().size());
+                publish(worker);
+                ++hits;
+                if (threads_ == 1) emit_progress_if_needed(worker);
+                finished = known;
+                return false;
+            };
+            std::optional<Statistics> known;
+            std::size_t* hits = nullptr;
+            {
+                const instrumentation::ScopedPhase phase(instrumentation::Phase::PROBE);
+                if (database_) {
+                    known = database_->find(game.board(), game.player());
+                    hits = &worker.db_hits;
+                }
+                if (!known && tt_) {
+                    known = tt_->probe(frame.key);
+                    if (known && frame.mirrored) known = known->mirrored();
+                    hits = &worker.tt_hits;
+                }
+            }
+            if (known) return merge_known(*known, *hits);
+        }
+    }
+    count_inner_node(worker, move_count);
+    stack.push_back(frame);
+    return true;
+}
+
+void Traversal::key_frame(const Game& game, Frame& frame) const noexcept {
+    if (!canonical_keys_) {
+        frame.key = game.position_key();
         return;
     }
+    // White-to-move keys carry no side-to-move term, so the mirrored board's own key is enough
+    const auto [board, mirrored] = game.board().canonical(game.player());
+    frame.key = board.zobrist();
+    frame.mirrored = mirrored;
+}
+
+void Traversal::finish_node(const Game& game, Worker& worker, const Frame& frame) {
+    // Frames only finish once every child is done; a subtree cut short by the deadline stays open
+    if (!frame.cacheable) return;
+    if (tt_) tt_->store(frame.key, frame.mirrored ? frame.subtree.mirrored() : frame.subtree);
+    if (subtree_sink_) {
+        subtree_sink_(
+            SubtreeResult{.board = game.board(), .player = game.player(), .stats = frame.subtree, .worker = worker.id});
+    }
+}
+
+bool Traversal::traverse_subtree(Game& game, Worker& worker, std::vector<Frame>& stack) {
+    if (stack.empty()) {
+        Statistics root;
+        if (stopped(worker) || !claim_node(worker)) return false;
+        if (!enter_node(game, worker, stack, root)) return true;
+    }
+
+    // Depth first over an explicit stack, so lines of any length fit; the game is at the top frame's node
+    std::size_t since_checkpoint = 0;
+    while (!stack.empty()) {
+        if (checkpoint_path_ && ++since_checkpoint == CHECKPOINT_CHECK_INTERVAL) {
+            since_checkpoint = 0;
+            save_checkpoint_if_needed(worker, stack);
+        }
+
+        auto& frame = stack.back();
+        if (frame.next == frame.count) {
+            finish_node(game, worker, frame);
+            const auto subtree = frame.subtree;
+            stack.pop_back();
+            if (stack.empty()) break;
+            {
+                const instrumentation::ScopedPhase phase(instrumentation::Phase::MAKE_UNMAKE);
+                game.undo_move();
+            }
+            stack.back().subtree.merge(subtree, 1);
+            if (stopped(worker)) break;
+            continue;
+        }
+
+        if (!claim_node(worker)) break;
+        {
+            const instrumentation::ScopedPhase phase(instrumentation::Phase::MAKE_UNMAKE);
+            game.select_move(frame.next++);
+        }
+        Statistics finished;
+        if (!enter_node(game, worker, stack, finished)) {
+            const instrumentation::ScopedPhase phase(instrumentation::Phase::MAKE_UNMAKE);
+            game.undo_move();
+            stack.back().subtree.merge(finished, 1);
+        }
+        // Checked after the step, so every call makes progress however short the timeout
+        if (stopped(worker)) break;
+    }
+
+    // Back to the subtree root when the deadline stopped the traversal; the stack keeps the frontier
+    for (std::size_t depth = stack.size(); depth > 1; --depth) game.undo_move();
+    return stack.empty();
+}
+
+void Traversal::set_transposition_table(TranspositionMode mode, std::size_t size_mb) {
+    canonical_keys_ = mode == TranspositionMode::CANONICAL;
+    if (mode == TranspositionMode::OFF) {
+        tt_.reset();
+    } else {
+        tt_ = std::make_unique<TranspositionTable>(size_mb);
+    }
+}
+
+void Traversal::traverse_parallel(Game& game) {
+    const auto root_length = game.get_move_sequence().size();
+    std::vector<Worker> workers(threads_);
+    if (breakdown_depth_) {
+        for (auto& worker : workers) worker.breakdown = breakdown_.empty_copy();
+    }
+    std::vector<TaskDeque> deques(threads_);
+
+    // Tasks queued or running; a task counts its children in before it finishes
+    std::atomic<std::size_t> pending{1};
+    deques[0].push(TaskPath{});
+
+    // An exception must not escape a worker thread (std::terminate); the first one stops the others
+    failed_.store(false, std::memory_order_relaxed);
+    failure_ = nullptr;
+    const auto fail = [&] {
+        const std::lock_guard lock(failure_mutex_);
+        if (!failure_) failure_ = std::current_exception();
+        failed_.store(true, std::memory_order_relaxed);
+    };
+
+    auto run = [&](std::size_t id) {
+        Game local = Game::copy(game);
+        auto& worker = workers[id];
+        worker.instrumentation_start = instrumentation::local();
+        prepare_results(worker, id);
+        while (pending.load(std::memory_order_acquire) != 0) {
+            auto task = deques[id].pop();
+            for (std::size_t k = 1; !task && k < threads_; ++k) task = deques[(id + k) % threads_].steal();
+            if (!task) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            try {
+                {
+                    const instrumentation::ScopedPhase phase(instrumentation::Phase::MAKE_UNMAKE);
+                    navigate(local, root_length, *task);
+                }
+                const auto depth = task->size();
+                if (depth >= split_depth_) {
+                    worker.stack.clear();
+                    if (!traverse_subtree(local, worker, worker.stack)) worker.cut_short = true;
+                } else if (stopped(worker) || !claim_node(worker)) {
+                    worker.cut_short = true;
+                } else {
+                    count_node(local, worker);
+                    const bool horizon = max_depth_ && depth >= *max_depth_;
+                    const auto move_count = horizon ? local.count_moves() : local.move_count();
+                    if (move_count == 0) {
+                        record_result(local, worker);
+                    } else if (horizon) {
+                        ++worker.horizon_leaves;
+                    } else if (!probe_tablebase(local, worker)) {
+                        count_inner_node(worker, move_count);
+                        publish(worker);
+                        pending.fetch_add(move_count, std::memory_order_relaxed);
+                        // Reverse order so the owner pops the first child first
+                        for (auto i = move_count; i-- > 0;) {
+                            auto child = *task;
+                            child.push_back(static_cast<std::uint8_t>(i));
+                            deques[id].push(std::move(child));
+                        }
+                    }
+                }
+            } catch (...) {
+                fail();
+                worker.cut_short = true;
+            }
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        try {
+            flush_results(worker);
+        } catch (...) {
+            fail();
+        }
+        merge_breakdown(worker);
+        snapshot_instrumentation(worker);
+    };
+
+    std::vector<std::jthread> pool;
+    pool.reserve(threads_);
+    for (std::size_t id = 0; id < threads_; ++id) pool.emplace_back(run, id);
+
+    // The calling thread only reports progress from the per-worker published counters
+    auto last_progress_time = std::chrono::steady_clock::now();
+    while (pending.load(std::memory_order_acquire) != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const auto now = std::chrono::steady_clock::now();
+        if (progress_cb_ && now - last_progress_time >= std::chrono::milliseconds(2000)) {
+            progress_cb_(progress_of(workers));
+            last_progress_time = now;
+        }
+    }
+    pool.clear();
+    if (failure_) std::rethrow_exception(std::exchange(failure_, nullptr));
 
-    for (std::size_t i = 0; i < move_count; ++i) {
-        game.select_move(i);
-        traverse_impl(game, depth + 1); // Pass incremented depth
-        game.undo_move();               // Backtrack after exploring this branch
+    for (const auto& worker : workers) {
+        stats_.merge(worker.stats);
+        node_counters_.merge(worker.counters);
+        instrumentation_.merge(worker.instrumentation);
+        tt_hits_ += worker.tt_hits;
+        db_hits_ += worker.db_hits;
+        tb_hits_ += worker.tb_hits;
+        horizon_leaves_ += worker.horizon_leaves;
     }
+    // Decided by what the workers left unfinished, not by the clock after the join: a run whose last
+    // task finished just before the deadline is complete
+    completed_ = std::ranges::none_of(workers, &Worker::cut_short);
 }
 
 void Traversal::traverse_for(Game& game, std::optional<std::chrono::milliseconds> timeout) {
+    run(game, timeout, nullptr);
+}
+
+void Traversal::resume_for(Game& game, const Checkpoint& checkpoint, std::optional<std::chrono::milliseconds> timeout) {
+    if (!checkpoint.matches(game.board(), game.player(), game.get_move_sequence().size())) {
+        throw std::invalid_argument("The checkpoint was taken at a different root position");
+    }
+    // Continuing a frontier under another limit would mix horizon-cut subtrees with whole ones
+    if (checkpoint.max_depth != max_depth_) {
+        throw std::invalid_argument("The checkpoint was taken with a different depth limit");
+    }
+    run(game, timeout, &checkpoint);
+}
+
+void Traversal::set_checkpoint(std::string path, std::chrono::milliseconds interval) {
+    checkpoint_path_ = std::move(path);
+    checkpoint_interval_ = interval;
+}
+
+Checkpoint Traversal::make_checkpoint(const Worker& worker, const std::vector<Frame>& stack) const {
+    Checkpoint checkpoint{
+        .occ = root_board_.occ_bits(),
+        .black = root_board_.black_bits() & root_board_.occ_bits(),
+        .dame = root_board_.dame_bits() & root_board_.occ_bits(),
+        .side = root_player_,
+        .root_length = root_length_,
+        .max_depth = max_depth_,
+        .stats = worker.stats,
+        .transposition_hits = worker.tt_hits,
+        .database_hits = worker.db_hits,
+        .tablebase_hits = worker.tb_hits,
+        .horizon_leaves = worker.horizon_leaves,
+        .path = {},
+        .next = {},
+        .subtrees = {},
+    };
+    // Each open node above the deepest one is exploring the child before its next one
+    checkpoint.next.reserve(stack.size());
+    for (const auto& frame : stack) checkpoint.next.push_back(frame.next);
+    for (std::size_t depth = 0; depth + 1 < stack.size(); ++depth) {
+        checkpoint.path.push_back(static_cast<std::uint8_t>(stack[depth].next - 1));
+    }
+    if (caching()) {
+        checkpoint.subtrees.reserve(stack.size());
+        for (const auto& frame : stack) checkpoint.subtrees.push_back(frame.subtree);
+    }
+    return checkpoint;
+}
+
+void Traversal::save_checkpoint_if_needed(Worker& worker, const std::vector<Frame>& stack) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_checkpoint_time_ < checkpoint_interval_) return;
+    // Results up to the checkpoint are delivered before it is written, so none repeat after a resume
+    flush_results(worker);
+    // A failed save (a full disk, say) must not throw away the traversal so far; the next interval retries
+    try {
+        make_checkpoint(worker, stack).save(*checkpoint_path_);
+    } catch (const std::runtime_error& e) {
+        ++checkpoint_failures_;
+        checkpoint_error_ = e.what();
+    }
+    last_checkpoint_time_ = now;
+}
+
+void Traversal::restore(Game& game, Worker& worker, const Checkpoint& checkpoint) {
+    worker.stats = checkpoint.stats;
+    publish(worker);
+    worker.tt_hits = checkpoint.transposition_hits;
+    worker.db_hits = checkpoint.database_hits;
+    worker.tb_hits = checkpoint.tablebase_hits;
+    worker.horizon_leaves = checkpoint.horizon_leaves;
+
+    // Replay the path, rebuilding every open node's frame
+    const bool has_subtrees = checkpoint.subtrees.size() == checkpoint.next.size();
+    for (std::size_t depth = 0; depth < checkpoint.next.size(); ++depth) {
+        if (depth > 0) game.select_move(checkpoint.path[depth - 1]);
+        const auto move_count = game.move_count();
+        if (checkpoint.next[depth] > move_count) {
+            throw std::invalid_argument("The checkpoint frontier does not match the game tree");
+        }
+        auto& frame = worker.stack.emplace_back(Frame{
+            .next = checkpoint.next[depth],
+            .count = static_cast<std::uint8_t>(move_count),
+            // Without their partial statistics restored subtrees are finished but never reused
+            .cacheable = caching() && has_subtrees && game.after_irreversible_move(),
+            .mirrored = false,
+            .key = 0,
+            .subtree = has_subtrees ? checkpoint.subtrees[depth] : Statistics{},
+        });
+        key_frame(game, frame);
+    }
+}
+
+void Traversal::run(Game& game, std::optional<std::chrono::milliseconds> timeout, const Checkpoint* resume) {
+    if (threads_ > 1 && (checkpoint_path_ || resume)) {
+        throw std::invalid_argument("Checkpoints require a single-threaded traversal");
+    }
+    if (max_depth_ && (tt_ || database_ || subtree_sink_)) {
+        throw std::invalid_argument("A depth limit cannot be combined with cached or stored subtrees");
+    }
+    if (breakdown_depth_ && (tt_ || database_)) {
+        throw std::invalid_argument("A breakdown cannot be combined with cached subtrees, which are not played out");
+    }
+
     // Initialize
-    game_count = 0;
-    last_progress_time_ = std::chrono::steady_clock::now();
+    stats_ = Statistics{};
+    tt_hits_ = 0;
+    db_hits_ = 0;
+    tb_hits_ = 0;
+    horizon_leaves_ = 0;
+    checkpoint_failures_ = 0;
+    checkpoint_error_.clear();
+    nodes_left_.store(max_nodes_.value_or(0), std::memory_order_relaxed);
+    node_counters_ = NodeCounters{};
+    instrumentation_ = instrumentation::Counters{};
+    start_time_ = std::chrono::steady_clock::now();
+    root_board_ = game.board();
+    root_player_ = game.player();
+    root_length_ = game.get_move_sequence().size();
+    {
+        auto breakdown = breakdown_depth_ ? TraversalBreakdown(game, *breakdown_depth_) : TraversalBreakdown{};
+        const std::lock_guard lock(breakdown_mutex_);
+        breakdown_ = std::move(breakdown);
+    }
 
     // Set deadline if timeout is provided
     if (timeout) {
@@ -81,5 +610,37 @@ void Traversal::traverse_for(Game& game, std::optional<std::chrono::milliseconds
         deadline_ = std::nullopt;
     }
 
-    traverse_impl(game);
+    if (threads_ > 1) {
+        traverse_parallel(game);
+        return;
+    }
+
+    Worker worker;
+    if (breakdown_depth_) worker.breakdown = breakdown_.empty_copy();
+    worker.instrumentation_start = instrumentation::local();
+    worker.last_progress_time = std::chrono::steady_clock::now();
+    last_checkpoint_time_ = worker.last_progress_time;
+    prepare_results(worker, 0);
+    if (resume) {
+        restore(game, worker, *resume);
+    } else {
+        // The root is always entered (unless the node limit is 0), so the frontier is only empty once
+        // the tree is done
+        Statistics root;
+        if (claim_node(worker)) enter_node(game, worker, worker.stack, root);
+    }
+    if (!worker.stack.empty()) traverse_subtree(game, worker, worker.stack);
+    flush_results(worker);
+    merge_breakdown(worker);
+    // The stack still holds the frontier left by the deadline (empty once the tree is finished)
+    if (checkpoint_path_) make_checkpoint(worker, worker.stack).save(*checkpoint_path_);
+    completed_ = worker.stack.empty() && !worker.out_of_nodes;
+    stats_ = worker.stats;
+    node_counters_ = worker.counters;
+    snapshot_instrumentation(worker);
+    instrumentation_ = worker.instrumentation;
+    tt_hits_ = worker.tt_hits;
+    db_hits_ = worker.db_hits;
+    tb_hits_ = worker.tb_hits;
+    horizon_leaves_ = worker.horizon_leaves;
 }
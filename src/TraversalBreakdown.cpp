@@ -0,0 +1,115 @@
+#include "TraversalBreakdown.h"
+
+#include <cmath>
+#include <stdexcept>
+
+TraversalBreakdown::TraversalBreakdown(const Game& root, std::size_t prefix_depth) : prefix_depth_(prefix_depth) {
+    auto tree = std::make_shared<PrefixTree>();
+    tree->first_child.push_back(0);
+    tree->child_count.push_back(0);
+
+    // Depth first, giving each node's children one contiguous block
+    auto game = Game::copy(root);
+    const auto expand = [&](auto& self, std::size_t node, std::size_t depth) -> void {
+        if (depth == prefix_depth) return;
+        const auto count = game.move_count();
+        if (count == 0) return;
+        const auto first = tree->first_child.size();
+        if (first + count > MAX_PREFIXES) {
+            throw std::invalid_argument("The breakdown prefix depth gives too many prefixes");
+        }
+        tree->first_child[node] = static_cast<std::uint32_t>(first);
+        tree->child_count[node] = static_cast<std::uint8_t>(count);
+        tree->first_child.resize(first + count, 0);
+        tree->child_count.resize(first + count, 0);
+        for (std::size_t i = 0; i < count; ++i) {
+            game.select_move(i);
+            self(self, first + i, depth + 1);
+            game.undo_move();
+        }
+    };
+    expand(expand, 0, 0);
+
+    lengths_.assign(MAX_LENGTH + 1, {});
+    prefix_stats_.assign(tree->first_child.size(), TraversalStatistics{});
+    prefix_lengths_.assign(tree->first_child.size(), LengthHistogram{});
+    registers_.assign(SKETCH_DEPTHS * SKETCH_REGISTERS, 0);
+    tree_ = std::move(tree);
+}
+
+TraversalBreakdown TraversalBreakdown::empty_copy() const {
+    TraversalBreakdown copy = *this;
+    copy.clear();
+    return copy;
+}
+
+void TraversalBreakdown::merge(const TraversalBreakdown& other) noexcept {
+    games_ += other.games_;
+    for (std::size_t length = 0; length < lengths_.size() && length < other.lengths_.size(); ++length) {
+        for (std::size_t outcome = 0; outcome < OUTCOMES; ++outcome) {
+            lengths_[length][outcome] += other.lengths_[length][outcome];
+        }
+    }
+    for (std::size_t node = 0; node < prefix_stats_.size() && node < other.prefix_stats_.size(); ++node) {
+        prefix_stats_[node].merge(other.prefix_stats_[node]);
+        for (std::size_t bucket = 0; bucket < LENGTH_BUCKETS; ++bucket) {
+            prefix_lengths_[node][bucket] += other.prefix_lengths_[node][bucket];
+        }
+    }
+    for (std::size_t i = 0; i < registers_.size() && i < other.registers_.size(); ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+void TraversalBreakdown::clear() noexcept {
+    games_ = 0;
+    std::ranges::fill(lengths_, std::array<std::uint64_t, OUTCOMES>{});
+    std::ranges::fill(prefix_stats_, TraversalStatistics{});
+    std::ranges::fill(prefix_lengths_, LengthHistogram{});
+    std::ranges::fill(registers_, std::uint8_t{0});
+}
+
+std::vector<TraversalBreakdown::Prefix> TraversalBreakdown::prefixes() const {
+    std::vector<Prefix> out;
+    if (!tree_) return out;
+    std::vector<std::uint8_t> moves;
+    const auto collect = [&](auto& self, std::size_t node) -> void {
+        const auto count = tree_->child_count[node];
+        if (count == 0) {
+            out.push_back(Prefix{.moves = moves, .stats = prefix_stats_[node], .lengths = prefix_lengths_[node]});
+            return;
+        }
+        for (std::uint8_t i = 0; i < count; ++i) {
+            moves.push_back(i);
+            self(self, tree_->first_child[node] + i);
+            moves.pop_back();
+        }
+    };
+    collect(collect, 0);
+    return out;
+}
+
+double TraversalBreakdown::distinct_positions(std::size_t depth) const noexcept {
+    if (depth >= SKETCH_DEPTHS || registers_.empty()) return 0.0;
+    const auto m = static_cast<double>(SKETCH_REGISTERS);
+    double sum = 0.0;
+    std::size_t zeros = 0;
+    for (std::size_t i = 0; i < SKETCH_REGISTERS; ++i) {
+        const auto reg = registers_[depth * SKETCH_REGISTERS + i];
+        sum += std::ldexp(1.0, -static_cast<int>(reg));
+        if (reg == 0) ++zeros;
+    }
+    if (zeros == SKETCH_REGISTERS) return 0.0;
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    const double estimate = alpha * m * m / sum;
+    // Small ranges: linear counting over the empty registers is more accurate
+    if (estimate <= 2.5 * m && zeros > 0) return m * std::log(m / static_cast<double>(zeros));
+    return estimate;
+}
+
+std::size_t TraversalBreakdown::memory_bytes() const noexcept {
+    std::size_t bytes = lengths_.size() * sizeof(lengths_[0]) + prefix_stats_.size() * sizeof(TraversalStatistics) +
+                        prefix_lengths_.size() * sizeof(LengthHistogram) + registers_.size();
+    if (tree_) bytes += tree_->first_child.size() * (sizeof(std::uint32_t) + sizeof(std::uint8_t));
+    return bytes;
+}
@@ -0,0 +1,301 @@
+#include "WorkQueue.h"
+#include "Traversal.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr const char* PENDING = "pending";
+constexpr const char* CLAIMED = "claimed";
+constexpr const char* DONE = "done";
+
+// Statistics as fixed-width words: games, black wins, white wins, draws, min length, max length
+using StatisticsWords = std::array<std::uint64_t, 6>;
+
+using File = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+[[nodiscard]] std::vector<std::uint8_t> read_file(const fs::path& path) {
+    const File file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot open '" + path.string() + "'");
+    std::vector<std::uint8_t> bytes;
+    std::array<std::uint8_t, 256> buffer{};
+    while (const auto read = std::fread(buffer.data(), 1, buffer.size(), file.get())) {
+        bytes.insert(bytes.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(read));
+    }
+    if (std::ferror(file.get()) != 0) throw std::runtime_error("Cannot read '" + path.string() + "'");
+    return bytes;
+}
+
+// Writes a temporary file next to the target and renames it over the target
+void write_file(const fs::path& path, const void* data, std::size_t size) {
+    // Unique per writer, so two workers finishing the same unit never share a temporary file
+    static thread_local std::mt19937_64 rng{std::random_device{}()};
+    const auto temporary = path.parent_path() / std::format(".{}.{:016x}.tmp", path.filename().string(), rng());
+    {
+        const File file(std::fopen(temporary.c_str(), "wb"), &std::fclose);
+        if (!file) throw std::runtime_error("Cannot create '" + temporary.string() + "'");
+        if ((size != 0 && std::fwrite(data, 1, size, file.get()) != size) || std::fflush(file.get()) != 0) {
+            throw std::runtime_error("Cannot write '" + temporary.string() + "'");
+        }
+    }
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) throw std::runtime_error("Cannot replace '" + path.string() + "': " + error.message());
+}
+
+// Unit ids of the files in a state directory (temporary files start with a dot)
+[[nodiscard]] std::vector<std::uint64_t> unit_ids(const fs::path& directory) {
+    std::vector<std::uint64_t> ids;
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        const auto name = entry.path().filename().string();
+        if (name.empty() || name.front() == '.') continue;
+        ids.push_back(std::stoull(name));
+    }
+    return ids;
+}
+
+[[nodiscard]] std::size_t count_units(const fs::path& directory) {
+    std::size_t count = 0;
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        const auto name = entry.path().filename().string();
+        if (!name.empty() && name.front() != '.') ++count;
+    }
+    return count;
+}
+
+void collect_prefixes(Game& game, std::size_t depth, std::vector<std::uint8_t>& prefix,
+                      std::vector<std::vector<std::uint8_t>>& out) {
+    const auto move_count = game.move_count();
+    if (depth == 0 || move_count == 0) {
+        out.push_back(prefix);
+        return;
+    }
+    for (std::size_t i = 0; i < move_count; ++i) {
+        game.select_move(i);
+        prefix.push_back(static_cast<std::uint8_t>(i));
+        collect_prefixes(game, depth - 1, prefix, out);
+        prefix.pop_back();
+        game.undo_move();
+    }
+}
+} // namespace
+
+std::vector<std::vector<std::uint8_t>> WorkQueue::prefixes(Game& game, std::size_t depth) {
+    std::vector<std::vector<std::uint8_t>> out;
+    std::vector<std::uint8_t> prefix;
+    collect_prefixes(game, depth, prefix, out);
+    return out;
+}
+
+WorkQueue::WorkQueue(fs::path directory, const Manifest& manifest)
+    : directory_(std::move(directory)), depth_(manifest.depth), units_(manifest.units) {
+    root_.set_from_masks(manifest.occ, manifest.black, manifest.dame);
+}
+
+WorkQueue WorkQueue::create(const std::string& directory, Game& game, std::size_t depth) {
+    if (!game.get_move_sequence().empty()) {
+        throw std::invalid_argument("A work queue starts at the beginning of a game");
+    }
+    const auto& board = game.board();
+    const auto occ = board.occ_bits();
+    const fs::path root(directory);
+    if (fs::exists(root / "manifest")) {
+        auto queue = open(directory);
+        if (queue.root_.occ_bits() != occ || queue.root_.black_bits() != (board.black_bits() & occ) ||
+            queue.root_.dame_bits() != (board.dame_bits() & occ) || queue.depth_ != depth) {
+            throw std::runtime_error("'" + directory + "' holds a work queue for another root or depth");
+        }
+        return queue;
+    }
+
+    std::error_code error;
+    for (const auto* state : {PENDING, CLAIMED, DONE}) {
+        fs::create_directories(root / state, error);
+        if (error) throw std::runtime_error("Cannot create '" + (root / state).string() + "': " + error.message());
+    }
+
+    const auto units = prefixes(game, depth);
+    const Manifest manifest{
+        .magic = MAGIC,
+        .version = VERSION,
+        .occ = occ,
+        .black = board.black_bits() & occ,
+        .dame = board.dame_bits() & occ,
+        .depth = static_cast<std::uint32_t>(depth),
+        .reserved = 0,
+        .units = units.size(),
+    };
+    WorkQueue queue(root, manifest);
+    for (std::size_t id = 0; id < units.size(); ++id) {
+        write_file(queue.unit_path(PENDING, id), units[id].data(), units[id].size());
+    }
+    // Written last: a directory without a manifest is never worked on, so an interrupted create starts over
+    write_file(root / "manifest", &manifest, sizeof(manifest));
+    return queue;
+}
+
+WorkQueue WorkQueue::open(const std::string& directory) {
+    const fs::path root(directory);
+    const auto bytes = read_file(root / "manifest");
+    Manifest manifest{};
+    if (bytes.size() == sizeof(manifest)) std::memcpy(&manifest, bytes.data(), sizeof(manifest));
+    if (bytes.size() != sizeof(manifest) || manifest.magic != MAGIC || manifest.version != VERSION) {
+        throw std::runtime_error("'" + directory + "' is not a version " + std::to_string(VERSION) + " work queue");
+    }
+    return WorkQueue(root, manifest);
+}
+
+Game WorkQueue::root() const { return Game(root_); }
+
+fs::path WorkQueue::unit_path(const char* state, std::uint64_t id) const {
+    return directory_ / state / std::format("{:09}", id);
+}
+
+std::optional<WorkQueue::Unit> WorkQueue::claim() const {
+    for (const auto id : unit_ids(directory_ / PENDING)) {
+        // Only one of the workers racing for a unit wins the rename
+        std::error_code error;
+        fs::rename(unit_path(PENDING, id), unit_path(CLAIMED, id), error);
+        if (error) continue;
+
+        // Finished by a worker whose lease had expired
+        if (fs::exists(unit_path(DONE, id))) {
+            fs::remove(unit_path(CLAIMED, id), error);
+            continue;
+        }
+        renew(Unit{.id = id, .prefix = {}});
+        return Unit{.id = id, .prefix = read_file(unit_path(CLAIMED, id))};
+    }
+    return std::nullopt;
+}
+
+void WorkQueue::renew(const Unit& unit) const {
+    // The unit may have been requeued meanwhile; its result still counts when it is completed
+    std::error_code error;
+    fs::last_write_time(unit_path(CLAIMED, unit.id), fs::file_time_type::clock::now(), error);
+}
+
+void WorkQueue::release(const Unit& unit) const {
+    std::error_code error;
+    fs::rename(unit_path(CLAIMED, unit.id), unit_path(PENDING, unit.id), error);
+}
+
+void WorkQueue::complete(const Unit& unit, const TraversalStatistics& stats) const {
+    const StatisticsWords words = {stats.games,      stats.black_wins, stats.white_wins,
+                                   stats.draws,      stats.min_length, stats.max_length};
+    write_file(unit_path(DONE, unit.id), words.data(), sizeof(words));
+    std::error_code error;
+    fs::remove(unit_path(CLAIMED, unit.id), error);
+}
+
+std::size_t WorkQueue::requeue_expired(std::chrono::milliseconds lease) const {
+    const auto now = fs::file_time_type::clock::now();
+    std::size_t requeued = 0;
+    for (const auto id : unit_ids(directory_ / CLAIMED)) {
+        std::error_code error;
+        const auto touched = fs::last_write_time(unit_path(CLAIMED, id), error);
+        if (error || now - touched < lease) continue;
+        fs::rename(unit_path(CLAIMED, id), unit_path(PENDING, id), error);
+        if (!error) ++requeued;
+    }
+    return requeued;
+}
+
+WorkQueue::Status WorkQueue::status() const {
+    return Status{
+        .pending = count_units(directory_ / PENDING),
+        .claimed = count_units(directory_ / CLAIMED),
+        .done = count_units(directory_ / DONE),
+        .total = units_,
+    };
+}
+
+TraversalStatistics WorkQueue::results() const {
+    TraversalStatistics merged;
+    for (const auto id : unit_ids(directory_ / DONE)) {
+        const auto bytes = read_file(unit_path(DONE, id));
+        StatisticsWords words{};
+        if (bytes.size() != sizeof(words)) {
+            throw std::runtime_error("Result '" + unit_path(DONE, id).string() + "' is corrupt");
+        }
+        std::memcpy(words.data(), bytes.data(), sizeof(words));
+        merged.merge(TraversalStatistics{.games = words[0],
+                                         .black_wins = words[1],
+                                         .white_wins = words[2],
+                                         .draws = words[3],
+                                         .min_length = static_cast<std::size_t>(words[4]),
+                                         .max_length = static_cast<std::size_t>(words[5])});
+    }
+    return merged;
+}
+
+std::size_t work_through(const WorkQueue& queue, Traversal& traversal, std::chrono::milliseconds lease,
+                         std::optional<std::chrono::steady_clock::time_point> deadline) {
+    // Unit in progress, renewed in the background while the traversal runs
+    std::mutex mutex;
+    std::condition_variable_any wake;
+    std::optional<WorkQueue::Unit> current;
+    std::jthread heartbeat([&](std::stop_token stop) {
+        std::unique_lock lock(mutex);
+        while (!stop.stop_requested()) {
+            wake.wait_for(lock, stop, lease / 3, [] { return false; });
+            if (current && !stop.stop_requested()) queue.renew(*current);
+        }
+    });
+
+    auto expired = [&] { return deadline && std::chrono::steady_clock::now() >= *deadline; };
+    std::size_t completed = 0;
+    while (!expired()) {
+        auto unit = queue.claim();
+        if (!unit) {
+            // Nothing pending: take over units of dead workers, or wait for the live ones to finish
+            if (queue.requeue_expired(lease) != 0) continue;
+            if (queue.status().finished()) break;
+            std::this_thread::sleep_for(std::min<std::chrono::milliseconds>(lease / 3, std::chrono::seconds(1)));
+            continue;
+        }
+
+        Game game = queue.root();
+        for (const auto index : unit->prefix) {
+            if (index >= game.move_count()) {
+                throw std::runtime_error(std::format("Work unit {} does not fit the game tree", unit->id));
+            }
+            game.select_move(index);
+        }
+        {
+            const std::lock_guard lock(mutex);
+            current = *unit;
+        }
+
+        std::optional<std::chrono::milliseconds> timeout;
+        if (deadline) {
+            timeout = std::chrono::duration_cast<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+            timeout = std::max(*timeout, std::chrono::milliseconds(0));
+        }
+        traversal.traverse_for(game, timeout);
+
+        {
+            const std::lock_guard lock(mutex);
+            current.reset();
+        }
+        if (traversal.completed()) {
+            queue.complete(*unit, traversal.statistics());
+            ++completed;
+        } else {
+            queue.release(*unit);
+        }
+    }
+    return completed;
+}
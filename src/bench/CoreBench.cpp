@@ -0,0 +1,224 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BoardBatch.h"
+#include "BoardFormat.h"
+#include "Explorer.h"
+#include "Game.h"
+#include "Perft.h"
+#include "Playout.h"
+
+namespace {
+struct Curated {
+    std::string name;
+    std::vector<std::uint8_t> moves; // from the start position
+};
+
+// Replays a line from the start position
+Game replay(const Curated& position) {
+    Game game;
+    for (const auto index : position.moves) game.select_move(index);
+    return game;
+}
+
+/**
+ * Positions of fixed-seed random games, so they are the same in every build:
+ * - opening: the start position
+ * - midgame: ply 20 of the first game still holding at least 14 pieces there
+ * - endgame: the position with dames on the board and the longest capture found in 2000 games
+ */
+std::vector<Curated> curated_positions() {
+    std::vector<Curated> positions{{"opening", {}}};
+
+    std::vector<std::uint8_t> midgame;
+    std::vector<std::uint8_t> endgame;
+    std::size_t longest_capture = 0;
+    for (std::uint64_t seed = 0; seed < 2000; ++seed) {
+        playout::Random random(seed);
+        Game game;
+        std::vector<std::uint8_t> line;
+        while (game.move_count() > 0 && line.size() < 300) {
+            const auto choices = game.choices();
+            if (line.size() == 20 && midgame.empty() && std::popcount(game.board().occ_bits()) >= 14) midgame = line;
+            if (game.board().dame_bits() != 0u && choices.front().is_capture() &&
+                choices.front().capture_count() > longest_capture) {
+                longest_capture = choices.front().capture_count();
+                endgame = line;
+            }
+            line.push_back(static_cast<std::uint8_t>(random.below(choices.size())));
+            game.select_move(line.back());
+        }
+    }
+    positions.push_back({"midgame", midgame});
+    positions.push_back({"dame endgame, " + std::to_string(longest_capture) + "-piece capture", endgame});
+    return positions;
+}
+} // namespace
+
+TEST_CASE("Board hashing", "[benchmark][board]") {
+    std::vector<Board> boards;
+    for (const auto& position : curated_positions()) boards.push_back(replay(position).board());
+    std::vector<std::size_t> hashes;
+    for (const auto& board : boards) hashes.push_back(board.hash());
+
+    BENCHMARK("Board::hash, " + std::to_string(boards.size()) + " boards") {
+        std::size_t sum = 0;
+        for (const auto& board : boards) sum += board.hash();
+        return sum;
+    };
+
+    BENCHMARK("Board::from_hash, " + std::to_string(hashes.size()) + " boards") {
+        std::uint32_t sum = 0;
+        for (const auto hash : hashes) sum += Board::from_hash(hash).occ_bits();
+        return sum;
+    };
+}
+
+TEST_CASE("Bulk position formats", "[benchmark][board]") {
+    std::vector<board_format::Entry> entries;
+    for (std::uint64_t seed = 0; seed < 64; ++seed) {
+        playout::Random random(seed);
+        Game game;
+        while (game.move_count() > 0) {
+            entries.push_back({game.board(), game.player()});
+            game.select_move(random.below(game.move_count()));
+        }
+    }
+    std::string text;
+    board_format::append_text(entries, text);
+    std::vector<std::uint8_t> packed(entries.size() * board_format::PACKED_SIZE);
+    std::vector<board_format::Entry> out(entries.size());
+    const auto count = std::to_string(entries.size());
+
+    BENCHMARK("board_format::append_text, " + count + " positions") {
+        std::string written;
+        board_format::append_text(entries, written);
+        return written.size();
+    };
+    BENCHMARK("board_format::parse_text, " + count + " positions") {
+        std::vector<board_format::Entry> parsed;
+        parsed.reserve(entries.size());
+        board_format::parse_text(text, parsed);
+        return parsed.size();
+    };
+    for (const auto kernel : {board_format::Kernel::SCALAR, board_format::Kernel::BMI2}) {
+        if (!board_format::supported(kernel)) continue;
+        const std::string name = kernel == board_format::Kernel::BMI2 ? "BMI2" : "scalar";
+        BENCHMARK("board_format::pack " + name + ", " + count + " positions") {
+            board_format::pack(entries, packed, kernel);
+            return packed.back();
+        };
+        BENCHMARK("board_format::unpack " + name + ", " + count + " positions") {
+            board_format::unpack(packed, out, kernel);
+            return out.back().board.occ_bits();
+        };
+    }
+}
+
+TEST_CASE("Move generation on curated positions", "[benchmark][moves]") {
+    for (const auto& position : curated_positions()) {
+        auto game = replay(position);
+        const auto board = game.board();
+        const Explorer explorer(board);
+        const auto side = game.player();
+        std::vector<Position> pieces;
+        for (std::size_t i = 0; i < 32; ++i) {
+            const auto square = Position::from_index(static_cast<int>(i));
+            if (board.is_occupied(square) && board.is_black_piece(square) == (side == PieceColor::BLACK)) {
+                pieces.push_back(square);
+            }
+        }
+
+        BENCHMARK("Explorer::find_valid_moves, " + position.name) {
+            std::size_t total = 0;
+            for (const auto& piece : pieces) total += explorer.find_valid_moves(piece).size();
+            return total;
+        };
+
+        MoveList moves;
+        BENCHMARK("Explorer::find_side_moves, " + position.name) {
+            explorer.find_side_moves(side, moves);
+            return moves.size();
+        };
+        BENCHMARK("Explorer::count_side_moves, " + position.name) { return explorer.count_side_moves(side); };
+        if (explorer.capture_sources(side) == 0u) {
+            BENCHMARK("QuietMoves first move, " + position.name) {
+                return (*QuietMoves(board, side).begin()).to.hash();
+            };
+        }
+
+        // Each child's choice list is generated afresh by Game (its cache slot is dirty after select_move)
+        const auto count = game.move_count();
+        BENCHMARK("Game choices of every child, " + position.name) {
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                game.select_move(i);
+                total += game.move_count();
+                game.undo_move();
+            }
+            return total;
+        };
+
+        BENCHMARK("Game select_move/undo_move of every move, " + position.name) {
+            for (std::size_t i = 0; i < count; ++i) {
+                game.select_move(i);
+                game.undo_move();
+            }
+            return game.get_move_sequence().size();
+        };
+
+        BENCHMARK("Game::copy, " + position.name) { return Game::copy(game).move_count(); };
+
+        Game clone;
+        BENCHMARK("Game::copy_from into a reused game, " + position.name) {
+            clone.copy_from(game);
+            return clone.move_count();
+        };
+    }
+}
+
+TEST_CASE("Perft", "[benchmark][perft]") {
+    const auto positions = curated_positions();
+    for (const auto& position : {positions[0], positions[1]}) {
+        auto game = replay(position);
+        for (const std::size_t depth : {3, 4, 5, 6}) {
+            BENCHMARK("perft " + std::to_string(depth) + ", " + position.name) { return perft::perft(game, depth); };
+        }
+    }
+}
+
+TEST_CASE("Random playouts and batch evaluation", "[benchmark][playout]") {
+    Game game;
+    std::uint64_t seed = 0;
+    BENCHMARK("playout::play from the start position") {
+        playout::Random random(seed++);
+        return playout::play(game, random, 1000).length;
+    };
+
+    BoardBatch boards;
+    for (std::uint64_t s = 0; s < 64; ++s) {
+        playout::Random random(s);
+        Game line;
+        while (line.move_count() > 0) {
+            boards.push_back(line.board(), line.player());
+            line.select_move(random.below(line.move_count()));
+        }
+    }
+    std::vector<std::int32_t> scores(boards.size());
+    for (const auto kernel : {batch::Kernel::SCALAR, batch::Kernel::AVX2, batch::Kernel::AVX512}) {
+        if (!batch::supported(kernel)) continue;
+        const std::string names[] = {"scalar", "AVX2", "AVX-512"};
+        BENCHMARK("batch::evaluate " + names[static_cast<int>(kernel)] + ", " + std::to_string(boards.size()) +
+                  " boards") {
+            batch::evaluate(boards, scores, kernel);
+            return scores.back();
+        };
+    }
+}
@@ -0,0 +1,75 @@
+// Catch2 reporter "benchjson": one JSON document with the statistics of every BENCHMARK, e.g.
+//   thai_checkers_bench --reporter benchjson::out=bench.json --reporter console
+// (Catch2's own JSON reporter leaves benchmarks out.) Compare two runs with scripts/compare_bench.py.
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_case_info.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <catch2/reporters/catch_reporter_streaming_base.hpp>
+
+#include <format>
+#include <string>
+#include <vector>
+
+namespace {
+std::string json_string(const std::string& text) {
+    std::string out = "\"";
+    for (const char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) {
+            out += std::format("\\u{:04x}", static_cast<unsigned>(c));
+            continue;
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+class BenchmarkJsonReporter final : public Catch::StreamingReporterBase {
+  public:
+    using StreamingReporterBase::StreamingReporterBase;
+
+    static std::string getDescription() { return "Benchmark statistics as one JSON document"; }
+
+    void testCaseStarting(const Catch::TestCaseInfo& info) override {
+        StreamingReporterBase::testCaseStarting(info);
+        test_case_ = info.name;
+    }
+
+    void benchmarkEnded(const Catch::BenchmarkStats<>& stats) override {
+        results_.push_back(std::format(
+            "    {{\"test_case\": {}, \"name\": {}, \"mean_ns\": {:.3f}, \"mean_low_ns\": {:.3f}, "
+            "\"mean_high_ns\": {:.3f}, \"std_dev_ns\": {:.3f}, \"samples\": {}, \"iterations\": {}}}",
+            json_string(test_case_), json_string(stats.info.name), stats.mean.point.count(),
+            stats.mean.lower_bound.count(), stats.mean.upper_bound.count(), stats.standardDeviation.point.count(),
+            stats.info.samples, stats.info.iterations));
+    }
+
+    void testRunEnded(const Catch::TestRunStats& stats) override {
+        StreamingReporterBase::testRunEnded(stats);
+#ifdef NDEBUG
+        constexpr bool optimized = true;
+#else
+        constexpr bool optimized = false;
+#endif
+#ifdef __VERSION__
+        constexpr const char* compiler = __VERSION__;
+#else
+        constexpr const char* compiler = "unknown";
+#endif
+        m_stream << "{\n";
+        m_stream << std::format("  \"compiler\": {},\n", json_string(compiler));
+        m_stream << std::format("  \"ndebug\": {},\n", optimized);
+        m_stream << "  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            m_stream << results_[i] << (i + 1 < results_.size() ? ",\n" : "\n");
+        }
+        m_stream << "  ]\n}\n";
+    }
+
+  private:
+    std::string test_case_;
+    std::vector<std::string> results_;
+};
+} // namespace
+
+CATCH_REGISTER_REPORTER("benchjson", BenchmarkJsonReporter)
@@ -0,0 +1,85 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Game.h"
+#include "RepetitionTable.h"
+
+namespace {
+// First game of the exhaustive DFS with at least `min_plies` moves; such lines are long dame
+// shuffles, the worst case for repetition bookkeeping
+struct RecordedLine {
+    std::vector<std::size_t> moves;
+    std::vector<zobrist::Key> keys;
+};
+
+bool find_long_game(Game& game, std::size_t min_plies) {
+    const auto mc = game.move_count();
+    if (mc == 0) return game.get_move_sequence().size() >= min_plies;
+    for (std::size_t i = 0; i < mc; ++i) {
+        game.select_move(i);
+        if (find_long_game(game, min_plies)) return true;
+        game.undo_move();
+    }
+    return false;
+}
+
+RecordedLine record_long_line(std::size_t min_plies = 1000) {
+    Game game;
+    find_long_game(game, min_plies);
+
+    RecordedLine line;
+    Game replay;
+    line.keys.push_back(replay.board().zobrist());
+    for (const auto index : game.get_move_sequence()) {
+        replay.select_move(index);
+        line.moves.push_back(index);
+        const auto side = replay.player() == PieceColor::BLACK ? zobrist::side_to_move : zobrist::Key{0};
+        line.keys.push_back(replay.board().zobrist() ^ side);
+    }
+    return line;
+}
+} // namespace
+
+TEST_CASE("Repetition bookkeeping per ply", "[benchmark][repetition]") {
+    const auto line = record_long_line();
+    REQUIRE(line.moves.size() >= 1000);
+    const auto plies = line.keys.size();
+
+    // Previous implementation: node-based hash map counter, incremented on make and erased on unmake
+    BENCHMARK("unordered_map position_count (before), " + std::to_string(plies) + " plies") {
+        std::unordered_map<std::size_t, int> counts;
+        int loops = 0;
+        for (const auto key : line.keys) {
+            if (++counts[key] >= 3) ++loops;
+        }
+        for (auto it = line.keys.rbegin(); it != line.keys.rend(); ++it) {
+            auto found = counts.find(*it);
+            if (--found->second == 0) counts.erase(found);
+        }
+        return loops;
+    };
+
+    BENCHMARK("RepetitionTable position_count (after), " + std::to_string(plies) + " plies") {
+        RepetitionTable counts;
+        int loops = 0;
+        for (const auto key : line.keys) {
+            if (counts.push(key) >= 3) ++loops;
+        }
+        for (auto it = line.keys.rbegin(); it != line.keys.rend(); ++it) counts.pop(*it);
+        return loops;
+    };
+
+    // Full make/unmake of the same line through Game, which includes the repetition check
+    Game game;
+    BENCHMARK("Game select_move/undo_move, " + std::to_string(line.moves.size()) + " plies") {
+        for (const auto index : line.moves) game.select_move(index);
+        for (std::size_t i = 0; i < line.moves.size(); ++i) game.undo_move();
+        return game.move_count();
+    };
+}
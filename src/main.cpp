@@ -1,58 +1,449 @@
 // Minimal runner for simplified Traversal
+#include "Checkpoint.h"
+#include "CommandLine.h"
+#include "GameRecords.h"
+#include "Instrumentation.h"
+#include "Mcts.h"
+#include "Perft.h"
+#include "Playout.h"
+#include "PositionDatabase.h"
+#include "Search.h"
+#include "Tablebase.h"
 #include "Traversal.h"
+#include "WorkQueue.h"
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <iostream>
 #include <format>
+#include <functional>
 #include <limits>
 #include <string>
 #include <string_view>
 #include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
-std::optional<std::chrono::milliseconds> parse_timeout(std::string_view arg) {
-    if (arg.empty()) return std::nullopt;
+int run_perft(std::size_t depth) {
+    std::cout << std::format("Running perft to depth {} from the start position\n", depth);
 
-    try {
-        // Check for 'ms' suffix (milliseconds) FIRST - before checking 's'
-        if (arg.ends_with("ms")) {
-            const auto ms_str = arg.substr(0, arg.length() - 2);
-            const long long ms = std::stoll(std::string(ms_str));
-            return std::chrono::milliseconds(ms);
+    Game game;
+    const auto start = std::chrono::steady_clock::now();
+    const auto entries = perft::divide(game, depth);
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t nodes = depth == 0 ? 1 : 0;
+    for (const auto& entry : entries) {
+        std::cout << std::format("  {}: {}\n", move_to_string(entry.move), entry.nodes);
+        nodes += entry.nodes;
+    }
+    std::cout << std::format("Nodes: {}\n", nodes);
+    std::cout << std::format("Time: {:.3f}s\n", elapsed);
+    std::cout << std::format("Throughput: {:.3f} nodes/s\n", elapsed > 0 ? static_cast<double>(nodes) / elapsed : 0.0);
+    return 0;
+}
+
+// Picks a move for the start position within the time limit, reporting every completed iteration.
+// With several threads, a single-threaded search to the same depth measures the time-to-depth speed-up.
+int run_search(std::chrono::milliseconds time_limit, std::size_t threads) {
+    std::cout << std::format("Searching the start position for {}ms with {} thread(s)\n", time_limit.count(), threads);
+
+    Game game;
+    // Time at which each depth was first completed
+    std::vector<std::chrono::nanoseconds> depth_times;
+    Search search(Search::DEFAULT_TABLE_MB, [&](const Search::Result& info) {
+        std::string pv;
+        for (const auto& move : info.pv) pv += " " + move_to_string(move);
+        std::cout << std::format("  depth {} score {} nodes {} nps {:.0f} pv{}\n", info.depth, info.score, info.nodes,
+                                 info.nodes_per_second(), pv);
+        depth_times.resize(info.depth + 1, info.elapsed);
+    });
+    search.set_threads(threads);
+    Search::Limits limits;
+    limits.time = time_limit;
+    const auto result = search.run(game, limits);
+    if (!result.best_move) {
+        std::cout << "No legal move\n";
+        return 0;
+    }
+    std::cout << std::format("Best move: {}\n", move_to_string(*result.best_move));
+    std::cout << std::format("Nodes: {}\n", result.nodes);
+    std::cout << std::format("Throughput: {:.3f} nodes/s\n", result.nodes_per_second());
+
+    if (threads > 1 && result.depth > 0) {
+        for (std::size_t i = 0; i < result.thread_nodes.size(); ++i) {
+            std::cout << std::format("  Thread {}: {} nodes\n", i, result.thread_nodes[i]);
         }
+        Search single;
+        Search::Limits to_depth;
+        to_depth.depth = result.depth;
+        const auto reference = single.run(game, to_depth);
+        const auto parallel_time = std::chrono::duration<double>(depth_times[result.depth]).count();
+        const auto single_time = std::chrono::duration<double>(reference.elapsed).count();
+        std::cout << std::format("Time to depth {}: {:.3f}s with one thread, {:.3f}s with {}\n", result.depth,
+                                 single_time, parallel_time, threads);
+        std::cout << std::format("Speed-up: {:.2f}x\n", parallel_time > 0 ? single_time / parallel_time : 0.0);
+    }
+    return 0;
+}
 
-        // Check for 's' suffix (seconds)
-        if (arg.ends_with('s')) {
-            const auto seconds_str = arg.substr(0, arg.length() - 1);
-            const double seconds = std::stod(std::string(seconds_str));
-            return std::chrono::milliseconds(static_cast<long long>(seconds * 1000));
+void print_statistics(const TraversalStatistics& stats) {
+    std::cout << std::format("Game statistics:\n");
+    std::cout << std::format("  Draws: {}\n", stats.draws);
+    std::cout << std::format("  Black wins: {}\n", stats.black_wins);
+    std::cout << std::format("  White wins: {}\n", stats.white_wins);
+    std::cout << std::format("  Min moves: {}\n", stats.games == 0 ? 0 : stats.min_length);
+    std::cout << std::format("  Max moves: {}\n", stats.max_length);
+    std::cout << std::format("  Total games: {}\n", stats.games);
+}
+
+// Bar chart of counts[i] in buckets of `bucket` consecutive indices, empty buckets left out
+void print_histogram(const std::vector<std::uint64_t>& counts, std::size_t bucket) {
+    std::vector<std::uint64_t> buckets((counts.size() + bucket - 1) / bucket);
+    for (std::size_t i = 0; i < counts.size(); ++i) buckets[i / bucket] += counts[i];
+    const auto largest = buckets.empty() ? 0 : *std::max_element(buckets.begin(), buckets.end());
+    for (std::size_t b = 0; b < buckets.size(); ++b) {
+        if (buckets[b] == 0) continue;
+        const auto bar = static_cast<std::size_t>(40 * buckets[b] / largest);
+        std::cout << std::format("  {:4}-{:<4} {:>10} {}\n", b * bucket, b * bucket + bucket - 1, buckets[b],
+                                 std::string(std::max<std::size_t>(bar, 1), '#'));
+    }
+}
+
+// Games per move-index prefix below the start position, game lengths and distinct positions per depth
+void print_breakdown(const TraversalBreakdown& breakdown, const std::vector<std::uint64_t>& depths) {
+    std::cout << std::format("Games per {}-ply opening:\n", breakdown.prefix_depth());
+    for (const auto& prefix : breakdown.prefixes()) {
+        if (prefix.stats.games == 0) continue;
+        Game game;
+        std::string line;
+        for (const auto index : prefix.moves) {
+            if (!line.empty()) line += ' ';
+            line += move_to_string(game.choices()[index]);
+            game.select_move(index);
         }
+        const auto& stats = prefix.stats;
+        std::cout << std::format("  {:<24} {:>12} games, black {:>12}, white {:>12}, draws {:>12}, {}-{} plies\n",
+                                 line.empty() ? "(start)" : line, stats.games, stats.black_wins, stats.white_wins,
+                                 stats.draws, stats.min_length, stats.max_length);
+        std::string lengths;
+        for (std::size_t bucket = 0; bucket < TraversalBreakdown::LENGTH_BUCKETS; ++bucket) {
+            if (prefix.lengths[bucket] == 0) continue;
+            lengths += std::format(" {}+:{}", TraversalBreakdown::bucket_min_length(bucket), prefix.lengths[bucket]);
+        }
+        std::cout << std::format("  {:<24} lengths{}\n", "", lengths);
+    }
+
+    std::vector<std::uint64_t> lengths(TraversalBreakdown::MAX_LENGTH + 1);
+    for (std::size_t length = 0; length < lengths.size(); ++length) {
+        using Outcome = TraversalBreakdown::Outcome;
+        lengths[length] = breakdown.games(length, Outcome::BLACK_WIN) + breakdown.games(length, Outcome::WHITE_WIN) +
+                          breakdown.games(length, Outcome::DRAW);
+    }
+    while (!lengths.empty() && lengths.back() == 0) lengths.pop_back();
+    std::cout << std::format("Game lengths (games of {} plies or more share the last length):\n",
+                             TraversalBreakdown::MAX_LENGTH);
+    print_histogram(lengths, std::max<std::size_t>(10, (lengths.size() + 199) / 200 * 10));
+
+    std::cout << "Distinct positions per depth (estimated):\n";
+    for (std::size_t depth = 0; depth < depths.size() && depth < TraversalBreakdown::SKETCH_DEPTHS; ++depth) {
+        std::cout << std::format("  {:4} {:>14.0f} of {:>14} nodes\n", depth, breakdown.distinct_positions(depth),
+                                 depths[depth]);
+    }
+    std::cout << std::format("  Breakdown memory: {} bytes per thread\n", breakdown.memory_bytes());
+}
 
-        // Default to seconds if no suffix
-        const double seconds = std::stod(std::string(arg));
-        return std::chrono::milliseconds(static_cast<long long>(seconds * 1000));
-    } catch (const std::exception&) { return std::nullopt; }
+// Hot-path counters of a build with ENABLE_INSTRUMENTATION
+void print_instrumentation(const instrumentation::Counters& counters) {
+    using instrumentation::Counter;
+    using instrumentation::Phase;
+    const auto generations = counters[Counter::MOVE_GENERATIONS];
+    const auto lookups = generations + counters[Counter::CHOICE_CACHE_HITS];
+    std::cout << "Instrumentation:\n";
+    std::cout << std::format("  Move generations: {}\n", generations);
+    std::cout << std::format("  Choice cache hits: {} ({:.1f}%)\n", counters[Counter::CHOICE_CACHE_HITS],
+                             lookups > 0 ? 100.0 * static_cast<double>(counters[Counter::CHOICE_CACHE_HITS]) /
+                                               static_cast<double>(lookups)
+                                         : 0.0);
+    std::cout << std::format("  Capture search jumps: {}\n", counters[Counter::CAPTURE_SEARCH_NODES]);
+    std::cout << std::format("  Duplicate capture sequences: {}\n", counters[Counter::DEDUP_COLLISIONS]);
+    std::cout << std::format("  Repetition lookups: {}\n", counters[Counter::REPETITION_LOOKUPS]);
+    std::string depths;
+    for (std::size_t jumps = 1; jumps < counters.capture_depths.size(); ++jumps) {
+        if (counters.capture_depths[jumps] > 0) depths += std::format(" {}:{}", jumps, counters.capture_depths[jumps]);
+    }
+    std::cout << std::format("  Capture sequences by jumps:{}\n", depths.empty() ? " none" : depths);
+    const auto ms = [&](Phase phase) {
+        return std::chrono::duration<double, std::milli>(counters.time(phase)).count();
+    };
+    std::cout << std::format("  Time: move generation {:.0f}ms, make/unmake {:.0f}ms, probes {:.0f}ms, "
+                             "results {:.0f}ms\n",
+                             ms(Phase::MOVE_GENERATION), ms(Phase::MAKE_UNMAKE), ms(Phase::PROBE), ms(Phase::RESULTS));
+}
+
+// Plays random games from the start position on every thread for the given time
+int run_playouts(std::chrono::milliseconds time_limit, std::size_t threads) {
+    std::cout << std::format("Playing random games from the start position for {}ms with {} thread(s)\n",
+                             time_limit.count(), threads);
+
+    playout::Limits limits;
+    limits.time = time_limit;
+    playout::Options options;
+    options.threads = threads;
+    const auto result = playout::run(Game{}, limits, options);
+    const auto& stats = result.stats;
+
+    print_statistics(stats.outcomes);
+    std::cout << std::format("  Unfinished games: {} (over {} plies)\n", stats.unfinished, options.max_plies);
+    std::cout << std::format("  Mean moves: {:.1f}\n", stats.mean_length());
+
+    std::cout << "Game lengths:\n";
+    print_histogram(stats.lengths, 10);
+
+    std::cout << std::format("Plies: {}\n", stats.plies);
+    std::cout << std::format("Throughput: {:.3f} playouts/s\n", result.playouts_per_second());
+    return 0;
+}
+
+// Picks a move for the start position with Monte Carlo tree search on every thread
+int run_mcts(std::chrono::milliseconds time_limit, std::size_t threads) {
+    std::cout << std::format("Running MCTS on the start position for {}ms with {} thread(s)\n", time_limit.count(),
+                             threads);
+
+    Game game;
+    Mcts mcts;
+    mcts.set_threads(threads);
+    Mcts::Limits limits;
+    limits.time = time_limit;
+    const auto result = mcts.run(game, limits);
+    if (!result.best_move) {
+        std::cout << "No legal move\n";
+        return 0;
+    }
+    std::string pv;
+    for (const auto& move : result.pv) pv += " " + move_to_string(move);
+    std::cout << std::format("Best move: {} ({} visits, value {:.3f})\n", move_to_string(*result.best_move),
+                             result.visits, result.value);
+    std::cout << std::format("PV:{}\n", pv);
+    std::cout << std::format("Tree: {}/{} nodes{}\n", result.nodes, mcts.capacity(),
+                             result.tree_full ? " (full)" : "");
+    std::cout << std::format("Iterations: {}\n", result.iterations);
+    std::cout << std::format("Throughput: {:.3f} iterations/s\n", result.iterations_per_second());
+    return 0;
+}
+
+// Publishes the work units of the start position and requeues units of dead workers until all are done
+int run_coordinator(const std::string& directory, std::size_t depth, std::chrono::milliseconds lease,
+                    std::optional<std::chrono::steady_clock::time_point> deadline) {
+    Game game;
+    const auto queue = WorkQueue::create(directory, game, depth);
+    std::cout << std::format("Coordinating {} work units of depth {} in {}\n", queue.status().total, depth, directory);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    auto status = queue.status();
+    while (!status.finished() && !(deadline && std::chrono::steady_clock::now() >= *deadline)) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (const auto requeued = queue.requeue_expired(lease)) {
+            std::cout << std::format("Requeued {} unit(s) with an expired lease\n", requeued);
+        }
+        status = queue.status();
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_report >= std::chrono::seconds(2)) {
+            std::cout << std::format("Progress: {}/{} units done, {} claimed\n", status.done, status.total,
+                                     status.claimed);
+            last_report = now;
+        }
+    }
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto stats = queue.results();
+    print_statistics(stats);
+    std::cout << std::format("  Units done: {}/{}\n", status.done, status.total);
+    std::cout << std::format("  Time: {:.3f}s\n", elapsed);
+    return status.finished() ? 0 : 2;
+}
+
+// What a run does; each option lists the modes that use it
+enum RunMode : unsigned {
+    TRAVERSE = 1u << 0,
+    COORDINATE = 1u << 1,
+    WORK = 1u << 2,
+    PERFT = 1u << 3,
+    SEARCH = 1u << 4,
+    PLAYOUTS = 1u << 5,
+    MCTS = 1u << 6,
+};
+
+struct ModeOption {
+    std::string_view option;
+    unsigned modes;
+};
+
+// Options that select a mode other than a plain traversal; at most one may be given
+constexpr auto mode_options = std::to_array<ModeOption>({
+    {"--coordinate", COORDINATE},
+    {"--work", WORK},
+    {"--perft", PERFT},
+    {"--search", SEARCH},
+    {"--playouts", PLAYOUTS},
+    {"--mcts", MCTS},
+});
+
+// Options that only some modes use; any other combination is refused rather than silently ignored
+constexpr auto option_modes = std::to_array<ModeOption>({
+    {"--timeout", TRAVERSE | COORDINATE | WORK},
+    {"--threads", TRAVERSE | WORK | SEARCH | PLAYOUTS | MCTS},
+    {"--split-depth", TRAVERSE | WORK},
+    {"--tt", TRAVERSE | WORK},
+    {"--tt-canonical", TRAVERSE | WORK},
+    {"--db", TRAVERSE | WORK},
+    {"--tablebase", TRAVERSE | WORK},
+    {"--max-depth", TRAVERSE},
+    {"--max-nodes", TRAVERSE},
+    {"--breakdown", TRAVERSE},
+    {"--checkpoint", TRAVERSE},
+    {"--resume", TRAVERSE},
+    {"--records", TRAVERSE | WORK},
+    {"--record-every", TRAVERSE | WORK},
+    {"--prefix-depth", COORDINATE},
+    {"--lease", COORDINATE | WORK},
+});
+
+// Options that do nothing without another one
+constexpr auto option_requires = std::to_array<std::pair<std::string_view, std::string_view>>({
+    {"--record-every", "--records"},
+    {"--tt-canonical", "--tt"},
+});
+
+// The run's mode from the options given, or an error message
+std::optional<ModeOption> select_mode(const std::vector<std::string_view>& given, std::string& error) {
+    const auto was_given = [&](std::string_view option) { return std::ranges::find(given, option) != given.end(); };
+    std::optional<ModeOption> mode;
+    for (const auto& candidate : mode_options) {
+        if (!was_given(candidate.option)) continue;
+        if (mode) {
+            error = std::format("{} and {} are separate modes", mode->option, candidate.option);
+            return std::nullopt;
+        }
+        mode = candidate;
+    }
+    for (const auto& [option, required] : option_requires) {
+        if (was_given(option) && !was_given(required)) {
+            error = std::format("{} has no effect without {}", option, required);
+            return std::nullopt;
+        }
+    }
+    if (!mode) mode = ModeOption{"", TRAVERSE};
+    for (const auto& [option, modes] : option_modes) {
+        if ((modes & mode->modes) == 0 && was_given(option)) {
+            error = mode->option.empty() ? std::format("{} has no effect in a plain traversal", option)
+                                         : std::format("{} has no effect with {}", option, mode->option);
+            return std::nullopt;
+        }
+    }
+    return mode;
 }
 
 void print_usage(const char* program_name) {
-    std::cout << std::format("Usage: {} [--timeout DURATION]\n", program_name);
-    std::cout << "Options:\n";
+    std::cout << std::format(
+        "Usage: {} [--timeout DURATION] [--threads N] [--split-depth D] [--tt MB] [--tt-canonical] [--db FILE] "
+        "[--tablebase FILE] [--max-depth D] [--max-nodes N] [--breakdown K] [--checkpoint FILE] [--resume FILE] "
+        "[--records FILE] [--record-every N] "
+        "[--coordinate DIR | --work DIR] [--prefix-depth K] [--lease DURATION] "
+        "[--search DURATION] [--playouts DURATION] [--mcts DURATION] [--perft D]\n",
+        program_name);
+    std::cout << "Options (--coordinate, --work, --search, --playouts, --mcts and --perft select exclusive modes;\n";
+    std::cout << "an option the selected mode does not use is an error):\n";
     std::cout << "  --timeout DURATION  Set timeout duration (e.g., 10s, 12.5s, 5000ms)\n";
     std::cout << "                      Default: 10s\n";
+    std::cout << "  --threads N         Worker threads (0 = all hardware threads)\n";
+    std::cout << "                      Default: 1\n";
+    std::cout << "  --max-depth D       End lines D plies below the start position; positions there that still have\n";
+    std::cout << "                      moves count as horizon leaves (not with --tt, --db or --work)\n";
+    std::cout << "  --max-nodes N       Stop after entering N positions (not with --work)\n";
+    std::cout << "                      (either limit runs without a timeout unless --timeout is given)\n";
+    std::cout << "  --breakdown K       Also report games per K-ply opening, game lengths and estimated distinct\n";
+    std::cout << "                      positions per depth, in fixed memory (not with --tt, --db or --work)\n";
+    std::cout << "  --split-depth D     Plies below the root that are split into parallel tasks\n";
+    std::cout << "                      Default: 6\n";
+    std::cout << "  --tt MB             Reuse finished subtrees from a transposition table of MB MiB\n";
+    std::cout << "                      (only after captures and pion moves, so results are exact)\n";
+    std::cout << "                      Default: off\n";
+    std::cout << "  --tt-canonical      Key the --tt table by color-swap symmetry class: black to move is stored as\n";
+    std::cout << "                      the mirrored white-to-move position, so the table holds twice the subtrees\n";
+    std::cout << "  --db FILE           Cut off subtrees stored in a position database (see thai_checkers_db)\n";
+    std::cout << "  --tablebase FILE    End lines at positions solved by a tablebase (see thai_checkers_tablebase)\n";
+    std::cout << "  --checkpoint FILE   Save the search frontier to FILE every minute and when the timeout ends it\n";
+    std::cout << "                      (single thread only, not with --coordinate or --work)\n";
+    std::cout << "  --resume FILE       Continue the traversal saved in a checkpoint file\n";
+    std::cout << "  --records FILE      Write every finished game with its moves to a binary record stream\n";
+    std::cout << "                      (prefix-delta encoded, zstd-compressed when the build has zstd)\n";
+    std::cout << "                      (with --work, a unit requeued at the timeout writes its games again\n";
+    std::cout << "                      when it is traversed once more)\n";
+    std::cout << "  --record-every N    Only write every N-th game of each thread to --records\n";
+    std::cout << "                      Default: 1\n";
+    std::cout << "  --coordinate DIR    Split the start position into work units in DIR (a directory shared by every\n";
+    std::cout << "                      node), requeue units of dead workers and report the merged statistics\n";
+    std::cout << "  --work DIR          Traverse work units from DIR until none is left\n";
+    std::cout << "                      (with either mode the run has no time limit unless --timeout is given)\n";
+    std::cout << "  --prefix-depth K    Plies of the move-index prefix of each work unit\n";
+    std::cout << "                      Default: 6\n";
+    std::cout << "  --lease DURATION    A claimed unit is requeued when its worker is silent this long\n";
+    std::cout << "                      Default: 60s\n";
+    std::cout << "  --search DURATION   Pick a move for the start position with an alpha-beta search of DURATION\n";
+    std::cout << "                      (Lazy SMP with --threads; also reports the speed-up over one thread)\n";
+    std::cout << "  --playouts DURATION Play uniformly random games from the start position for DURATION on --threads\n";
+    std::cout << "                      threads; reports outcomes, a game-length histogram and playouts/s\n";
+    std::cout << "  --mcts DURATION     Pick a move for the start position with Monte Carlo tree search of DURATION\n";
+    std::cout << "                      (tree-parallel with --threads)\n";
+    std::cout << "  --perft D           Count the leaf nodes D plies below the start position per root move\n";
+    std::cout << "                      and report nodes/s (no timeout)\n";
     std::cout << "  --help             Show this help message\n";
 }
 
 int main(int argc, char** argv) {
     // Default timeout: 10 seconds
     std::chrono::milliseconds timeout{10000};
+    bool timeout_given = false;
+    std::chrono::milliseconds lease{60000};
+    std::size_t prefix_depth = 6;
+    std::optional<std::string> coordinate_path;
+    std::optional<std::string> work_path;
+    std::size_t threads = 1;
+    std::size_t split_depth = 6;
+    std::optional<std::size_t> perft_depth;
+    std::optional<std::size_t> max_depth;
+    std::optional<std::size_t> max_nodes;
+    std::optional<std::size_t> breakdown_depth;
+    std::optional<std::chrono::milliseconds> search_time;
+    std::optional<std::chrono::milliseconds> playout_time;
+    std::optional<std::chrono::milliseconds> mcts_time;
+    std::optional<std::size_t> tt_size_mb;
+    bool tt_canonical = false;
+    std::optional<std::string> database_path;
+    std::optional<std::string> tablebase_path;
+    std::optional<std::string> checkpoint_path;
+    std::optional<std::string> resume_path;
+    std::optional<std::string> records_path;
+    std::size_t record_every = 1;
+    std::vector<std::string_view> given;
 
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
         const std::string_view arg = argv[i];
+        given.push_back(arg);
 
         if (arg == "--help" || arg == "-h") {
             print_usage(argv[0]);
             return 0;
+        } else if (arg == "--tt-canonical") {
+            tt_canonical = true;
         } else if (arg == "--timeout") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --timeout requires a duration argument\n";
@@ -68,6 +459,90 @@ int main(int argc, char** argv) {
             }
 
             timeout = *parsed_timeout;
+            timeout_given = true;
+        } else if (arg == "--lease" || arg == "--search" || arg == "--playouts" || arg == "--mcts") {
+            if (i + 1 >= argc) {
+                std::cerr << std::format("Error: {} requires a duration argument\n", arg);
+                print_usage(argv[0]);
+                return 1;
+            }
+
+            const auto parsed_duration = parse_timeout(argv[++i]);
+            if (!parsed_duration || parsed_duration->count() <= 0) {
+                std::cerr << std::format("Error: Invalid duration '{}' for {}\n", argv[i], arg);
+                return 1;
+            }
+
+            if (arg == "--lease") {
+                lease = *parsed_duration;
+            } else if (arg == "--playouts") {
+                playout_time = *parsed_duration;
+            } else if (arg == "--mcts") {
+                mcts_time = *parsed_duration;
+            } else {
+                search_time = *parsed_duration;
+            }
+        } else if (arg == "--coordinate" || arg == "--work") {
+            if (i + 1 >= argc) {
+                std::cerr << std::format("Error: {} requires a directory argument\n", arg);
+                print_usage(argv[0]);
+                return 1;
+            }
+
+            (arg == "--coordinate" ? coordinate_path : work_path) = argv[++i];
+        } else if (arg == "--db" || arg == "--tablebase" || arg == "--checkpoint" || arg == "--resume" ||
+                   arg == "--records") {
+            if (i + 1 >= argc) {
+                std::cerr << std::format("Error: {} requires a file argument\n", arg);
+                print_usage(argv[0]);
+                return 1;
+            }
+
+            if (arg == "--db") {
+                database_path = argv[++i];
+            } else if (arg == "--tablebase") {
+                tablebase_path = argv[++i];
+            } else if (arg == "--checkpoint") {
+                checkpoint_path = argv[++i];
+            } else if (arg == "--records") {
+                records_path = argv[++i];
+            } else {
+                resume_path = argv[++i];
+            }
+        } else if (arg == "--threads" || arg == "--split-depth" || arg == "--tt" || arg == "--perft" ||
+                   arg == "--prefix-depth" || arg == "--record-every" || arg == "--max-depth" || arg == "--max-nodes" ||
+                   arg == "--breakdown") {
+            if (i + 1 >= argc) {
+                std::cerr << std::format("Error: {} requires a number argument\n", arg);
+                print_usage(argv[0]);
+                return 1;
+            }
+
+            const auto parsed_count = parse_count(argv[++i]);
+            if (!parsed_count) {
+                std::cerr << std::format("Error: Invalid number '{}' for {}\n", argv[i], arg);
+                return 1;
+            }
+
+            if (arg == "--threads") {
+                threads = *parsed_count == 0 ? std::max(1u, std::thread::hardware_concurrency()) : *parsed_count;
+            } else if (arg == "--split-depth") {
+                split_depth = *parsed_count;
+            } else if (arg == "--tt") {
+                tt_size_mb = *parsed_count;
+            } else if (arg == "--prefix-depth") {
+                prefix_depth = *parsed_count;
+            } else if (arg == "--record-every") {
+                record_every = *parsed_count;
+            } else if (arg == "--max-depth") {
+                max_depth = *parsed_count;
+            } else if (arg == "--max-nodes") {
+                max_nodes = *parsed_count;
+            } else if (arg == "--breakdown") {
+                breakdown_depth = *parsed_count;
+            } else {
+                perft_depth = *parsed_count;
+            }
         } else {
             std::cerr << std::format("Error: Unknown argument '{}'\n", arg);
             print_usage(argv[0]);
@@ -75,38 +550,184 @@ int main(int argc, char** argv) {
         }
     }
 
-    std::cout << std::format("Running Thai Checkers analysis with timeout: {}ms\n", timeout.count());
+    std::string error;
+    const auto mode = select_mode(given, error);
+    if (!mode) {
+        std::cerr << std::format("Error: {}\n", error);
+        return 1;
+    }
+    if (perft_depth) return run_perft(*perft_depth);
+    if (search_time) return run_search(*search_time, threads);
+    if (playout_time) return run_playouts(*playout_time, threads);
+    if (mcts_time) return run_mcts(*mcts_time, threads);
+
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (timeout_given) deadline = std::chrono::steady_clock::now() + timeout;
+    if (coordinate_path) {
+        try {
+            return run_coordinator(*coordinate_path, prefix_depth, lease, deadline);
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+    }
 
-    uint64_t draws = 0, black = 0, white = 0;
-    uint64_t min_moves = std::numeric_limits<uint64_t>::max();
-    uint64_t max_moves = 0;
+    // Fixed-work runs are only cut short by a timeout that was asked for
+    std::optional<std::chrono::milliseconds> time_limit = timeout;
+    if ((max_depth || max_nodes) && !timeout_given) time_limit.reset();
 
-    Traversal traversal(
-        [&](const Traversal::ResultEvent& ev) {
-            const uint64_t moves = static_cast<uint64_t>(ev.history.size());
-            if (!ev.winner) ++draws;
-            else if (static_cast<int>(*ev.winner) == 0) ++black;
-            else ++white;
-            min_moves = std::min(min_moves, moves);
-            max_moves = std::max(max_moves, moves);
-        },
-        [&](const Traversal::ProgressEvent& ev) {
-            std::cout << std::format("Progress: {} games completed\n", ev.games);
-        });
+    if (!work_path) {
+        std::string limits = time_limit ? std::format("timeout: {}ms", time_limit->count()) : "no timeout";
+        if (max_depth) limits += std::format(", max depth: {}", *max_depth);
+        if (max_nodes) limits += std::format(", max nodes: {}", *max_nodes);
+        std::cout << std::format("Running Thai Checkers analysis with {}, threads: {}\n", limits, threads);
+    }
+
+    std::optional<GameRecordWriter> records;
+    if (records_path) {
+        try {
+            records.emplace(*records_path, GameRecordWriter::Options{
+                                               .sample_every = record_every,
+                                               .compress = game_records::compression_available(),
+                                           });
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+    }
+
+    auto record_sink = records ? records->sink() : std::function<void(const Traversal::ResultBatch&)>{};
+    Traversal traversal(std::move(record_sink), [&](const Traversal::ProgressEvent& ev) {
+        std::cout << std::format("Progress: {} games completed, {} nodes, {:.0f} nodes/s, branching factor {:.2f}\n",
+                                 ev.games, ev.nodes, ev.nodes_per_second(), ev.branching_factor());
+    });
+    traversal.set_threads(threads);
+    traversal.set_split_depth(split_depth);
+    traversal.set_record_histories(records.has_value());
+    if (tt_size_mb) {
+        traversal.set_transposition_table(
+            tt_canonical ? Traversal::TranspositionMode::CANONICAL : Traversal::TranspositionMode::EXACT, *tt_size_mb);
+    }
+
+    std::optional<PositionDatabase> database;
+    if (database_path) {
+        try {
+            database.emplace(PositionDatabase::open(*database_path));
+        } catch (const std::runtime_error& e) {
+            std::cerr << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+        traversal.set_position_database(&*database);
+    }
+
+    std::optional<Tablebase> tablebase;
+    if (tablebase_path) {
+        try {
+            tablebase.emplace(Tablebase::load(*tablebase_path));
+        } catch (const std::runtime_error& e) {
+            std::cerr << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+        traversal.set_tablebase(&*tablebase);
+    }
+
+    if (work_path) {
+        try {
+            const auto queue = WorkQueue::open(*work_path);
+            std::cout << std::format("Working on {} with threads: {}\n", *work_path, threads);
+            const auto completed = work_through(queue, traversal, lease, deadline);
+            std::cout << std::format("Units completed: {}\n", completed);
+            if (records) {
+                records->close();
+                std::cout << std::format("Game records: {} in {} bytes\n", records->records(), records->bytes());
+            }
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+        return 0;
+    }
+
+    if ((checkpoint_path || resume_path) && threads > 1) {
+        std::cerr << "Error: --checkpoint and --resume require --threads 1\n";
+        return 1;
+    }
+    if (checkpoint_path) traversal.set_checkpoint(*checkpoint_path);
+    traversal.set_max_depth(max_depth);
+    traversal.set_max_nodes(max_nodes);
+    traversal.set_breakdown(breakdown_depth);
 
     Game game;
-    traversal.traverse_for(game, timeout);
+    const auto start = std::chrono::steady_clock::now();
+    // Games finished by earlier runs, left out of this run's throughput
+    std::size_t resumed_games = 0;
+    if (resume_path) {
+        try {
+            const auto checkpoint = Checkpoint::load(*resume_path);
+            // Keep writing to the resumed file unless another one was given
+            if (!checkpoint_path) traversal.set_checkpoint(*resume_path);
+            resumed_games = checkpoint.stats.games;
+            traversal.resume_for(game, checkpoint, time_limit);
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+    } else {
+        try {
+            traversal.traverse_for(game, time_limit);
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
     // Print game statistics
-    std::cout << std::format("Game statistics:\n");
-    std::cout << std::format("  Draws: {}\n", draws);
-    std::cout << std::format("  Black wins: {}\n", black);
-    std::cout << std::format("  White wins: {}\n", white);
-    std::cout << std::format("  Min moves: {}\n", min_moves);
-    std::cout << std::format("  Max moves: {}\n", max_moves);
-    std::cout << std::format("  Total games: {}\n", black + white + draws);
+    const auto& stats = traversal.statistics();
+    print_statistics(stats);
+    if (tt_size_mb) std::cout << std::format("  Transposition hits: {}\n", traversal.transposition_hits());
+    if (database) std::cout << std::format("  Database hits: {}\n", traversal.database_hits());
+    if (tablebase) std::cout << std::format("  Tablebase hits: {}\n", traversal.tablebase_hits());
+    if (traversal.checkpoint_failures() > 0) {
+        std::cerr << std::format("Warning: {} periodic checkpoint saves failed, the last with: {}\n",
+                                 traversal.checkpoint_failures(), traversal.checkpoint_error());
+    }
+    if (records) {
+        try {
+            records->close();
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Error: {}\n", e.what());
+            return 1;
+        }
+        std::cout << std::format("  Game records: {} in {} bytes{}\n", records->records(), records->bytes(),
+                                 game_records::compression_available() ? " (zstd)" : "");
+    }
+    if (max_depth) std::cout << std::format("  Horizon leaves: {}\n", traversal.horizon_leaves());
+    if (checkpoint_path || resume_path) {
+        std::cout << std::format("  Completed: {}\n", traversal.completed() ? "yes" : "no (resume from checkpoint)");
+    } else if (max_depth || max_nodes) {
+        std::cout << std::format("  Completed: {}\n", traversal.completed() ? "yes" : "no");
+    }
+    std::cout << std::format("  Time: {:.3f}s\n", elapsed);
     std::cout << std::format("  Throughput: {:.3f} games/s\n",
-                             static_cast<double>(black + white + draws) / (timeout.count() / 1000.0));
+                             elapsed > 0 ? static_cast<double>(stats.games - resumed_games) / elapsed : 0.0);
+    const auto& nodes = traversal.node_counters();
+    std::cout << std::format("  Nodes: {} ({:.3f} nodes/s)\n", nodes.nodes,
+                             elapsed > 0 ? static_cast<double>(nodes.nodes) / elapsed : 0.0);
+    std::cout << std::format("  Branching factor: {:.2f}\n", nodes.branching_factor());
+    if (max_depth) {
+        // Exact counts per ply, comparable across machines and thread counts
+        std::cout << "Nodes per depth:\n";
+        for (std::size_t depth = 0; depth < nodes.depths.size(); ++depth) {
+            std::cout << std::format("  {:4} {:>14}\n", depth, nodes.depths[depth]);
+        }
+    } else {
+        // Ten-ply buckets, widened to keep dame shuffles of thousands of plies to about 20 rows
+        std::cout << "Node depths:\n";
+        print_histogram(nodes.depths, std::max<std::size_t>(10, (nodes.depths.size() + 199) / 200 * 10));
+    }
+    if (breakdown_depth) print_breakdown(traversal.breakdown(), nodes.depths);
+    if constexpr (instrumentation::enabled) print_instrumentation(traversal.instrumentation_counters());
 
     return 0;
 }
@@ -0,0 +1,167 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <utility>
+
+#include "Bitboard.h"
+#include "Explorer.h"
+#include "Game.h"
+
+TEST_CASE("Neighbor and ray tables follow board coordinates", "[bitboard]") {
+    for (const auto& pos : Position::all_valid_positions()) {
+        for (const auto dir : bitboard::all_directions) {
+            const auto delta = bitboard::direction_deltas[bitboard::index(dir)];
+            const int x = pos.x() + delta.col;
+            const int y = pos.y() + delta.row;
+            const auto n = bitboard::neighbor(dir, pos.hash());
+            if (Position::is_valid(x, y)) {
+                REQUIRE(n == Position{x, y}.hash());
+                REQUIRE((bitboard::ray(dir, pos.hash()) & bitboard::bit(n)) != 0u);
+            } else {
+                REQUIRE(n == bitboard::no_square);
+                REQUIRE(bitboard::ray(dir, pos.hash()) == 0u);
+            }
+        }
+    }
+}
+
+TEST_CASE("Mask shifts match per-square neighbors", "[bitboard]") {
+    for (const auto dir : bitboard::all_directions) {
+        for (std::size_t sq = 0; sq < bitboard::square_count; ++sq) {
+            const auto n = bitboard::neighbor(dir, sq);
+            const auto expected = n == bitboard::no_square ? 0u : bitboard::bit(n);
+            REQUIRE(bitboard::shift(bitboard::bit(sq), dir) == expected);
+        }
+    }
+}
+
+TEST_CASE("Side masks agree with per-piece move generation", "[bitboard]") {
+    const auto board = Board::setup();
+    const Explorer explorer(board);
+    for (const auto color : {PieceColor::WHITE, PieceColor::BLACK}) {
+        REQUIRE(explorer.capture_sources(color) == 0u);
+        const auto sources = explorer.move_sources(color);
+        REQUIRE(std::popcount(sources) == 4);
+        MoveList moves;
+        explorer.find_side_moves(color, moves);
+        REQUIRE(moves.size() == 7);
+        for (const auto& move : moves) {
+            REQUIRE((sources & bitboard::bit(move.from.hash())) != 0u);
+            REQUIRE_FALSE(move.is_capture());
+            REQUIRE_FALSE(explorer.find_valid_moves(move.from).has_captured());
+        }
+    }
+}
+
+TEST_CASE("Piece directions are resolved at compile time", "[bitboard]") {
+    using enum AnalyzerDirection;
+    STATIC_REQUIRE(bitboard::piece_directions<PieceColor::BLACK, PieceType::PION> ==
+                   std::array<AnalyzerDirection, 2>{SW, SE});
+    STATIC_REQUIRE(bitboard::piece_directions<PieceColor::WHITE, PieceType::PION> ==
+                   std::array<AnalyzerDirection, 2>{NW, NE});
+    STATIC_REQUIRE(bitboard::piece_directions<PieceColor::BLACK, PieceType::DAME> == bitboard::all_directions);
+    STATIC_REQUIRE(bitboard::piece_directions<PieceColor::WHITE, PieceType::DAME> == bitboard::all_directions);
+}
+
+TEST_CASE("Specialized side generation matches the runtime-color entry point", "[bitboard]") {
+    Game game;
+    for (int ply = 0; ply < 400 && game.move_count() != 0; ++ply) {
+        for (const auto color : {PieceColor::WHITE, PieceColor::BLACK}) {
+            MoveList runtime;
+            MoveList specialized;
+            const Explorer explorer(game.board());
+            explorer.find_side_moves(color, runtime);
+            if (color == PieceColor::BLACK) {
+                explorer.find_side_moves<PieceColor::BLACK>(specialized);
+            } else {
+                explorer.find_side_moves<PieceColor::WHITE>(specialized);
+            }
+            REQUIRE(std::ranges::equal(runtime, specialized));
+        }
+        game.select_move((static_cast<std::size_t>(ply) * 7919u) % game.move_count());
+    }
+}
+
+TEST_CASE("Move counts and the lazy quiet range agree with side generation", "[bitboard]") {
+    std::size_t quiet_positions = 0;
+    for (std::size_t seed = 0; seed < 8; ++seed) {
+        Game game;
+        for (std::size_t ply = 0; ply < 400 && game.move_count() != 0; ++ply) {
+            for (const auto color : {PieceColor::WHITE, PieceColor::BLACK}) {
+                const Explorer explorer(game.board());
+                MoveList moves;
+                explorer.find_side_moves(color, moves);
+                REQUIRE(explorer.count_side_moves(color) == moves.size());
+                REQUIRE(count_moves(game.board(), color) == moves.size());
+                if (explorer.capture_sources(color) != 0u) continue;
+
+                ++quiet_positions;
+                const QuietMoves quiet(game.board(), color);
+                REQUIRE(std::ranges::equal(quiet, moves));
+                if (!moves.empty()) REQUIRE(*quiet.begin() == moves[0]);
+            }
+            // Uncached (fresh node) and cached counts
+            REQUIRE(game.count_moves() == game.choices().size());
+            REQUIRE(game.count_moves() == game.move_count());
+            game.select_move((ply * 7919u + seed * 104729u) % game.move_count());
+            REQUIRE(game.count_moves() == game.move_count());
+        }
+    }
+    REQUIRE(quiet_positions > 100);
+}
+
+TEST_CASE("Mirrored boards play like the original with the colors swapped", "[bitboard][symmetry]") {
+    for (std::size_t i = 0; i < bitboard::square_count; ++i) {
+        REQUIRE(bitboard::rotated(bitboard::bit(i)) == bitboard::bit(bitboard::square_count - 1 - i));
+    }
+    const auto rotated = [](const Position& pos) { return Position::from_index(static_cast<int>(31 - pos.hash())); };
+    Game game;
+    for (int ply = 0; ply < 400 && game.move_count() != 0; ++ply) {
+        const auto& board = game.board();
+        const auto mirrored = board.mirrored();
+        REQUIRE(mirrored.mirrored() == board);
+        REQUIRE(board.canonical(PieceColor::WHITE) == std::pair{board, false});
+        REQUIRE(board.canonical(PieceColor::BLACK) == std::pair{mirrored, true});
+
+        for (const auto color : {PieceColor::WHITE, PieceColor::BLACK}) {
+            MoveList moves;
+            MoveList twins;
+            Explorer(board).find_side_moves(color, moves);
+            Explorer(mirrored).find_side_moves(color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE,
+                                               twins);
+            REQUIRE(moves.size() == twins.size());
+            for (const auto& move : moves) {
+                const bool found = std::ranges::any_of(twins, [&](const Move& twin) {
+                    return twin.from == rotated(move.from) && twin.to == rotated(move.to) &&
+                           twin.captured == bitboard::rotated(move.captured);
+                });
+                REQUIRE(found);
+            }
+        }
+        game.select_move((static_cast<std::size_t>(ply) * 7919u) % game.move_count());
+    }
+}
+
+TEST_CASE("Dame multi-captures branch after landing", "[bitboard][capture]") {
+    // Black dame B1 takes D3 landing on E4, then either G2 (landing H1) or G6 (landing H7)
+    const auto mask = [](const char* square) { return bitboard::bit(Position{square}.hash()); };
+    const auto black = mask("B1");
+    const auto white = mask("D3") | mask("G2") | mask("G6");
+    Board board;
+    board.set_from_masks(black | white, black, black);
+
+    MoveList moves;
+    Explorer(board).find_side_moves(PieceColor::BLACK, moves);
+    REQUIRE(moves.size() == 2);
+    REQUIRE(moves[0] == Move{.from = Position{"B1"}, .to = Position{"H1"}, .captured = mask("D3") | mask("G2")});
+    REQUIRE(moves[1] == Move{.from = Position{"B1"}, .to = Position{"H7"}, .captured = mask("D3") | mask("G6")});
+
+    // The per-piece API finds the same two sequences
+    const auto legals = Explorer(board).find_valid_moves(Position{"B1"});
+    REQUIRE(legals.has_captured());
+    REQUIRE(legals.size() == 2);
+}
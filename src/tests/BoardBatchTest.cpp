@@ -0,0 +1,168 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "BoardBatch.h"
+#include "Explorer.h"
+#include "Search.h"
+
+namespace {
+// Positions of random games, plus their side to move; later games reach dames and long endgames
+BoardBatch playout_positions(std::size_t games) {
+    std::mt19937 rng(42);
+    BoardBatch boards;
+    for (std::size_t g = 0; g < games; ++g) {
+        Game game;
+        for (std::size_t ply = 0; ply < 150 && game.move_count() > 0; ++ply) {
+            boards.push_back(game.board(), game.player());
+            game.select_move(std::uniform_int_distribution<std::size_t>(0, game.move_count() - 1)(rng));
+        }
+    }
+    return boards;
+}
+
+// Non-capture moves that go a single square, as batch::mobility counts them
+int single_steps(const Game& game) {
+    const auto choices = game.choices();
+    return static_cast<int>(std::count_if(choices.begin(), choices.end(), [](const Move& move) {
+        const auto rows = static_cast<int>(move.from.hash() / 4) - static_cast<int>(move.to.hash() / 4);
+        return !move.is_capture() && (rows == 1 || rows == -1);
+    }));
+}
+
+constexpr batch::Kernel all_kernels[] = {batch::Kernel::SCALAR, batch::Kernel::AVX2, batch::Kernel::AVX512};
+} // namespace
+
+TEST_CASE("Batch evaluation matches Search::evaluate_material on every kernel", "[batch]") {
+    const auto boards = playout_positions(40);
+    REQUIRE(boards.size() % 16 != 0); // exercises the scalar tail of the vector kernels
+    REQUIRE(batch::supported(batch::Kernel::SCALAR));
+    REQUIRE(batch::supported(batch::best_kernel()));
+
+    for (const auto kernel : all_kernels) {
+        std::vector<std::int32_t> scores(boards.size());
+        batch::evaluate(boards, scores, kernel);
+        for (std::size_t i = 0; i < boards.size(); ++i) {
+            REQUIRE(scores[i] == Search::evaluate_material(boards.board(i), boards.side(i)));
+        }
+    }
+}
+
+TEST_CASE("Batch mobility counts single-square steps on every kernel", "[batch]") {
+    std::mt19937 rng(7);
+    BoardBatch boards;
+    std::vector<std::int32_t> expected;
+    for (std::size_t g = 0; g < 40; ++g) {
+        Game game;
+        for (std::size_t ply = 0; ply < 150 && game.move_count() > 0; ++ply) {
+            const auto choices = game.choices();
+            // With a capture pending the step moves are not legal, so Game cannot count them
+            if (std::none_of(choices.begin(), choices.end(), [](const Move& m) { return m.is_capture(); })) {
+                boards.push_back(game.board(), game.player());
+                expected.push_back(single_steps(game));
+            }
+            game.select_move(std::uniform_int_distribution<std::size_t>(0, game.move_count() - 1)(rng));
+        }
+    }
+    REQUIRE(boards.size() > 100);
+
+    for (const auto kernel : all_kernels) {
+        std::vector<std::int32_t> counts(boards.size());
+        batch::mobility(boards, counts, kernel);
+        REQUIRE(counts == expected);
+    }
+
+    // The start position: only pions, every step is a move
+    BoardBatch start;
+    const Game game;
+    start.push_back(game.board(), game.player());
+    std::vector<std::int32_t> count(1);
+    batch::mobility(start, count);
+    REQUIRE(count[0] == static_cast<std::int32_t>(game.move_count()));
+}
+
+TEST_CASE("Batch popcount and output checks", "[batch]") {
+    std::mt19937 rng(1);
+    std::vector<std::uint32_t> masks(1000);
+    for (auto& mask : masks) mask = static_cast<std::uint32_t>(rng());
+    masks[0] = 0;
+    masks[1] = 0xFFFFFFFFu;
+
+    for (const auto kernel : all_kernels) {
+        std::vector<std::int32_t> counts(masks.size());
+        batch::popcount(masks, counts, kernel);
+        for (std::size_t i = 0; i < masks.size(); ++i) REQUIRE(counts[i] == std::popcount(masks[i]));
+    }
+
+    const auto boards = playout_positions(1);
+    REQUIRE(boards.board(3).occ_bits() == boards.occ()[3]);
+    std::vector<std::int32_t> small(boards.size() - 1);
+    REQUIRE_THROWS_AS(batch::evaluate(boards, small), std::invalid_argument);
+    REQUIRE_THROWS_AS(batch::mobility(boards, small), std::invalid_argument);
+    REQUIRE_THROWS_AS(batch::popcount(masks, small), std::invalid_argument);
+}
+
+TEST_CASE("generate_moves lists the choices of Game without one", "[batch][moves]") {
+    std::mt19937 rng(3);
+    MoveList moves;
+    for (std::size_t g = 0; g < 40; ++g) {
+        Game game;
+        for (std::size_t ply = 0; ply < 150 && game.move_count() > 0; ++ply) {
+            generate_moves(game.board(), game.player(), moves);
+            REQUIRE(std::ranges::equal(moves, game.choices()));
+            game.select_move(std::uniform_int_distribution<std::size_t>(0, moves.size() - 1)(rng));
+        }
+    }
+}
+
+TEST_CASE("Batch move generation fills one buffer with every position's moves", "[batch][moves]") {
+    const auto boards = playout_positions(40);
+    std::vector<Move> expected;
+    std::vector<std::size_t> expected_offsets{0};
+    MoveList moves;
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+        generate_moves(boards.board(i), boards.side(i), moves);
+        expected.insert(expected.end(), moves.begin(), moves.end());
+        expected_offsets.push_back(expected.size());
+    }
+
+    std::vector<Move> buffer(expected.size());
+    std::vector<std::size_t> offsets(boards.size() + 1);
+    REQUIRE(batch::generate_moves(boards, buffer, offsets) == boards.size());
+    REQUIRE(buffer == expected);
+    REQUIRE(offsets == expected_offsets);
+
+    // A buffer that fills up stops at a position boundary; the rest follows from there
+    std::vector<Move> half(expected.size() / 2);
+    const auto written = batch::generate_moves(boards, half, offsets);
+    REQUIRE(written < boards.size());
+    REQUIRE(offsets[written] == expected_offsets[written]);
+    REQUIRE(expected_offsets[written + 1] > half.size());
+    REQUIRE(std::equal(half.begin(), half.begin() + static_cast<std::ptrdiff_t>(offsets[written]), expected.begin()));
+    REQUIRE(batch::generate_moves(boards, buffer, offsets, written) == boards.size() - written);
+    REQUIRE(offsets.front() == 0);
+    REQUIRE(offsets[boards.size() - written] == expected.size() - expected_offsets[written]);
+
+    std::vector<std::size_t> short_offsets(boards.size());
+    REQUIRE_THROWS_AS(batch::generate_moves(boards, buffer, short_offsets), std::invalid_argument);
+    REQUIRE_THROWS_AS(batch::generate_moves(boards, buffer, offsets, boards.size() + 1), std::invalid_argument);
+
+    // Threads sharing the batch, each with its own buffers
+    std::vector<std::vector<Move>> results(4, std::vector<Move>(expected.size()));
+    std::vector<std::thread> threads;
+    for (auto& result : results) {
+        threads.emplace_back([&boards, &result] {
+            std::vector<std::size_t> own_offsets(boards.size() + 1);
+            for (int round = 0; round < 10; ++round) batch::generate_moves(boards, result, own_offsets);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto& result : results) REQUIRE(result == expected);
+}
@@ -0,0 +1,128 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Bitboard.h"
+#include "BoardFormat.h"
+#include "Game.h"
+#include "Playout.h"
+#include "TestBoards.h"
+
+namespace {
+using board_format::Entry;
+
+// Every position of a few fixed-seed random games, dames and captures included
+std::vector<Entry> game_positions() {
+    std::vector<Entry> entries;
+    for (std::uint64_t seed = 0; seed < 20; ++seed) {
+        playout::Random random(seed);
+        Game game;
+        while (game.move_count() > 0 && game.get_move_sequence().size() < 300) {
+            entries.push_back({game.board(), game.player()});
+            game.select_move(random.below(game.move_count()));
+        }
+        entries.push_back({game.board(), game.player()});
+    }
+    return entries;
+}
+} // namespace
+
+TEST_CASE("Mask extract and deposit match the per-bit definition", "[format]") {
+    for (std::uint64_t seed = 0; seed < 200; ++seed) {
+        playout::Random random(seed);
+        const auto value = static_cast<bitboard::Mask>(random.next());
+        const auto mask = static_cast<bitboard::Mask>(random.next());
+        bitboard::Mask expected = 0;
+        std::size_t out = 0;
+        for (std::size_t square = 0; square < bitboard::square_count; ++square) {
+            if ((mask & bitboard::bit(square)) == 0u) continue;
+            if ((value & bitboard::bit(square)) != 0u) expected |= bitboard::bit(out);
+            ++out;
+        }
+        REQUIRE(bitboard::extract(value, mask) == expected);
+        REQUIRE(bitboard::deposit(expected, mask) == (value & mask));
+    }
+    REQUIRE(bitboard::lowest_squares(0xF0F0u, 5) == 0x10F0u);
+    REQUIRE(bitboard::lowest_squares(0xF0F0u, 16) == 0xF0F0u);
+}
+
+TEST_CASE("Board hashes still round-trip", "[format]") {
+    for (const auto& [board, side] : game_positions()) REQUIRE(Board::from_hash(board.hash()) == board);
+}
+
+TEST_CASE("Text positions round-trip", "[format]") {
+    REQUIRE(board_format::to_text(Board::setup(), PieceColor::WHITE) == "bbbb/bbbb/4/4/4/4/wwww/wwww w");
+    REQUIRE(board_format::from_text("  bbbb/bbbb/4/4/4/4/wwww/wwww w\n") == Entry{Board::setup(), PieceColor::WHITE});
+    REQUIRE(board_format::to_text(Board{}, PieceColor::BLACK) == "4/4/4/4/4/4/4/4 b");
+
+    const auto entries = game_positions();
+    std::string text;
+    board_format::append_text(entries, text);
+    std::vector<Entry> parsed;
+    board_format::parse_text(text, parsed);
+    REQUIRE(parsed == entries);
+    for (const auto& [board, side] : entries) {
+        const auto single = board_format::to_text(board, side);
+        REQUIRE(single.size() <= board_format::MAX_TEXT_SIZE);
+        REQUIRE(board_format::from_text(single) == Entry{board, side});
+    }
+}
+
+TEST_CASE("Malformed text positions are rejected", "[format]") {
+    for (const char* text : {"", "bbbb/bbbb/4/4/4/4/wwww/wwww", "bbbb/bbbb/4/4/4/4/wwww/wwww x",
+                             "bbbb/bbbb/4/4/4/4/wwww w", "bbbbb/bbb/4/4/4/4/wwww/wwww w",
+                             "bbbb/bbbb/5/4/4/4/wwww/wwww w", "bbbb/bbxb/4/4/4/4/wwww/wwww w",
+                             "bbbb/bbbb/4/4/4/4/wwww/wwww w extra"}) {
+        REQUIRE_THROWS_AS(board_format::from_text(text), std::invalid_argument);
+    }
+
+    std::vector<Entry> parsed;
+    REQUIRE_THROWS_AS(board_format::parse_text("4/4/4/4/4/4/4/4 w\n\nbbbb/4 w\n", parsed), std::invalid_argument);
+    REQUIRE(parsed.size() == 1);
+}
+
+TEST_CASE("Packed positions round-trip with every kernel", "[format]") {
+    const auto entries = game_positions();
+    std::vector<std::uint8_t> expected(entries.size() * board_format::PACKED_SIZE);
+    board_format::pack(entries, expected, board_format::Kernel::SCALAR);
+
+    for (const auto kernel : {board_format::Kernel::SCALAR, board_format::Kernel::BMI2}) {
+        if (!board_format::supported(kernel)) continue;
+        std::vector<std::uint8_t> packed(expected.size());
+        board_format::pack(entries, packed, kernel);
+        REQUIRE(packed == expected);
+        std::vector<Entry> unpacked(entries.size());
+        board_format::unpack(packed, unpacked, kernel);
+        REQUIRE(unpacked == entries);
+    }
+
+    // Set bits above the two per-piece fields
+    std::vector<std::uint8_t> damaged(expected.begin(), expected.begin() + board_format::PACKED_SIZE);
+    damaged.back() = 0x80;
+    std::vector<Entry> one(1);
+    REQUIRE_THROWS_AS(board_format::unpack(damaged, one), std::invalid_argument);
+    std::vector<std::uint8_t> small(board_format::PACKED_SIZE);
+    REQUIRE_THROWS_AS(board_format::pack(entries, small), std::invalid_argument);
+
+    Board full;
+    full.set_from_masks(0xFFFFFFFFu, 0, 0);
+    REQUIRE_THROWS_AS(board_format::pack(std::vector<Entry>{{full, PieceColor::WHITE}}, small), std::invalid_argument);
+}
+
+TEST_CASE("Packed position files round-trip", "[format]") {
+    const TempFile file("thai_checkers_positions.tcpos");
+    const auto entries = game_positions();
+    board_format::write_packed(file.path.string(), entries);
+    REQUIRE(std::filesystem::file_size(file.path) == 24 + entries.size() * board_format::PACKED_SIZE);
+    REQUIRE(board_format::read_packed(file.path.string()) == entries);
+
+    std::filesystem::resize_file(file.path, std::filesystem::file_size(file.path) - 1);
+    REQUIRE_THROWS_AS(board_format::read_packed(file.path.string()), std::runtime_error);
+    REQUIRE_THROWS_AS(board_format::read_packed(file.path.string() + ".missing"), std::runtime_error);
+}
@@ -0,0 +1,176 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "Traversal.h"
+#include "TestBoards.h"
+
+namespace {
+// Outcome and length of every game in the order the sink receives them
+struct Recorded {
+    std::vector<Traversal::ResultRecord> records;
+    Traversal traversal{[this](const Traversal::ResultBatch& batch) {
+        records.insert(records.end(), batch.records.begin(), batch.records.end());
+    }};
+};
+
+bool same_games(const std::vector<Traversal::ResultRecord>& a, const std::vector<Traversal::ResultRecord>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].length != b[i].length || a[i].winner != b[i].winner || a[i].looping != b[i].looping) return false;
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE("Checkpoint round-trips through a file", "[checkpoint]") {
+    const TempFile file("thai_checkers_checkpoint_roundtrip.tcck");
+    Checkpoint checkpoint{
+        .occ = 0xc0082201u,
+        .black = 0xc0080000u,
+        .dame = 0x00080000u,
+        .side = PieceColor::BLACK,
+        .root_length = 3,
+        .max_depth = 10,
+        .stats = {.games = 9, .black_wins = 4, .white_wins = 3, .draws = 2, .min_length = 5, .max_length = 17},
+        .transposition_hits = 1,
+        .database_hits = 2,
+        .tablebase_hits = 3,
+        .horizon_leaves = 4,
+        .path = {2, 0},
+        .next = {3, 1, 0},
+        .subtrees = {{}, {.games = 1, .black_wins = 1, .min_length = 2, .max_length = 2}, {}},
+    };
+    checkpoint.save(file.path.string());
+    const auto loaded = Checkpoint::load(file.path.string());
+    REQUIRE(loaded.occ == checkpoint.occ);
+    REQUIRE(loaded.black == checkpoint.black);
+    REQUIRE(loaded.dame == checkpoint.dame);
+    REQUIRE(loaded.side == checkpoint.side);
+    REQUIRE(loaded.root_length == checkpoint.root_length);
+    REQUIRE(loaded.max_depth == checkpoint.max_depth);
+    REQUIRE(loaded.stats == checkpoint.stats);
+    REQUIRE(loaded.transposition_hits == 1);
+    REQUIRE(loaded.database_hits == 2);
+    REQUIRE(loaded.tablebase_hits == 3);
+    REQUIRE(loaded.horizon_leaves == 4);
+    REQUIRE(loaded.path == checkpoint.path);
+    REQUIRE(loaded.next == checkpoint.next);
+    REQUIRE(loaded.subtrees == checkpoint.subtrees);
+    REQUIRE_FALSE(std::filesystem::exists(file.path.string() + ".tmp"));
+
+    checkpoint.max_depth.reset();
+    checkpoint.save(file.path.string());
+    REQUIRE_FALSE(Checkpoint::load(file.path.string()).max_depth);
+
+    // A frontier whose path disagrees with the next indices is rejected
+    checkpoint.next[0] = 1;
+    checkpoint.save(file.path.string());
+    REQUIRE_THROWS_AS(Checkpoint::load(file.path.string()), std::runtime_error);
+
+    // A frontier size the file cannot hold is rejected before anything is allocated for it
+    checkpoint.next[0] = 3;
+    checkpoint.save(file.path.string());
+    std::filesystem::resize_file(file.path, std::filesystem::file_size(file.path) - 1);
+    REQUIRE_THROWS_AS(Checkpoint::load(file.path.string()), std::runtime_error);
+    checkpoint.save(file.path.string());
+    {
+        std::fstream damaged(file.path, std::ios::binary | std::ios::in | std::ios::out);
+        damaged.seekp(40); // Header::depth
+        const auto huge = ~std::uint64_t{0} / 2;
+        damaged.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    REQUIRE_THROWS_AS(Checkpoint::load(file.path.string()), std::runtime_error);
+
+    std::ofstream(file.path, std::ios::binary | std::ios::trunc) << "not a checkpoint";
+    REQUIRE_THROWS_AS(Checkpoint::load(file.path.string()), std::runtime_error);
+}
+
+TEST_CASE("Resuming from checkpoints repeats no work", "[checkpoint][traversal]") {
+    const TempFile file("thai_checkers_checkpoint_resume.tcck");
+    for (const bool cached : {false, true}) {
+        Recorded full;
+        if (cached) full.traversal.set_transposition_table(Traversal::TranspositionMode::EXACT, 1);
+        Game full_game(small_endgame);
+        full.traversal.traverse_for(full_game);
+        REQUIRE(full.traversal.completed());
+
+        // A zero timeout stops after a single step; every run continues the previous checkpoint
+        Recorded chunked;
+        if (cached) chunked.traversal.set_transposition_table(Traversal::TranspositionMode::EXACT, 1);
+        chunked.traversal.set_checkpoint(file.path.string());
+        Game game(small_endgame);
+        chunked.traversal.traverse_for(game, std::chrono::milliseconds(0));
+        std::size_t runs = 1;
+        while (!chunked.traversal.completed()) {
+            REQUIRE(game.get_move_sequence().empty());
+            const auto checkpoint = Checkpoint::load(file.path.string());
+            REQUIRE_FALSE(checkpoint.finished());
+            REQUIRE(checkpoint.stats == chunked.traversal.statistics());
+            chunked.traversal.resume_for(game, checkpoint, std::chrono::milliseconds(0));
+            ++runs;
+        }
+        REQUIRE(runs > 10);
+        REQUIRE(chunked.traversal.statistics() == full.traversal.statistics());
+        REQUIRE(same_games(chunked.records, full.records));
+        REQUIRE(Checkpoint::load(file.path.string()).finished());
+    }
+}
+
+TEST_CASE("Failed periodic checkpoint saves do not stop the traversal", "[checkpoint][traversal]") {
+    const auto missing = std::filesystem::temp_directory_path() / "thai_checkers_missing_dir" / "run.tcck";
+    Traversal traversal;
+    traversal.set_max_nodes(20000);
+    traversal.set_checkpoint(missing.string(), std::chrono::milliseconds(0));
+    Game game;
+    // Only the final save, which has no later interval to retry in, throws
+    REQUIRE_THROWS_AS(traversal.traverse_for(game), std::runtime_error);
+    REQUIRE(traversal.checkpoint_failures() > 1);
+    REQUIRE_FALSE(traversal.checkpoint_error().empty());
+}
+
+TEST_CASE("Resuming requires the checkpoint's root and a single thread", "[checkpoint][traversal]") {
+    const TempFile file("thai_checkers_checkpoint_root.tcck");
+    Traversal traversal;
+    traversal.set_checkpoint(file.path.string());
+    Game game(small_endgame);
+    traversal.traverse_for(game, std::chrono::milliseconds(0));
+    const auto checkpoint = Checkpoint::load(file.path.string());
+    REQUIRE(checkpoint.matches(small_endgame, PieceColor::WHITE, 0));
+
+    Game other;
+    REQUIRE_THROWS_AS(traversal.resume_for(other, checkpoint), std::invalid_argument);
+
+    traversal.set_threads(2);
+    REQUIRE_THROWS_AS(traversal.traverse_for(game), std::invalid_argument);
+    REQUIRE_THROWS_AS(traversal.resume_for(game, checkpoint), std::invalid_argument);
+}
+
+TEST_CASE("Resuming requires the checkpoint's depth limit", "[checkpoint][traversal]") {
+    const TempFile file("thai_checkers_checkpoint_depth.tcck");
+    Traversal traversal;
+    traversal.set_checkpoint(file.path.string());
+    traversal.set_max_depth(4);
+    Game game(small_endgame);
+    traversal.traverse_for(game, std::chrono::milliseconds(0));
+    const auto checkpoint = Checkpoint::load(file.path.string());
+    REQUIRE(checkpoint.max_depth == 4u);
+
+    for (const auto other : {std::optional<std::size_t>{}, std::optional<std::size_t>{5}}) {
+        traversal.set_max_depth(other);
+        REQUIRE_THROWS_AS(traversal.resume_for(game, checkpoint), std::invalid_argument);
+    }
+    traversal.set_max_depth(4);
+    traversal.resume_for(game, checkpoint);
+    REQUIRE(traversal.completed());
+}
@@ -0,0 +1,147 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "GameRecords.h"
+#include "Traversal.h"
+#include "TestBoards.h"
+
+namespace {
+struct Played {
+    std::uint32_t length;
+    std::optional<PieceColor> winner;
+    bool looping;
+    std::vector<std::uint8_t> moves;
+
+    bool operator==(const Played&) const = default;
+};
+
+// Traverses the small endgame into a writer, returning every game the sink saw per worker
+std::vector<std::vector<Played>> write_games(GameRecordWriter& writer, std::size_t threads, bool histories) {
+    std::mutex mutex;
+    std::vector<std::vector<Played>> games(threads);
+    auto forward = writer.sink();
+    Traversal traversal([&](const Traversal::ResultBatch& batch) {
+        {
+            const std::lock_guard lock(mutex);
+            for (const auto& record : batch.records) {
+                const auto moves = batch.history(record);
+                games[batch.worker].push_back(
+                    {record.length, record.winner, record.looping, {moves.begin(), moves.end()}});
+            }
+        }
+        forward(batch);
+    });
+    traversal.set_threads(threads);
+    traversal.set_split_depth(2);
+    traversal.set_result_batch_size(7);
+    traversal.set_record_histories(histories);
+    Game game(small_endgame);
+    traversal.traverse_for(game);
+    writer.close();
+    return games;
+}
+
+std::vector<std::vector<Played>> read_games(const std::string& filename, std::size_t threads) {
+    GameRecordReader reader(filename);
+    std::vector<std::vector<Played>> games(threads);
+    while (const auto record = reader.next()) {
+        games.at(reader.worker()).push_back(
+            {record->length, record->winner, record->looping, {record->moves.begin(), record->moves.end()}});
+    }
+    return games;
+}
+} // namespace
+
+TEST_CASE("Game records round-trip every game with its moves", "[records]") {
+    for (const std::size_t threads : {1u, 4u}) {
+        for (const std::size_t block_bytes : {std::size_t{16}, GameRecordWriter::DEFAULT_BLOCK_BYTES}) {
+            const TempFile file("thai_checkers_records_test.bin");
+            GameRecordWriter writer(file.path.string(), {.block_bytes = block_bytes});
+            const auto expected = write_games(writer, threads, true);
+
+            std::size_t total = 0;
+            for (const auto& games : expected) total += games.size();
+            REQUIRE(total > 0);
+            REQUIRE(writer.records() == total);
+            REQUIRE(writer.bytes() == std::filesystem::file_size(file.path));
+            REQUIRE(read_games(file.path.string(), threads) == expected);
+            REQUIRE(GameRecordReader(file.path.string()).stored_records() == total);
+        }
+    }
+}
+
+TEST_CASE("Shared prefixes keep game records small", "[records]") {
+    const TempFile file("thai_checkers_records_prefix_test.bin");
+    GameRecordWriter writer(file.path.string());
+    const auto expected = write_games(writer, 1, true);
+
+    std::size_t plies = 0;
+    for (const auto& game : expected[0]) plies += game.length;
+    // The games of this tree are only a few plies long and one block still beats a flat encoding
+    // (a byte per ply plus outcome and length bytes per game) by a third
+    const auto payload = writer.bytes() - 32 - 16;
+    REQUIRE(payload * 3 < (plies + 2 * expected[0].size()) * 2);
+}
+
+TEST_CASE("Game records without histories keep outcomes and lengths", "[records]") {
+    const TempFile file("thai_checkers_records_outcomes_test.bin");
+    GameRecordWriter writer(file.path.string());
+    const auto expected = write_games(writer, 1, false);
+    const auto games = read_games(file.path.string(), 1);
+    REQUIRE(games == expected);
+    for (const auto& game : games[0]) REQUIRE(game.moves.empty());
+}
+
+TEST_CASE("Sampled game records keep every n-th game of a worker", "[records]") {
+    const TempFile file("thai_checkers_records_sample_test.bin");
+    GameRecordWriter writer(file.path.string(), {.sample_every = 3});
+    const auto all = write_games(writer, 1, true);
+    std::vector<Played> expected;
+    for (std::size_t i = 0; i < all[0].size(); i += 3) expected.push_back(all[0][i]);
+    REQUIRE(read_games(file.path.string(), 1)[0] == expected);
+}
+
+TEST_CASE("Compressed game records round-trip when zstd is available", "[records]") {
+    const TempFile file("thai_checkers_records_zstd_test.bin");
+    if (!game_records::compression_available()) {
+        REQUIRE_THROWS_AS(GameRecordWriter(file.path.string(), {.compress = true}), std::invalid_argument);
+        return;
+    }
+    GameRecordWriter writer(file.path.string(), {.block_bytes = 256, .compress = true});
+    const auto expected = write_games(writer, 2, true);
+    REQUIRE(GameRecordReader(file.path.string()).compressed());
+    REQUIRE(read_games(file.path.string(), 2) == expected);
+}
+
+TEST_CASE("Damaged game record files are rejected", "[records]") {
+    const TempFile file("thai_checkers_records_damaged_test.bin");
+    {
+        GameRecordWriter writer(file.path.string());
+        write_games(writer, 1, true);
+    }
+
+    // Cut into the last block
+    std::filesystem::resize_file(file.path, std::filesystem::file_size(file.path) - 5);
+    GameRecordReader reader(file.path.string());
+    REQUIRE_THROWS_AS(
+        [&] {
+            while (reader.next()) {
+            }
+        }(),
+        std::runtime_error);
+
+    // Not a record file at all
+    std::filesystem::resize_file(file.path, 10);
+    REQUIRE_THROWS_AS(GameRecordReader(file.path.string()), std::runtime_error);
+    REQUIRE_THROWS_AS(GameRecordReader((file.path.string() + ".missing")), std::runtime_error);
+}
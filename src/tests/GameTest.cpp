@@ -0,0 +1,180 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Game.h"
+#include "RepetitionTable.h"
+
+TEST_CASE("Undo restores boards and move counts along a long line", "[game][undo]") {
+    Game game;
+    std::vector<Board> boards{game.board()};
+    std::vector<std::size_t> counts;
+    while (game.move_count() != 0 && boards.size() < 200) {
+        const auto mc = game.move_count();
+        counts.push_back(mc);
+        game.select_move((boards.size() * 7) % mc);
+        boards.push_back(game.board());
+    }
+
+    while (!game.get_move_sequence().empty()) {
+        REQUIRE(game.board() == boards.back());
+        boards.pop_back();
+        game.undo_move();
+        REQUIRE(game.board() == boards.back());
+        REQUIRE(game.move_count() == counts.back());
+        REQUIRE_FALSE(game.is_looping());
+        counts.pop_back();
+    }
+    REQUIRE(game.board() == Board::setup());
+}
+
+TEST_CASE("Move delta round-trips captures and promotion", "[game][undo]") {
+    const auto mask = [](const Position& p) { return std::uint32_t{1} << p.hash(); };
+    // White pion on D3 jumps the black pion on C2 and lands on the back row
+    const auto white = Position{"D3"};
+    const auto black = Position{"C2"};
+    const auto landing = Position{"B1"};
+    Board board;
+    board.set_from_masks(mask(white) | mask(black), mask(black), 0);
+    const Move jump{.from = white, .to = landing, .captured = mask(black)};
+
+    const auto before = board;
+    const auto delta = board.move_delta(jump);
+    board.apply_delta(delta);
+    REQUIRE_FALSE(board.is_occupied(white));
+    REQUIRE_FALSE(board.is_occupied(black));
+    REQUIRE(board.is_occupied(landing));
+    REQUIRE(board.is_dame_piece(landing));
+    REQUIRE_FALSE(board.is_black_piece(landing));
+
+    board.apply_delta(delta);
+    REQUIRE(board == before);
+}
+
+TEST_CASE("Incremental Zobrist key matches a full recomputation", "[game][zobrist]") {
+    const auto recomputed = [](const Board& b) {
+        Board fresh;
+        fresh.set_from_masks(b.occ_bits(), b.black_bits(), b.dame_bits());
+        return fresh.zobrist();
+    };
+
+    Game game;
+    std::size_t ply = 0;
+    while (game.move_count() != 0) {
+        game.select_move((ply * 5 + 3) % game.move_count());
+        ++ply;
+        REQUIRE(game.board().zobrist() == recomputed(game.board()));
+    }
+    while (!game.get_move_sequence().empty()) {
+        game.undo_move();
+        REQUIRE(game.board().zobrist() == recomputed(game.board()));
+    }
+    REQUIRE(game.board().zobrist() == Board::setup().zobrist());
+
+    Board board = Board::setup();
+    board.move_piece(Position{"B7"}, Position{"A6"});
+    board.promote_piece(Position{"A6"});
+    board.remove_piece(Position{"B1"});
+    REQUIRE(board.is_dame_piece(Position{"A6"}));
+    REQUIRE_FALSE(board.is_occupied(Position{"B1"}));
+    REQUIRE(board.zobrist() == recomputed(board));
+}
+
+TEST_CASE("RepetitionTable counts like a reference multiset under push/pop", "[game][repetition]") {
+    // Few distinct keys sharing one home slot force long clusters and backward shifts on erase
+    std::vector<zobrist::Key> keys;
+    for (std::uint64_t i = 0; i < 600; ++i) keys.push_back(((i * 7) % 23) << 40 | (i % 5));
+
+    RepetitionTable table;
+    std::unordered_map<zobrist::Key, std::uint32_t> reference;
+    for (const auto key : keys) REQUIRE(table.push(key) == ++reference[key]);
+    for (auto it = keys.rbegin(); it != keys.rend(); ++it) {
+        table.pop(*it);
+        --reference[*it];
+        for (const auto& [key, count] : reference) REQUIRE(table.count(key) == count);
+    }
+    REQUIRE(table.size() == 0);
+}
+
+TEST_CASE("Copies replay the original and share no state with it", "[game][copy]") {
+    Game game;
+    std::vector<Board> boards{game.board()};
+    while (game.move_count() != 0 && boards.size() < 120) {
+        game.select_move((boards.size() * 5) % game.move_count());
+        boards.push_back(game.board());
+    }
+    const auto length = game.get_move_sequence().size();
+
+    // A fresh copy, and a copy into a game that held a longer, unrelated path
+    const Game fresh = Game::copy(game);
+    Game reused;
+    for (std::size_t ply = 0; ply < 150 && reused.move_count() != 0; ++ply) reused.select_move(0);
+    reused.copy_from(game);
+    for (const Game* copy : {&fresh, static_cast<const Game*>(&reused)}) {
+        REQUIRE(copy->board() == game.board());
+        REQUIRE(copy->get_move_sequence() == game.get_move_sequence());
+        REQUIRE(copy->position_key() == game.position_key());
+        REQUIRE(std::ranges::equal(copy->choices(), game.choices()));
+    }
+
+    // Undoing the copy regenerates the ancestors' choices; the original is untouched
+    for (std::size_t ply = length; ply > length / 2; --ply) {
+        reused.undo_move();
+        REQUIRE(reused.board() == boards[ply - 1]);
+    }
+    Game replay;
+    for (std::size_t ply = 0; ply < length / 2; ++ply) replay.select_move(game.get_move_sequence()[ply]);
+    REQUIRE(std::ranges::equal(reused.choices(), replay.choices()));
+    REQUIRE(game.board() == boards.back());
+    REQUIRE(game.get_move_sequence().size() == length);
+
+    reused.rewind(0);
+    REQUIRE(reused.board() == Board::setup());
+    REQUIRE(reused.get_move_sequence().empty());
+}
+
+TEST_CASE("Copies keep the repetition counts of the path", "[game][copy]") {
+    const auto mask = [](const char* square) { return std::uint32_t{1} << Position{square}.hash(); };
+    const auto play = [](Game& game, const char* from, const char* to) {
+        const auto choices = game.choices();
+        const auto it = std::ranges::find_if(
+            choices, [&](const Move& move) { return move.from == Position{from} && move.to == Position{to}; });
+        REQUIRE(it != choices.end());
+        game.select_move(static_cast<std::size_t>(it - choices.begin()));
+    };
+    // A white and a black dame stepping out and back: the start position recurs every 4 plies
+    const auto cycle = [&](Game& game) {
+        play(game, "B1", "C2");
+        play(game, "G8", "F7");
+        play(game, "C2", "B1");
+        play(game, "F7", "G8");
+    };
+
+    Board board;
+    board.set_from_masks(mask("B1") | mask("G8"), mask("G8"), mask("B1") | mask("G8"));
+    Game game(board);
+    cycle(game);
+    REQUIRE_FALSE(game.is_looping());
+
+    // The copy has seen the start position twice, so one more cycle ends its game
+    Game copy;
+    copy.copy_from(game);
+    cycle(copy);
+    REQUIRE(copy.is_looping());
+    REQUIRE(copy.move_count() == 0);
+    REQUIRE_FALSE(game.is_looping());
+    copy.undo_move();
+    REQUIRE_FALSE(copy.is_looping());
+
+    // Copying over a path that already repeated the start position drops those counts
+    Game overwritten(board);
+    cycle(overwritten);
+    overwritten.copy_from(Game(board));
+    cycle(overwritten);
+    REQUIRE_FALSE(overwritten.is_looping());
+}
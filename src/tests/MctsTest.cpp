@@ -0,0 +1,101 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Mcts.h"
+#include "Search.h"
+#include "TestBoards.h"
+
+namespace {
+// Exact game value for the side to move: 1 win, 0 draw, -1 loss
+int solve(Game& game) {
+    if (game.is_looping()) return 0;
+    const auto move_count = game.move_count();
+    if (move_count == 0) return -1;
+    int best = -1;
+    for (std::size_t i = 0; i < move_count; ++i) {
+        game.select_move(i);
+        best = std::max(best, -solve(game));
+        game.undo_move();
+    }
+    return best;
+}
+
+Mcts::Limits iterations(std::uint64_t count) {
+    Mcts::Limits limits;
+    limits.iterations = count;
+    return limits;
+}
+} // namespace
+
+TEST_CASE("MCTS finds the winning move of a small tree", "[mcts]") {
+    Game game(board_of({"H5", "E8", "G8"}, {"B1", "D3", "C4"}));
+    REQUIRE(solve(game) == 1);
+
+    Mcts mcts(1);
+    const auto result = mcts.run(game, iterations(20000));
+    REQUIRE(result.iterations == 20000);
+    REQUIRE(result.best_move);
+    REQUIRE(game.get_move_sequence().empty());
+    REQUIRE(game.choices()[result.best_index] == *result.best_move);
+    REQUIRE(result.pv.front() == *result.best_move);
+    REQUIRE(result.value > 0.5);
+
+    game.select_move(result.best_index);
+    REQUIRE(solve(game) == -1); // the opponent is lost
+}
+
+TEST_CASE("MCTS reuses the subtree of the moves played", "[mcts]") {
+    Game game;
+    Mcts mcts(16);
+    const auto first = mcts.run(game, iterations(5000));
+    REQUIRE(first.reused == 0);
+    REQUIRE(first.nodes > 1);
+    REQUIRE(first.nodes <= mcts.capacity());
+
+    // Our move and the most visited reply: both nodes are expanded, so their statistics carry over
+    game.select_move(first.best_index);
+    const auto reply = std::find(game.choices().begin(), game.choices().end(), first.pv[1]) - game.choices().begin();
+    game.select_move(static_cast<std::size_t>(reply));
+    const auto second = mcts.run(game, iterations(1000));
+    REQUIRE(second.reused > 0);
+    REQUIRE(game.get_move_sequence().size() == 2);
+
+    // Another game from a different position starts over
+    Game other(board_of({"H5", "E8", "G8"}, {"B1", "D3", "C4"}));
+    REQUIRE(mcts.run(other, iterations(100)).reused == 0);
+
+    mcts.clear();
+    REQUIRE(mcts.size() == 1);
+    REQUIRE_THROWS_AS(mcts.run(game, Mcts::Limits{}), std::invalid_argument);
+}
+
+TEST_CASE("MCTS stays within its memory limit", "[mcts]") {
+    Game game;
+    Mcts mcts(0); // the smallest arena: the root and its children
+    const auto result = mcts.run(game, iterations(2000));
+    REQUIRE(result.tree_full);
+    REQUIRE(result.nodes <= mcts.capacity());
+    REQUIRE(result.iterations == 2000);
+    REQUIRE(result.best_move);
+}
+
+TEST_CASE("Tree-parallel threads share one tree", "[mcts][parallel]") {
+    Game game;
+    Mcts mcts(16);
+    mcts.set_threads(4);
+    const auto result = mcts.run(game, iterations(8000));
+    REQUIRE(result.iterations == 8000);
+    REQUIRE(game.get_move_sequence().empty());
+    REQUIRE(std::find(game.choices().begin(), game.choices().end(), *result.best_move) != game.choices().end());
+
+    // A solved position is still found with several threads
+    Game endgame(board_of({"H5", "E8", "G8"}, {"B1", "D3", "C4"}));
+    const auto solved = mcts.run(endgame, iterations(20000));
+    endgame.select_move(solved.best_index);
+    REQUIRE(solve(endgame) == -1);
+}
@@ -0,0 +1,54 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Perft.h"
+
+namespace {
+// Reference count that makes every move, including the last ply
+std::uint64_t slow_perft(Game& game, std::size_t depth) {
+    if (depth == 0) return 1;
+    std::uint64_t nodes = 0;
+    for (std::size_t i = 0; i < game.move_count(); ++i) {
+        game.select_move(i);
+        nodes += slow_perft(game, depth - 1);
+        game.undo_move();
+    }
+    return nodes;
+}
+} // namespace
+
+TEST_CASE("Perft bulk counting matches making every move", "[perft]") {
+    Game game;
+    REQUIRE(perft::perft(game, 0) == 1);
+    REQUIRE(perft::perft(game, 1) == 7);
+    for (std::size_t depth = 1; depth <= 6; ++depth) {
+        Game reference;
+        REQUIRE(perft::perft(game, depth) == slow_perft(reference, depth));
+        REQUIRE(game.get_move_sequence().empty());
+    }
+}
+
+TEST_CASE("Perft reproduces the start position node counts", "[perft]") {
+    // Regression values: any change here means move generation changed
+    constexpr std::array<std::uint64_t, 8> expected = {1, 7, 49, 392, 3136, 26592, 218695, 1820189};
+    Game game;
+    for (std::size_t depth = 0; depth < expected.size(); ++depth) REQUIRE(perft::perft(game, depth) == expected[depth]);
+}
+
+TEST_CASE("Divide splits perft by root move", "[perft][divide]") {
+    Game game;
+    const auto entries = perft::divide(game, 5);
+    REQUIRE(entries.size() == game.move_count());
+
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        REQUIRE(entries[i].move == game.choices()[i]);
+        total += entries[i].nodes;
+    }
+    REQUIRE(total == perft::perft(game, 5));
+    REQUIRE(perft::divide(game, 0).empty());
+}
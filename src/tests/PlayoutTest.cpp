@@ -0,0 +1,102 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Playout.h"
+#include "TestBoards.h"
+
+TEST_CASE("Random draws stay in range and depend on the seed", "[playout]") {
+    playout::Random random(1);
+    playout::Random same(1);
+    playout::Random other(2);
+    bool differs = false;
+    std::uint64_t seen = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const auto value = random.next();
+        REQUIRE(value == same.next());
+        differs = differs || value != other.next();
+        const auto index = random.below(7);
+        REQUIRE(index == same.below(7));
+        REQUIRE(index < 7);
+        seen |= std::uint64_t{1} << index;
+    }
+    REQUIRE(differs);
+    REQUIRE(seen == 0x7F);
+}
+
+TEST_CASE("A playout rewinds the game and records its outcome", "[playout]") {
+    Game game;
+    game.select_move(0);
+    const auto key = game.position_key();
+    playout::Random random(7);
+    const auto outcome = playout::play(game, random, 1000);
+    REQUIRE(game.get_move_sequence().size() == 1);
+    REQUIRE(game.position_key() == key);
+    REQUIRE(outcome.length > 0);
+
+    // A root without moves is a finished game of length 0, lost by the side to move (white)
+    Game stuck(board_of({"B1"}, {"A2"}));
+    REQUIRE(stuck.move_count() == 0);
+    const auto lost = playout::play(stuck, random, 1000);
+    REQUIRE(lost.finished);
+    REQUIRE(lost.length == 0);
+    REQUIRE(lost.winner == PieceColor::BLACK);
+
+    // The ply limit gives up the game
+    const auto cut = playout::play(game, random, 3);
+    REQUIRE(!cut.finished);
+    REQUIRE(cut.length == 3);
+
+    playout::Statistics stats;
+    stats.record(outcome);
+    stats.record(lost);
+    stats.record(cut);
+    REQUIRE(stats.playouts() == 3);
+    REQUIRE(stats.unfinished == 1);
+    REQUIRE(stats.outcomes.games == 2);
+    REQUIRE(stats.plies == outcome.length + 3);
+    REQUIRE(stats.lengths[0] == 1);
+    REQUIRE(stats.lengths[outcome.length] == 1);
+}
+
+TEST_CASE("Playout statistics do not depend on the thread count", "[playout][parallel]") {
+    const Game game;
+    playout::Limits limits;
+    limits.playouts = 500;
+    playout::Options options;
+    options.seed = 12345;
+
+    const auto serial = playout::run(game, limits, options);
+    REQUIRE(serial.stats.playouts() == 500);
+    REQUIRE(serial.stats.outcomes.games > 0);
+    REQUIRE(serial.stats.outcomes.black_wins + serial.stats.outcomes.white_wins > 0);
+    std::uint64_t histogram_games = 0;
+    for (const auto count : serial.stats.lengths) histogram_games += count;
+    REQUIRE(histogram_games == serial.stats.outcomes.games);
+    REQUIRE(serial.stats.mean_length() >= static_cast<double>(serial.stats.outcomes.min_length));
+
+    options.threads = 4;
+    const auto parallel = playout::run(game, limits, options);
+    REQUIRE(parallel.stats == serial.stats);
+
+    options.seed = 54321;
+    REQUIRE(playout::run(game, limits, options).stats != serial.stats);
+}
+
+TEST_CASE("Timed playouts stop at the deadline", "[playout]") {
+    const Game game;
+    playout::Limits limits;
+    limits.time = std::chrono::milliseconds(100);
+    playout::Options options;
+    options.threads = 2;
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = playout::run(game, limits, options);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+    REQUIRE(result.stats.playouts() > 0);
+    REQUIRE(result.playouts_per_second() > 0);
+
+    REQUIRE_THROWS_AS(playout::run(game, playout::Limits{}), std::invalid_argument);
+}
@@ -0,0 +1,94 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "PositionDatabase.h"
+#include "Traversal.h"
+#include "TestBoards.h"
+
+TEST_CASE("Position database finds written records", "[database]") {
+    const TempFile file("thai_checkers_db_records.tcdb");
+    const auto first = board_of({"B3"}, {"C6"});
+    const auto second = board_of({"D3"}, {"E6"});
+    const TraversalStatistics stats{
+        .games = 7, .black_wins = 3, .white_wins = 2, .draws = 2, .min_length = 1, .max_length = 6};
+
+    PositionDatabase::write(file.path.string(), {
+                                                    PositionDatabase::Record::of(second, PieceColor::BLACK, stats),
+                                                    PositionDatabase::Record::of(first, PieceColor::WHITE, stats),
+                                                    PositionDatabase::Record::of(first, PieceColor::WHITE, {}),
+                                                });
+
+    const auto database = PositionDatabase::open(file.path.string());
+    REQUIRE(database.size() == 2);
+    REQUIRE(database.find(first, PieceColor::WHITE) == stats);
+    REQUIRE(database.find(second, PieceColor::BLACK) == stats);
+    REQUIRE_FALSE(database.find(first, PieceColor::BLACK).has_value());
+    REQUIRE_FALSE(database.find(Board::setup(), PieceColor::WHITE).has_value());
+}
+
+TEST_CASE("Canonical position databases store mirrored positions once", "[database]") {
+    const TempFile file("thai_checkers_db_canonical.tcdb");
+    const auto board = board_of({"B3", "D3"}, {"C6"});
+    const TraversalStatistics stats{
+        .games = 7, .black_wins = 3, .white_wins = 2, .draws = 2, .min_length = 1, .max_length = 6};
+
+    PositionDatabase::write(file.path.string(),
+                            {
+                                PositionDatabase::Record::of(board, PieceColor::BLACK, stats),
+                                PositionDatabase::Record::of(board.mirrored(), PieceColor::WHITE, stats.mirrored()),
+                            },
+                            true);
+
+    const auto database = PositionDatabase::open(file.path.string());
+    REQUIRE(database.canonical());
+    REQUIRE(database.size() == 1);
+    REQUIRE(database.records()[0].side == to_underlying(PieceColor::WHITE));
+    REQUIRE(database.find(board, PieceColor::BLACK) == stats);
+    REQUIRE(database.find(board.mirrored(), PieceColor::WHITE) == stats.mirrored());
+    REQUIRE_FALSE(database.find(board, PieceColor::WHITE).has_value());
+}
+
+TEST_CASE("Position database rejects files of another format", "[database]") {
+    const TempFile file("thai_checkers_db_invalid.tcdb");
+    PositionDatabase::write(file.path.string(), {});
+    REQUIRE(PositionDatabase::open(file.path.string()).size() == 0);
+
+    std::filesystem::resize_file(file.path, 8);
+    REQUIRE_THROWS_AS(PositionDatabase::open(file.path.string()), std::runtime_error);
+    REQUIRE_THROWS_AS(PositionDatabase::open((file.path.string() + ".missing")), std::runtime_error);
+}
+
+TEST_CASE("Traversal cutoffs from a position database keep the statistics exact", "[database][traversal]") {
+    const TempFile file("thai_checkers_db_traversal.tcdb");
+    const Board position = small_endgame;
+
+    // Reference run that also collects every reusable subtree
+    std::vector<PositionDatabase::Record> records;
+    Traversal reference;
+    reference.set_subtree_sink([&](const Traversal::SubtreeResult& result) {
+        records.push_back(PositionDatabase::Record::of(result.board, result.player, result.stats));
+    });
+    Game reference_game(position);
+    reference.traverse_for(reference_game);
+    REQUIRE_FALSE(records.empty());
+    for (const bool canonical : {false, true}) {
+        PositionDatabase::write(file.path.string(), records, canonical);
+        const auto database = PositionDatabase::open(file.path.string());
+        for (const std::size_t threads : {1u, 2u}) {
+            Traversal cut;
+            cut.set_threads(threads);
+            cut.set_split_depth(1);
+            cut.set_position_database(&database);
+            Game game(position);
+            cut.traverse_for(game);
+            REQUIRE(cut.database_hits() > 0);
+            REQUIRE(cut.statistics() == reference.statistics());
+        }
+    }
+}
@@ -0,0 +1,172 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Search.h"
+#include "Tablebase.h"
+#include "TestBoards.h"
+
+namespace {
+// Positions whose whole game tree is small (every line ends in a win before any piece promotes)
+std::vector<Board> finite_positions() {
+    return {
+        board_of({"H5", "E8", "G8"}, {"B1", "D3", "C4"}),
+        board_of({"A6", "A8", "C8"}, {"E2", "G6", "G8"}),
+    };
+}
+
+// Exact game value by plain negamax over the whole tree, scored like Search
+Search::Score solve(Game& game, std::size_t ply) {
+    if (game.is_looping()) return 0;
+    const auto move_count = game.move_count();
+    if (move_count == 0) return -(Search::WIN_SCORE - static_cast<Search::Score>(ply));
+    Search::Score best = -Search::WIN_SCORE;
+    for (std::size_t i = 0; i < move_count; ++i) {
+        game.select_move(i);
+        best = std::max(best, -solve(game, ply + 1));
+        game.undo_move();
+    }
+    return best;
+}
+
+bool is_legal(const Game& game, const Move& move) {
+    const auto choices = game.choices();
+    return std::find(choices.begin(), choices.end(), move) != choices.end();
+}
+} // namespace
+
+TEST_CASE("Search solves small trees exactly", "[search]") {
+    for (const auto& position : finite_positions()) {
+        Game game(position);
+        const auto expected = solve(game, 0);
+        REQUIRE(std::abs(expected) >= Search::WIN_THRESHOLD);
+
+        Search search;
+        const auto result = search.run(game, Search::Limits{.time = std::nullopt, .nodes = std::nullopt, .depth = 64});
+        REQUIRE(result.score == expected);
+        REQUIRE(game.get_move_sequence().empty());
+
+        // The principal variation is playable (table cutoffs may end it before the end of the game)
+        REQUIRE(result.best_move == result.pv.front());
+        REQUIRE(result.pv.size() <= static_cast<std::size_t>(Search::WIN_SCORE - std::abs(expected)));
+        for (const auto& move : result.pv) {
+            REQUIRE(is_legal(game, move));
+            const auto choices = game.choices();
+            game.select_move(static_cast<std::size_t>(std::find(choices.begin(), choices.end(), move) - choices.begin()));
+        }
+    }
+}
+
+TEST_CASE("Search wins and losses agree with the tablebase", "[search][tablebase]") {
+    const auto tablebase = Tablebase::build(3, 2);
+    Search search(1);
+    std::size_t decided = 0;
+    // A spread of three-piece positions, each searched a few plies deep
+    for (std::uint64_t index = 0; index < Tablebase::slice_size(3); index += 997) {
+        const auto [board, side] = Tablebase::position(3, index);
+        if (side != PieceColor::WHITE) continue;
+        Game game(board);
+        if (game.move_count() == 0) continue;
+
+        const auto result = search.run(game, Search::Limits{.time = std::nullopt, .nodes = 20000, .depth = 12});
+        const auto value = tablebase.probe(board, side);
+        REQUIRE(value);
+        if (result.is_win()) REQUIRE(*value == Tablebase::Value::WIN);
+        if (result.is_loss()) REQUIRE(*value == Tablebase::Value::LOSS);
+        if (result.is_win() || result.is_loss()) ++decided;
+    }
+    REQUIRE(decided > 0);
+}
+
+TEST_CASE("Search respects its node and time limits", "[search]") {
+    Game game;
+    const auto key = game.position_key();
+    std::vector<std::size_t> depths;
+    Search search(4, [&](const Search::Result& info) {
+        depths.push_back(info.depth);
+        REQUIRE(!info.pv.empty());
+    });
+
+    const auto by_nodes = search.run(game, Search::Limits{.time = std::nullopt, .nodes = 20000});
+    REQUIRE(by_nodes.nodes <= 20000 + 1024);
+    REQUIRE(by_nodes.depth >= 1);
+    REQUIRE(by_nodes.best_move);
+    REQUIRE(is_legal(game, *by_nodes.best_move));
+    REQUIRE(game.choices()[by_nodes.best_index] == *by_nodes.best_move);
+    REQUIRE(game.get_move_sequence().empty());
+    REQUIRE(game.position_key() == key);
+    REQUIRE(std::is_sorted(depths.begin(), depths.end()));
+    REQUIRE(depths.back() == by_nodes.depth);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto by_time =
+        search.run(game, Search::Limits{.time = std::chrono::milliseconds(100), .nodes = std::nullopt});
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+    REQUIRE(by_time.best_move);
+    REQUIRE(is_legal(game, *by_time.best_move));
+    REQUIRE(by_time.nodes_per_second() > 0);
+
+    // Fixed depth is deterministic
+    search.clear();
+    const auto first = search.run(game, Search::Limits{.time = std::nullopt, .nodes = std::nullopt, .depth = 5});
+    search.clear();
+    const auto second = search.run(game, Search::Limits{.time = std::nullopt, .nodes = std::nullopt, .depth = 5});
+    REQUIRE(first.depth == 5);
+    REQUIRE(first.score == second.score);
+    REQUIRE(first.pv == second.pv);
+    REQUIRE(first.nodes == second.nodes);
+}
+
+TEST_CASE("Lazy SMP threads share the table and agree on solved trees", "[search][parallel]") {
+    for (const auto& position : finite_positions()) {
+        Game game(position);
+        const auto expected = solve(game, 0);
+
+        Search search;
+        search.set_threads(4);
+        const auto result = search.run(game, Search::Limits{.time = std::nullopt, .nodes = std::nullopt, .depth = 64});
+        REQUIRE(result.score == expected);
+        REQUIRE(game.get_move_sequence().empty());
+        REQUIRE(is_legal(game, *result.best_move));
+    }
+
+    Game game;
+    Search search(4);
+    search.set_threads(4);
+    const auto result =
+        search.run(game, Search::Limits{.time = std::chrono::milliseconds(200), .nodes = std::nullopt});
+    REQUIRE(result.thread_nodes.size() == 4);
+    std::uint64_t total = 0;
+    for (const auto nodes : result.thread_nodes) {
+        REQUIRE(nodes > 0);
+        total += nodes;
+    }
+    REQUIRE(total == result.nodes);
+    REQUIRE(result.depth >= 1);
+    REQUIRE(is_legal(game, *result.best_move));
+    REQUIRE(game.get_move_sequence().empty());
+}
+
+TEST_CASE("Exceptions on any search thread reach the caller", "[search][parallel]") {
+    for (const std::size_t threads : {1u, 4u}) {
+        Game game;
+        game.select_move(0);
+        Search search;
+        search.set_threads(threads);
+        std::atomic<std::size_t> calls{0};
+        search.set_evaluator([&](const Board& board, PieceColor side) {
+            if (calls.fetch_add(1, std::memory_order_relaxed) == 5000) throw std::runtime_error("Evaluator failed");
+            return Search::evaluate_material(board, side);
+        });
+        REQUIRE_THROWS_AS(search.run(game, Search::Limits{.time = std::nullopt, .nodes = std::nullopt, .depth = 40}),
+                          std::runtime_error);
+        REQUIRE(game.get_move_sequence().size() == 1);
+    }
+}
@@ -0,0 +1,156 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "Explorer.h"
+#include "Tablebase.h"
+#include "Traversal.h"
+#include "TestBoards.h"
+
+namespace {
+using Value = Tablebase::Value;
+
+constexpr std::size_t SOLVED_PIECES = 3;
+
+// Built once: solving three pieces takes a fraction of a second
+const Tablebase& solved() {
+    static const Tablebase tablebase = Tablebase::build(SOLVED_PIECES, 2);
+    return tablebase;
+}
+
+PieceColor opponent(PieceColor color) { return color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE; }
+} // namespace
+
+TEST_CASE("Tablebase index is a bijection within each slice", "[tablebase]") {
+    REQUIRE(Tablebase::slice_size(0) == 1);
+    REQUIRE(Tablebase::slice_size(1) == 32 * 4);
+    for (std::size_t n = 0; n <= SOLVED_PIECES; ++n) {
+        for (std::uint64_t i = 0; i < Tablebase::slice_size(n); ++i) {
+            const auto [board, side] = Tablebase::position(n, i);
+            REQUIRE(static_cast<std::size_t>(std::popcount(board.occ_bits())) == n);
+            REQUIRE(side == PieceColor::WHITE);
+            REQUIRE(Tablebase::index(board, side) == i);
+            REQUIRE(Tablebase::index(board.mirrored(), PieceColor::BLACK) == i);
+        }
+    }
+    // Sampled for a slice too large to walk in a test
+    const auto size = Tablebase::slice_size(Tablebase::MAX_SUPPORTED_PIECES);
+    for (std::uint64_t i = 0; i < size; i += 999'983) {
+        const auto [board, side] = Tablebase::position(Tablebase::MAX_SUPPORTED_PIECES, i);
+        REQUIRE(Tablebase::index(board, side) == i);
+    }
+    REQUIRE(Tablebase::index(Tablebase::position(6, size - 1).first.mirrored(), PieceColor::BLACK) == size - 1);
+}
+
+TEST_CASE("Tablebase values agree with the values of every successor", "[tablebase]") {
+    const auto& tablebase = solved();
+    MoveList moves;
+    for (std::size_t n = 0; n <= SOLVED_PIECES; ++n) {
+        for (std::uint64_t i = 0; i < Tablebase::slice_size(n); ++i) {
+            const auto [white_board, white] = Tablebase::position(n, i);
+            // Black to move on the mirrored board is probed through the same entry
+            for (const auto& [board, side] :
+                 {std::pair{white_board, white}, std::pair{white_board.mirrored(), PieceColor::BLACK}}) {
+                Explorer(board).find_side_moves(side, moves);
+                bool any_loss = false;
+                bool any_draw = false;
+                for (const auto& move : moves) {
+                    Board next = board;
+                    next.apply_delta(board.move_delta(move));
+                    const auto value = tablebase.probe(next, opponent(side));
+                    REQUIRE(value.has_value());
+                    any_loss |= *value == Value::LOSS;
+                    any_draw |= *value == Value::DRAW;
+                }
+                const auto expected = any_loss ? Value::WIN : any_draw ? Value::DRAW : Value::LOSS;
+                REQUIRE(tablebase.probe(board, side) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Tablebase solves simple endings", "[tablebase]") {
+    const auto& tablebase = solved();
+    // The side to move without pieces has lost
+    REQUIRE(tablebase.probe(Board{}, PieceColor::WHITE) == Value::LOSS);
+    REQUIRE(tablebase.probe(board_of({}, {"D5"}, {"D5"}), PieceColor::BLACK) == Value::LOSS);
+    // ... and a lone piece wins by moving
+    REQUIRE(tablebase.probe(board_of({}, {"D5"}, {"D5"}), PieceColor::WHITE) == Value::WIN);
+    REQUIRE(tablebase.probe(board_of({"D5"}, {}), PieceColor::BLACK) == Value::WIN);
+    // Not covered
+    REQUIRE_FALSE(tablebase.probe(Board::setup(), PieceColor::WHITE).has_value());
+}
+
+TEST_CASE("Tablebase does not depend on the thread count", "[tablebase]") {
+    const auto serial = Tablebase::build(SOLVED_PIECES, 1);
+    const auto& parallel = solved();
+    REQUIRE(serial.max_pieces() == SOLVED_PIECES);
+    for (std::size_t n = 0; n <= SOLVED_PIECES; ++n) {
+        for (std::uint64_t i = 0; i < Tablebase::slice_size(n); ++i) {
+            const auto [board, side] = Tablebase::position(n, i);
+            REQUIRE(serial.probe(board, side) == parallel.probe(board, side));
+        }
+    }
+    REQUIRE_THROWS_AS(Tablebase::build(Tablebase::MAX_SUPPORTED_PIECES + 1), std::invalid_argument);
+}
+
+TEST_CASE("Tablebase round-trips through a file", "[tablebase]") {
+    const TempFile file("thai_checkers_tablebase.tctb");
+    solved().save(file.path.string());
+    const auto loaded = Tablebase::load(file.path.string());
+    REQUIRE(loaded.max_pieces() == SOLVED_PIECES);
+    for (std::size_t n = 0; n <= SOLVED_PIECES; ++n) {
+        for (std::uint64_t i = 0; i < Tablebase::slice_size(n); ++i) {
+            const auto [board, side] = Tablebase::position(n, i);
+            REQUIRE(loaded.probe(board, side) == solved().probe(board, side));
+        }
+    }
+
+    std::filesystem::resize_file(file.path, 100);
+    REQUIRE_THROWS_AS(Tablebase::load(file.path.string()), std::runtime_error);
+}
+
+TEST_CASE("Traversal ends lines in the tablebase", "[tablebase][traversal]") {
+    // White must capture D5xB3, which leaves three pieces
+    const auto position = board_of({"C4", "G6"}, {"D5", "A2"});
+    const auto after_capture = board_of({"G6"}, {"B3", "A2"});
+    const auto value = solved().probe(after_capture, PieceColor::BLACK);
+    REQUIRE(value.has_value());
+    REQUIRE_FALSE(solved().probe(position, PieceColor::WHITE).has_value());
+
+    for (const std::size_t threads : {1u, 2u}) {
+        Traversal traversal;
+        traversal.set_tablebase(&solved());
+        traversal.set_threads(threads);
+        traversal.set_split_depth(0);
+        Game game(position);
+        traversal.traverse_for(game);
+        const auto& stats = traversal.statistics();
+        REQUIRE(traversal.tablebase_hits() == 1);
+        REQUIRE(stats.games == 1);
+        REQUIRE(stats.min_length == 1);
+        REQUIRE(stats.max_length == 1);
+        REQUIRE(stats.black_wins == (*value == Value::WIN ? 1u : 0u));
+        REQUIRE(stats.white_wins == (*value == Value::LOSS ? 1u : 0u));
+        REQUIRE(stats.draws == (*value == Value::DRAW ? 1u : 0u));
+    }
+
+    // Lines that end before reaching the tablebase are recorded as usual
+    const auto finite = board_of({"H5", "E8", "G8"}, {"B1", "D3", "C4"});
+    Traversal full;
+    Game full_game(finite);
+    full.traverse_for(full_game);
+    Traversal probed;
+    probed.set_tablebase(&solved());
+    Game probed_game(finite);
+    probed.traverse_for(probed_game);
+    REQUIRE(probed.statistics() == full.statistics());
+}
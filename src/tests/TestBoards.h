@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <string>
+
+#include "Board.h"
+#include "Position.h"
+
+// Fixtures shared by the test executables
+
+// File under the temporary directory, removed when the test ends
+struct TempFile {
+    std::filesystem::path path;
+    explicit TempFile(const std::string& name) : path(std::filesystem::temp_directory_path() / name) {}
+    ~TempFile() { std::filesystem::remove(path); }
+};
+
+// Directory under the temporary directory, emptied when the test starts and removed when it ends
+struct TempDirectory {
+    std::filesystem::path path;
+    explicit TempDirectory(const std::string& name) : path(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(path);
+    }
+    ~TempDirectory() { std::filesystem::remove_all(path); }
+};
+
+inline std::uint32_t mask_of(std::initializer_list<const char*> squares) {
+    std::uint32_t mask = 0;
+    for (const auto* square : squares) mask |= std::uint32_t{1} << Position{square}.hash();
+    return mask;
+}
+
+inline Board board_of(std::initializer_list<const char*> black, std::initializer_list<const char*> white,
+                      std::initializer_list<const char*> dames = {}) {
+    Board board;
+    board.set_from_masks(mask_of(black) | mask_of(white), mask_of(black), mask_of(dames));
+    return board;
+}
+
+// Whole game tree of a few hundred nodes
+inline const Board small_endgame = board_of({"H5", "E8", "G8"}, {"B1", "D3", "C4"});
@@ -0,0 +1,456 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Instrumentation.h"
+#include "Perft.h"
+#include "TranspositionTable.h"
+#include "Traversal.h"
+#include "TestBoards.h"
+
+namespace {
+// Positions whose whole game tree is small: every line ends in a win before any piece promotes
+// (most positions with room to promote open dame shuffles and explode the tree)
+std::vector<Board> finite_positions() {
+    return {
+        board_of({"H5", "E8", "G8"}, {"B1", "D3", "C4"}),
+        board_of({"A6", "A8", "C8"}, {"E2", "G6", "G8"}),
+    };
+}
+} // namespace
+
+TEST_CASE("Parallel traversal matches the serial statistics", "[traversal][parallel]") {
+    for (const auto& position : finite_positions()) {
+        Traversal serial;
+        Game serial_game(position);
+        serial.traverse_for(serial_game);
+        const auto expected = serial.statistics();
+        REQUIRE(expected.games > 0);
+        REQUIRE(expected.games == expected.black_wins + expected.white_wins + expected.draws);
+
+        for (const std::size_t threads : {2u, 4u}) {
+            for (const std::size_t split_depth : {0u, 1u, 2u, 8u}) {
+                Traversal parallel;
+                parallel.set_threads(threads);
+                parallel.set_split_depth(split_depth);
+                Game game(position);
+                parallel.traverse_for(game);
+                const auto& stats = parallel.statistics();
+                REQUIRE(stats.games == expected.games);
+                REQUIRE(stats.black_wins == expected.black_wins);
+                REQUIRE(stats.white_wins == expected.white_wins);
+                REQUIRE(stats.draws == expected.draws);
+                REQUIRE(stats.min_length == expected.min_length);
+                REQUIRE(stats.max_length == expected.max_length);
+                REQUIRE(game.get_move_sequence().empty());
+            }
+        }
+    }
+}
+
+TEST_CASE("Transposition table round-trips subtree statistics", "[traversal][transposition]") {
+    TranspositionTable table(1);
+    const TraversalStatistics stats{
+        .games = 12, .black_wins = 5, .white_wins = 4, .draws = 3, .min_length = 2, .max_length = 9};
+    const zobrist::Key key = 0x0123456789abcdefull;
+    const zobrist::Key same_bucket = key ^ 0x1;
+
+    REQUIRE_FALSE(table.probe(key).has_value());
+    table.store(key, stats);
+    REQUIRE(table.probe(key) == stats);
+    REQUIRE_FALSE(table.probe(same_bucket).has_value());
+
+    // A smaller subtree in the same bucket takes the second entry and keeps the first
+    auto smaller = stats;
+    smaller.games = 1;
+    table.store(same_bucket, smaller);
+    REQUIRE(table.probe(key) == stats);
+    REQUIRE(table.probe(same_bucket) == smaller);
+
+    table.clear();
+    REQUIRE_FALSE(table.probe(key).has_value());
+    REQUIRE_FALSE(table.probe(same_bucket).has_value());
+}
+
+TEST_CASE("Exact transposition mode matches a full enumeration", "[traversal][transposition]") {
+    std::size_t hits = 0;
+    for (const auto& position : finite_positions()) {
+        Traversal plain;
+        Game plain_game(position);
+        plain.traverse_for(plain_game);
+
+        for (const std::size_t threads : {1u, 2u}) {
+            Traversal cached;
+            cached.set_threads(threads);
+            cached.set_split_depth(1);
+            cached.set_transposition_table(Traversal::TranspositionMode::EXACT, 1);
+            Game game(position);
+            cached.traverse_for(game);
+            REQUIRE(cached.statistics() == plain.statistics());
+            REQUIRE(game.get_move_sequence().empty());
+            hits += cached.transposition_hits();
+        }
+    }
+    REQUIRE(hits > 0);
+}
+
+TEST_CASE("Canonical transposition keys reuse mirrored subtrees exactly", "[traversal][transposition]") {
+    for (const auto& position : finite_positions()) {
+        Traversal plain;
+        Game plain_game(position);
+        plain.traverse_for(plain_game);
+
+        for (const std::size_t threads : {1u, 2u}) {
+            Traversal cached;
+            cached.set_threads(threads);
+            cached.set_split_depth(1);
+            cached.set_transposition_table(Traversal::TranspositionMode::CANONICAL, 1);
+            Game game(position);
+            cached.traverse_for(game);
+            REQUIRE(cached.statistics() == plain.statistics());
+            REQUIRE(game.get_move_sequence().empty());
+        }
+
+        // The table is filled from the mirror of a black-to-move child, whose subtrees then answer
+        // the child's own (color-swapped) subtrees with the winners swapped back
+        Game child(position);
+        child.select_move(0);
+        REQUIRE(child.player() == PieceColor::BLACK);
+        Traversal cached;
+        cached.set_transposition_table(Traversal::TranspositionMode::CANONICAL, 1);
+        Game mirrored(child.board().mirrored());
+        cached.traverse_for(mirrored);
+        Game game(position);
+        cached.traverse_for(game);
+        REQUIRE(cached.transposition_hits() > 0);
+        REQUIRE(cached.statistics() == plain.statistics());
+    }
+}
+
+TEST_CASE("Result batches carry every game and replayable histories", "[traversal][results]") {
+    const auto position = finite_positions().front();
+    for (const std::size_t threads : {1u, 2u}) {
+        std::vector<std::vector<Traversal::ResultRecord>> records(threads);
+        std::vector<std::vector<std::vector<std::uint8_t>>> histories(threads);
+        // Per-worker state only: the sink runs concurrently on the worker threads
+        std::vector<std::size_t> batches(threads);
+        std::vector<std::size_t> largest_batch(threads);
+        Traversal traversal([&](const Traversal::ResultBatch& batch) {
+            ++batches[batch.worker];
+            largest_batch[batch.worker] = std::max(largest_batch[batch.worker], batch.records.size());
+            for (const auto& record : batch.records) {
+                records[batch.worker].push_back(record);
+                const auto history = batch.history(record);
+                histories[batch.worker].emplace_back(history.begin(), history.end());
+            }
+        });
+        traversal.set_threads(threads);
+        traversal.set_split_depth(1);
+        traversal.set_result_batch_size(7);
+        traversal.set_record_histories(true);
+        Game game(position);
+        traversal.traverse_for(game);
+
+        Traversal::Statistics replayed;
+        std::size_t total_batches = 0;
+        for (std::size_t worker = 0; worker < threads; ++worker) {
+            REQUIRE(largest_batch[worker] <= 7);
+            total_batches += batches[worker];
+            for (std::size_t i = 0; i < records[worker].size(); ++i) {
+                const auto& record = records[worker][i];
+                const auto& history = histories[worker][i];
+                REQUIRE(history.size() == record.length);
+
+                // Playing the recorded indices reaches a finished game with the recorded outcome
+                Game replay(position);
+                for (const auto index : history) replay.select_move(index);
+                REQUIRE(replay.move_count() == 0);
+                REQUIRE(replay.is_looping() == record.looping);
+                replayed.record(record.winner, record.length);
+            }
+        }
+        REQUIRE(total_batches >= (replayed.games + 6) / 7);
+        REQUIRE(replayed == traversal.statistics());
+    }
+}
+
+TEST_CASE("Result batches omit histories unless enabled", "[traversal][results]") {
+    std::size_t games = 0;
+    Traversal traversal([&](const Traversal::ResultBatch& batch) {
+        REQUIRE(batch.histories.empty());
+        for (const auto& record : batch.records) {
+            REQUIRE(batch.history(record).empty());
+            ++games;
+        }
+    });
+    Game game(finite_positions().front());
+    traversal.traverse_for(game);
+    REQUIRE(games == traversal.statistics().games);
+}
+
+TEST_CASE("Exceptions from the result sink reach the caller", "[traversal][results]") {
+    for (const std::size_t threads : {1, 4}) {
+        Traversal traversal([](const Traversal::ResultBatch&) { throw std::runtime_error("Sink failed"); });
+        traversal.set_threads(threads);
+        traversal.set_split_depth(2);
+        traversal.set_max_nodes(200000);
+        Game game;
+        REQUIRE_THROWS_AS(traversal.traverse_for(game), std::runtime_error);
+    }
+}
+
+TEST_CASE("Node counters describe the enumerated tree", "[traversal][counters]") {
+    for (const auto& position : finite_positions()) {
+        Traversal serial;
+        Game game(position);
+        serial.traverse_for(game);
+        const auto root_moves = game.move_count();
+        const auto& stats = serial.statistics();
+        const auto& counters = serial.node_counters();
+
+        // Every node but the root is a child of an inner node, and every other node ends a game
+        REQUIRE(counters.nodes == counters.children + 1);
+        REQUIRE(counters.nodes - counters.inner_nodes == stats.games);
+        REQUIRE(counters.depths.size() == stats.max_length + 1);
+        REQUIRE(counters.depths[0] == 1);
+        REQUIRE(counters.depths[1] == root_moves);
+        std::uint64_t total = 0;
+        for (const auto count : counters.depths) total += count;
+        REQUIRE(total == counters.nodes);
+
+        const auto& hot = serial.instrumentation_counters();
+        if constexpr (instrumentation::enabled) {
+            // One generation per node (looping nodes have no choices), then a cache hit per child made
+            REQUIRE(hot[instrumentation::Counter::MOVE_GENERATIONS] == counters.nodes - stats.draws);
+            REQUIRE(hot[instrumentation::Counter::CHOICE_CACHE_HITS] >= counters.children);
+            REQUIRE(hot[instrumentation::Counter::REPETITION_LOOKUPS] == counters.nodes - 1);
+        } else {
+            REQUIRE(hot == instrumentation::Counters{});
+        }
+
+        Traversal parallel;
+        parallel.set_threads(4);
+        parallel.set_split_depth(2);
+        Game parallel_game(position);
+        parallel.traverse_for(parallel_game);
+        REQUIRE(parallel.node_counters().nodes == counters.nodes);
+        REQUIRE(parallel.node_counters().inner_nodes == counters.inner_nodes);
+        REQUIRE(parallel.node_counters().children == counters.children);
+        REQUIRE(parallel.node_counters().depths == counters.depths);
+        if constexpr (instrumentation::enabled) {
+            // Workers replay task paths, so only the generations per node are fixed
+            REQUIRE(parallel.instrumentation_counters()[instrumentation::Counter::MOVE_GENERATIONS] >=
+                    hot[instrumentation::Counter::MOVE_GENERATIONS]);
+        }
+    }
+}
+
+TEST_CASE("Depth-limited traversal counts the nodes of every ply like perft", "[traversal][limits]") {
+    constexpr std::size_t max_depth = 5;
+    Game reference;
+    for (const std::size_t threads : {1u, 4u}) {
+        Traversal traversal;
+        traversal.set_threads(threads);
+        traversal.set_split_depth(2);
+        traversal.set_max_depth(max_depth);
+        Game game;
+        traversal.traverse_for(game);
+        REQUIRE(traversal.completed());
+
+        const auto& counters = traversal.node_counters();
+        REQUIRE(counters.depths.size() == max_depth + 1);
+        for (std::size_t depth = 0; depth <= max_depth; ++depth) {
+            REQUIRE(counters.depths[depth] == perft::perft(reference, depth));
+        }
+        // No game ends this close to the start position
+        REQUIRE(traversal.statistics().games == 0);
+        REQUIRE(traversal.horizon_leaves() == counters.depths[max_depth]);
+    }
+}
+
+TEST_CASE("Horizon leaves and games split the nodes at the depth limit", "[traversal][limits]") {
+    for (const auto& position : finite_positions()) {
+        Traversal full;
+        Game full_game(position);
+        full.traverse_for(full_game);
+
+        // A horizon below the deepest game changes nothing
+        Traversal deep;
+        deep.set_max_depth(full.statistics().max_length);
+        Game deep_game(position);
+        deep.traverse_for(deep_game);
+        REQUIRE(deep.statistics().games == full.statistics().games);
+        REQUIRE(deep.horizon_leaves() == 0);
+
+        for (std::size_t max_depth = 1; max_depth < full.statistics().max_length; ++max_depth) {
+            Traversal limited;
+            limited.set_max_depth(max_depth);
+            Game game(position);
+            limited.traverse_for(game);
+            const auto& depths = limited.node_counters().depths;
+            REQUIRE(depths[max_depth] == full.node_counters().depths[max_depth]);
+            REQUIRE(limited.statistics().max_length <= max_depth);
+
+            // Every node at the horizon is either a finished game or a horizon leaf
+            std::size_t horizon_games = 0;
+            Traversal counting([&](const Traversal::ResultBatch& batch) {
+                for (const auto& record : batch.records) horizon_games += record.length == max_depth ? 1 : 0;
+            });
+            counting.set_max_depth(max_depth);
+            Game counted(position);
+            counting.traverse_for(counted);
+            REQUIRE(limited.horizon_leaves() + horizon_games == depths[max_depth]);
+        }
+    }
+}
+
+TEST_CASE("Node-limited traversal stops after exactly the node limit", "[traversal][limits]") {
+    constexpr std::uint64_t max_nodes = 25000;
+    Traversal first;
+    first.set_max_nodes(max_nodes);
+    Game game;
+    first.traverse_for(game);
+    REQUIRE_FALSE(first.completed());
+    REQUIRE(first.node_counters().nodes == max_nodes);
+    REQUIRE(game.get_move_sequence().empty());
+
+    // The same depth-first prefix every time
+    Traversal second;
+    second.set_max_nodes(max_nodes);
+    second.traverse_for(game);
+    REQUIRE(second.statistics() == first.statistics());
+    REQUIRE(second.node_counters().depths == first.node_counters().depths);
+
+    Traversal parallel;
+    parallel.set_threads(4);
+    parallel.set_split_depth(2);
+    parallel.set_max_nodes(max_nodes);
+    parallel.traverse_for(game);
+    REQUIRE_FALSE(parallel.completed());
+    REQUIRE(parallel.node_counters().nodes == max_nodes);
+
+    // A limit above the tree size lets the traversal finish
+    const auto position = finite_positions().front();
+    Traversal roomy;
+    roomy.set_max_nodes(1u << 20);
+    Game small(position);
+    roomy.traverse_for(small);
+    REQUIRE(roomy.completed());
+}
+
+TEST_CASE("Depth limits refuse subtree caching", "[traversal][limits]") {
+    Traversal traversal;
+    traversal.set_max_depth(4);
+    traversal.set_transposition_table(Traversal::TranspositionMode::EXACT, 1);
+    Game game;
+    REQUIRE_THROWS_AS(traversal.traverse_for(game), std::invalid_argument);
+}
+
+TEST_CASE("Breakdown length buckets are log-spaced", "[traversal][breakdown]") {
+    REQUIRE(TraversalBreakdown::length_bucket(0) == 0);
+    REQUIRE(TraversalBreakdown::length_bucket(1) == 1);
+    for (std::size_t bucket = 1; bucket + 1 < TraversalBreakdown::LENGTH_BUCKETS; ++bucket) {
+        const auto first = TraversalBreakdown::bucket_min_length(bucket);
+        REQUIRE(TraversalBreakdown::length_bucket(first) == bucket);
+        REQUIRE(TraversalBreakdown::length_bucket(2 * first - 1) == bucket);
+    }
+    REQUIRE(TraversalBreakdown::bucket_min_length(TraversalBreakdown::LENGTH_BUCKETS - 1) ==
+            TraversalBreakdown::MAX_LENGTH);
+    REQUIRE(TraversalBreakdown::length_bucket(100000) == TraversalBreakdown::LENGTH_BUCKETS - 1);
+}
+
+TEST_CASE("Breakdowns split the statistics by length, prefix and depth", "[traversal][breakdown]") {
+    using Outcome = TraversalBreakdown::Outcome;
+    constexpr std::size_t prefix_depth = 2;
+    for (const auto& position : finite_positions()) {
+        std::vector<TraversalBreakdown> breakdowns;
+        for (const std::size_t threads : {1u, 4u}) {
+            Traversal traversal;
+            traversal.set_threads(threads);
+            traversal.set_split_depth(1);
+            traversal.set_breakdown(prefix_depth);
+            Game game(position);
+            traversal.traverse_for(game);
+            const auto& stats = traversal.statistics();
+            const auto breakdown = traversal.breakdown();
+            REQUIRE(breakdown.games() == stats.games);
+            REQUIRE(breakdown.memory_bytes() == TraversalBreakdown(game, prefix_depth).memory_bytes());
+
+            TraversalStatistics by_length;
+            for (std::size_t length = 0; length <= TraversalBreakdown::MAX_LENGTH; ++length) {
+                for (std::size_t n = 0; n < breakdown.games(length, Outcome::BLACK_WIN); ++n) {
+                    by_length.record(PieceColor::BLACK, length);
+                }
+                for (std::size_t n = 0; n < breakdown.games(length, Outcome::WHITE_WIN); ++n) {
+                    by_length.record(PieceColor::WHITE, length);
+                }
+                for (std::size_t n = 0; n < breakdown.games(length, Outcome::DRAW); ++n) by_length.record({}, length);
+            }
+            REQUIRE(by_length == stats);
+            breakdowns.push_back(breakdown);
+        }
+
+        // Every prefix holds exactly the games of a traversal rooted there
+        const auto prefixes = breakdowns[0].prefixes();
+        REQUIRE(prefixes.size() > 1);
+        TraversalStatistics total;
+        for (const auto& prefix : prefixes) {
+            REQUIRE(prefix.moves.size() <= prefix_depth);
+            Game game(position);
+            for (const auto index : prefix.moves) game.select_move(index);
+            TraversalBreakdown::LengthHistogram lengths{};
+            Traversal below([&](const Traversal::ResultBatch& batch) {
+                for (const auto& record : batch.records) ++lengths[TraversalBreakdown::length_bucket(record.length)];
+            });
+            below.traverse_for(game);
+            REQUIRE(prefix.stats == below.statistics());
+            REQUIRE(prefix.lengths == lengths);
+            total.merge(prefix.stats);
+        }
+        REQUIRE(total.games == breakdowns[0].games());
+
+        const auto parallel_prefixes = breakdowns[1].prefixes();
+        REQUIRE(parallel_prefixes.size() == prefixes.size());
+        for (std::size_t i = 0; i < prefixes.size(); ++i) {
+            REQUIRE(parallel_prefixes[i].moves == prefixes[i].moves);
+            REQUIRE(parallel_prefixes[i].stats == prefixes[i].stats);
+            REQUIRE(parallel_prefixes[i].lengths == prefixes[i].lengths);
+        }
+
+        // Distinct positions per depth, counted exactly by a separate enumeration
+        std::vector<std::vector<zobrist::Key>> keys;
+        Game game(position);
+        const auto collect = [&](auto& self, std::size_t depth) -> void {
+            if (keys.size() <= depth) keys.resize(depth + 1);
+            keys[depth].push_back(game.position_key());
+            for (std::size_t i = 0; i < game.move_count(); ++i) {
+                game.select_move(i);
+                self(self, depth + 1);
+                game.undo_move();
+            }
+        };
+        collect(collect, 0);
+        for (std::size_t depth = 0; depth < keys.size() && depth < TraversalBreakdown::SKETCH_DEPTHS; ++depth) {
+            std::ranges::sort(keys[depth]);
+            const auto distinct = static_cast<double>(std::ranges::unique(keys[depth]).begin() - keys[depth].begin());
+            for (const auto& breakdown : breakdowns) {
+                REQUIRE(std::abs(breakdown.distinct_positions(depth) - distinct) <= 0.1 * distinct + 1.0);
+            }
+        }
+    }
+}
+
+TEST_CASE("Breakdowns refuse cached subtrees", "[traversal][breakdown]") {
+    Traversal traversal;
+    traversal.set_breakdown(1);
+    traversal.set_transposition_table(Traversal::TranspositionMode::EXACT, 1);
+    Game game;
+    REQUIRE_THROWS_AS(traversal.traverse_for(game), std::invalid_argument);
+    REQUIRE_THROWS_AS(TraversalBreakdown(game, 40), std::invalid_argument);
+}
@@ -0,0 +1,94 @@
+// Catch2
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Perft.h"
+#include "Traversal.h"
+#include "WorkQueue.h"
+#include "TestBoards.h"
+
+TEST_CASE("Prefixes partition the tree in selection order", "[workqueue]") {
+    Game game;
+    const auto prefixes = WorkQueue::prefixes(game, 3);
+    REQUIRE(game.get_move_sequence().empty());
+    REQUIRE(prefixes.size() == perft::perft(game, 3));
+    REQUIRE(prefixes.front() == std::vector<std::uint8_t>{0, 0, 0});
+    REQUIRE(std::is_sorted(prefixes.begin(), prefixes.end()));
+
+    // Lines that end early are units of their own
+    Game endgame(small_endgame);
+    for (const auto& prefix : WorkQueue::prefixes(endgame, 6)) {
+        for (const auto index : prefix) endgame.select_move(index);
+        REQUIRE((prefix.size() == 6 || endgame.move_count() == 0));
+        for (std::size_t i = 0; i < prefix.size(); ++i) endgame.undo_move();
+    }
+}
+
+TEST_CASE("Workers sharing a queue match a single traversal", "[workqueue][traversal]") {
+    const TempDirectory directory("thai_checkers_work_queue");
+    Traversal serial;
+    Game serial_game(small_endgame);
+    serial.traverse_for(serial_game);
+    REQUIRE(serial.completed());
+
+    Game game(small_endgame);
+    const auto queue = WorkQueue::create(directory.path.string(), game, 4);
+    REQUIRE(queue.status().pending == queue.status().total);
+
+    // A worker that dies holding a unit: its lease expires and the unit goes back to pending
+    const auto abandoned = queue.claim();
+    REQUIRE(abandoned);
+    REQUIRE(queue.status().claimed == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(queue.requeue_expired(std::chrono::milliseconds(10)) == 1);
+    REQUIRE(queue.status().claimed == 0);
+
+    // Two workers on another handle to the same directory, as on another node
+    const auto reopened = WorkQueue::open(directory.path.string());
+    std::size_t completed = 0;
+    std::vector<std::jthread> workers;
+    std::vector<std::size_t> counts(2);
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        workers.emplace_back([&, i] {
+            Traversal traversal;
+            counts[i] = work_through(reopened, traversal, std::chrono::seconds(5));
+        });
+    }
+    workers.clear();
+    for (const auto count : counts) completed += count;
+
+    const auto status = queue.status();
+    REQUIRE(status.finished());
+    REQUIRE(status.pending == 0);
+    REQUIRE(status.claimed == 0);
+    REQUIRE(completed == status.total);
+    REQUIRE(queue.results() == serial.statistics());
+
+    // A restarted coordinator picks up the same queue; another depth is rejected
+    Game again(small_endgame);
+    REQUIRE(WorkQueue::create(directory.path.string(), again, 4).status().finished());
+    REQUIRE_THROWS_AS(WorkQueue::create(directory.path.string(), again, 5), std::runtime_error);
+}
+
+TEST_CASE("Units cut short by the deadline are released", "[workqueue][traversal]") {
+    const TempDirectory directory("thai_checkers_work_queue_deadline");
+    Game game;
+    const auto queue = WorkQueue::create(directory.path.string(), game, 1);
+
+    Traversal traversal;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    REQUIRE(work_through(queue, traversal, std::chrono::seconds(5), deadline) == 0);
+    const auto status = queue.status();
+    REQUIRE(status.done == 0);
+    REQUIRE(status.claimed == 0);
+    REQUIRE(status.pending == status.total);
+
+    REQUIRE_THROWS_AS(WorkQueue::open((directory.path / "missing").string()), std::runtime_error);
+}
@@ -0,0 +1,163 @@
+// Builds a PositionDatabase from an exhaustive traversal
+#include "CommandLine.h"
+#include "PositionDatabase.h"
+#include "Traversal.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+// Parses OCC:BLACK:DAME hexadecimal Board masks
+std::optional<Board> parse_masks(std::string_view arg) {
+    std::array<std::uint32_t, 3> masks{};
+    std::size_t field = 0;
+    for (std::size_t start = 0; field < masks.size(); ++field) {
+        const auto end = std::min(arg.find(':', start), arg.size());
+        const auto text = std::string(arg.substr(start, end - start));
+        try {
+            std::size_t consumed = 0;
+            masks[field] = static_cast<std::uint32_t>(std::stoul(text, &consumed, 16));
+            if (consumed != text.size()) return std::nullopt;
+        } catch (const std::exception&) { return std::nullopt; }
+        if (end == arg.size()) {
+            ++field;
+            break;
+        }
+        start = end + 1;
+    }
+    if (field != masks.size()) return std::nullopt;
+
+    Board board;
+    board.set_from_masks(masks[0], masks[1], masks[2]);
+    return board;
+}
+
+void print_usage(const char* program_name) {
+    std::cout << std::format(
+        "Usage: {} --output FILE [--masks OCC:BLACK:DAME] [--timeout DURATION] [--threads N] [--min-games N] "
+        "[--db FILE] [--canonical]\n",
+        program_name);
+    std::cout << "Options:\n";
+    std::cout << "  --output FILE       Database file to write\n";
+    std::cout << "  --masks M           Root position as hexadecimal Board masks, white to move (e.g., an endgame)\n";
+    std::cout << "                      Default: the start position\n";
+    std::cout << "  --timeout DURATION  Traversal time (e.g., 10s, 5000ms)\n";
+    std::cout << "                      Default: 10s\n";
+    std::cout << "  --threads N         Worker threads\n";
+    std::cout << "                      Default: 1\n";
+    std::cout << "  --min-games N       Only store subtrees with at least N games\n";
+    std::cout << "                      Default: 1\n";
+    std::cout << "  --db FILE           Existing database: used for cutoffs and carried over into the output\n";
+    std::cout << "  --canonical         Store mirrored positions once, in white-to-move form (see Board::canonical)\n";
+    std::cout << "  --help             Show this help message\n";
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    std::chrono::milliseconds timeout{10000};
+    std::size_t threads = 1;
+    std::size_t min_games = 1;
+    bool canonical = false;
+    std::optional<std::string> output_path;
+    std::optional<std::string> input_path;
+    Board root = Board::setup();
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (arg == "--canonical") {
+            canonical = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << std::format("Error: Unknown argument '{}' or missing value\n", arg);
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--output") {
+            output_path = value;
+        } else if (arg == "--db") {
+            input_path = value;
+        } else if (arg == "--masks") {
+            const auto parsed = parse_masks(value);
+            if (!parsed) {
+                std::cerr << std::format("Error: Invalid masks '{}' (expected OCC:BLACK:DAME in hex)\n", value);
+                return 1;
+            }
+            root = *parsed;
+        } else if (arg == "--timeout") {
+            const auto parsed = parse_timeout(value);
+            if (!parsed) {
+                std::cerr << std::format("Error: Invalid timeout format '{}'\n", value);
+                return 1;
+            }
+            timeout = *parsed;
+        } else if (arg == "--threads" || arg == "--min-games") {
+            const auto parsed = parse_count(value);
+            if (!parsed) {
+                std::cerr << std::format("Error: Invalid number '{}' for {}\n", value, arg);
+                return 1;
+            }
+            (arg == "--threads" ? threads : min_games) = *parsed;
+        } else {
+            std::cerr << std::format("Error: Unknown argument '{}'\n", arg);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!output_path) {
+        std::cerr << "Error: --output is required\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        std::optional<PositionDatabase> input;
+        if (input_path) input.emplace(PositionDatabase::open(*input_path));
+
+        // Subtree results arrive concurrently from the workers; they are rare next to leaves
+        std::mutex records_mutex;
+        std::vector<PositionDatabase::Record> records;
+        if (input) records.assign(input->records().begin(), input->records().end());
+
+        Traversal traversal;
+        traversal.set_threads(threads);
+        if (input) traversal.set_position_database(&*input);
+        traversal.set_subtree_sink([&](const Traversal::SubtreeResult& result) {
+            if (result.stats.games < min_games) return;
+            const std::lock_guard lock(records_mutex);
+            records.push_back(PositionDatabase::Record::of(result.board, result.player, result.stats));
+        });
+
+        std::cout << std::format("Traversing for {}ms with {} thread(s)\n", timeout.count(), threads);
+        Game game(root);
+        traversal.traverse_for(game, timeout);
+
+        // Release the input mapping before the output may replace the same file
+        input.reset();
+        PositionDatabase::write(*output_path, std::move(records), canonical);
+        const auto written = PositionDatabase::open(*output_path);
+        std::cout << std::format("Games: {}\n", traversal.statistics().games);
+        std::cout << std::format("Database hits: {}\n", traversal.database_hits());
+        std::cout << std::format("Positions written: {}\n", written.size());
+    } catch (const std::runtime_error& e) {
+        std::cerr << std::format("Error: {}\n", e.what());
+        return 1;
+    }
+    return 0;
+}
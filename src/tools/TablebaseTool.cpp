@@ -0,0 +1,81 @@
+// Builds a win/draw/loss Tablebase by retrograde analysis
+#include "CommandLine.h"
+#include "Tablebase.h"
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace {
+void print_usage(const char* program_name) {
+    std::cout << std::format("Usage: {} --output FILE [--pieces N] [--threads N]\n", program_name);
+    std::cout << "Options:\n";
+    std::cout << "  --output FILE       Tablebase file to write\n";
+    std::cout << "  --pieces N          Solve every position with up to N pieces (at most "
+              << Tablebase::MAX_SUPPORTED_PIECES << ")\n";
+    std::cout << "                      Default: 4\n";
+    std::cout << "  --threads N         Worker threads\n";
+    std::cout << "                      Default: 1\n";
+    std::cout << "  --help             Show this help message\n";
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t pieces = 4;
+    std::size_t threads = 1;
+    std::optional<std::string> output_path;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << std::format("Error: Unknown argument '{}' or missing value\n", arg);
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--output") {
+            output_path = value;
+        } else if (arg == "--pieces" || arg == "--threads") {
+            const auto parsed = parse_count(value);
+            if (!parsed) {
+                std::cerr << std::format("Error: Invalid number '{}' for {}\n", value, arg);
+                return 1;
+            }
+            (arg == "--pieces" ? pieces : threads) = *parsed;
+        } else {
+            std::cerr << std::format("Error: Unknown argument '{}'\n", arg);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!output_path) {
+        std::cerr << "Error: --output is required\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        const auto tablebase = Tablebase::build(pieces, threads);
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        tablebase.save(*output_path);
+
+        std::cout << std::format("Solved up to {} pieces in {}ms with {} thread(s)\n", pieces, elapsed.count(),
+                                 threads);
+        for (std::size_t n = 0; n <= pieces; ++n) {
+            std::cout << std::format("  {} pieces: {} positions\n", n, Tablebase::slice_size(n));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << std::format("Error: {}\n", e.what());
+        return 1;
+    }
+    return 0;
+}